@@ -17,7 +17,7 @@
 
 void animation_base::init(wayfire_view, int, wf_animation_type)
 {}
-bool animation_base::step()
+bool animation_base::step(int64_t)
 {
     return false;
 }
@@ -70,18 +70,24 @@ struct animation_hook : public animation_hook_base
     wf::output_t *current_output = nullptr;
     std::unique_ptr<animation_base> animation;
 
+    wf::timeline_animation_id_t timeline_id;
+
     /* Update animation right before each frame */
-    wf::effect_hook_t update_animation_hook = [=] ()
+    bool update_animation(int64_t target_us)
     {
         view->damage();
-        bool result = animation->step();
+        bool result = animation->step(target_us);
         view->damage();
 
         if (!result)
         {
+            /* Destroys this hook, the timeline keeps the callback alive until
+             * the end of the tick. */
             stop_hook(false);
         }
-    };
+
+        return result;
+    }
 
     /**
      * Switch the output the view is being animated on, and update the lastly
@@ -91,13 +97,14 @@ struct animation_hook : public animation_hook_base
     {
         if (current_output)
         {
-            current_output->render->rem_effect(&update_animation_hook);
+            current_output->render->get_animation_timeline().remove(timeline_id);
         }
 
         if (new_output)
         {
-            new_output->render->add_effect(&update_animation_hook,
-                wf::OUTPUT_EFFECT_PRE);
+            timeline_id = new_output->render->get_animation_timeline().add(
+                [=] (int64_t target_us) { return update_animation(target_us); });
+            new_output->render->schedule_redraw();
         }
 
         current_output = new_output;
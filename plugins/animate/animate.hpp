@@ -4,6 +4,8 @@
 #include <wayfire/view.hpp>
 #include <wayfire/util/duration.hpp>
 #include <wayfire/option-wrapper.hpp>
+#include <algorithm>
+#include <cstdint>
 
 #define HIDING_ANIMATION (1 << 0)
 #define SHOWING_ANIMATION (1 << 1)
@@ -18,11 +20,116 @@ enum wf_animation_type
     ANIMATION_TYPE_RESTORE  = SHOWING_ANIMATION | MINIMIZE_STATE_ANIMATION,
 };
 
+/**
+ * The progress of a view animation, driven by the output's animation timeline.
+ *
+ * Unlike wf::animation::duration_t, which reads the clock whenever it is
+ * evaluated, the time is set once per frame to the predicted presentation
+ * time of the frame, so every animation shows the state it will have when the
+ * frame reaches the screen. The first frame starts the animation.
+ */
+class timeline_progress_t
+{
+  public:
+    timeline_progress_t(int duration_ms = 0,
+        wf::animation::smoothing::smooth_function smoothing =
+            wf::animation::smoothing::circle) :
+        length_us(std::max(duration_ms, 1) * (int64_t)1000),
+        smoothing(smoothing)
+    {}
+
+    /** Set the presentation time of the frame which is being prepared. */
+    void set_time(int64_t target_us)
+    {
+        if (start_us < 0)
+        {
+            start_us = target_us;
+        }
+
+        now_us = std::max(now_us, target_us);
+    }
+
+    /** @return The smoothed progress at the current frame, from 0 to 1. */
+    double progress() const
+    {
+        double t = elapsed();
+        return smoothing(reversed ? 1.0 - t : t);
+    }
+
+    /** @return Whether the animation has not yet reached its end. */
+    bool running() const
+    {
+        return (start_us < 0) || (elapsed() < 1.0);
+    }
+
+    /** Run the animation backwards from its current progress. */
+    void reverse()
+    {
+        if (start_us >= 0)
+        {
+            start_us = now_us - (int64_t)((1.0 - elapsed()) * length_us);
+        }
+
+        reversed = !reversed;
+    }
+
+    /** @return 1 if the animation runs forward, 0 if it was reversed. */
+    int get_direction() const
+    {
+        return !reversed;
+    }
+
+  private:
+    int64_t length_us;
+    wf::animation::smoothing::smooth_function smoothing;
+    int64_t start_us = -1;
+    int64_t now_us   = 0;
+    bool reversed    = false;
+
+    double elapsed() const
+    {
+        if (start_us < 0)
+        {
+            return 0.0;
+        }
+
+        return std::clamp((now_us - start_us) / (double)length_us, 0.0, 1.0);
+    }
+};
+
+/** A value interpolated along the progress of a timeline_progress_t. */
+struct timeline_transition_t
+{
+    double start = 0;
+    double end   = 0;
+
+    void set(double start, double end)
+    {
+        this->start = start;
+        this->end   = end;
+    }
+
+    void flip()
+    {
+        std::swap(start, end);
+    }
+
+    double at(double progress) const
+    {
+        return start + (end - start) * progress;
+    }
+};
+
 class animation_base
 {
   public:
     virtual void init(wayfire_view view, int duration, wf_animation_type type);
-    virtual bool step(); /* return true if continue, false otherwise */
+    /**
+     * Advance the animation to the frame presented at @param target_us
+     * (CLOCK_MONOTONIC microseconds, as given by the animation timeline).
+     * @return true if the animation continues, false otherwise.
+     */
+    virtual bool step(int64_t target_us);
     virtual void reverse(); /* reverse the animation */
     virtual int get_direction();
 
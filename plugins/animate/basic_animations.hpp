@@ -9,8 +9,8 @@ class fade_animation : public animation_base
 {
     wayfire_view view;
 
-    float start = 0, end = 1;
-    wf::animation::simple_animation_t progression;
+    timeline_progress_t progression;
+    timeline_transition_t alpha;
     std::string name;
 
   public:
@@ -18,14 +18,12 @@ class fade_animation : public animation_base
     void init(wayfire_view view, int dur, wf_animation_type type) override
     {
         this->view = view;
-        this->progression =
-            wf::animation::simple_animation_t(wf::create_option<int>(dur));
-
-        this->progression.animate(start, end);
+        this->progression = timeline_progress_t(dur);
+        this->alpha.set(0, 1);
 
         if (type & HIDING_ANIMATION)
         {
-            this->progression.flip();
+            this->alpha.flip();
         }
 
         name = "animation-fade-" + std::to_string(type);
@@ -35,11 +33,12 @@ class fade_animation : public animation_base
             tr, wf::TRANSFORMER_HIGHLEVEL, name);
     }
 
-    bool step() override
+    bool step(int64_t target_us) override
     {
+        progression.set_time(target_us);
         auto transform = view->get_transformed_node()
             ->get_transformer<wf::scene::view_2d_transformer_t>(name);
-        transform->alpha = this->progression;
+        transform->alpha = alpha.at(progression.progress());
 
         return progression.running();
     }
@@ -60,22 +59,11 @@ class fade_animation : public animation_base
     }
 };
 
-using namespace wf::animation;
-
-class zoom_animation_t : public duration_t
-{
-  public:
-    using duration_t::duration_t;
-    timed_transition_t alpha{*this};
-    timed_transition_t zoom{*this};
-    timed_transition_t offset_x{*this};
-    timed_transition_t offset_y{*this};
-};
-
 class zoom_animation : public animation_base
 {
     wayfire_view view;
-    zoom_animation_t progression;
+    timeline_progress_t progression;
+    timeline_transition_t alpha, zoom, offset_x, offset_y;
     std::string name;
 
   public:
@@ -83,16 +71,11 @@ class zoom_animation : public animation_base
     void init(wayfire_view view, int dur, wf_animation_type type) override
     {
         this->view = view;
-        this->progression = zoom_animation_t(wf::create_option<int>(dur));
-        this->progression.alpha = wf::animation::timed_transition_t(
-            this->progression, 0, 1);
-        this->progression.zoom = wf::animation::timed_transition_t(
-            this->progression, 1. / 3, 1);
-        this->progression.offset_x = wf::animation::timed_transition_t(
-            this->progression, 0, 0);
-        this->progression.offset_y = wf::animation::timed_transition_t(
-            this->progression, 0, 0);
-        this->progression.start();
+        this->progression = timeline_progress_t(dur);
+        this->alpha.set(0, 1);
+        this->zoom.set(1. / 3, 1);
+        this->offset_x.set(0, 0);
+        this->offset_y.set(0, 0);
 
         if (type & MINIMIZE_STATE_ANIMATION)
         {
@@ -106,24 +89,24 @@ class zoom_animation : public animation_base
                 int view_cx = bbox.x + bbox.width / 2;
                 int view_cy = bbox.y + bbox.height / 2;
 
-                progression.offset_x.set(1.0 * hint_cx - view_cx, 0);
-                progression.offset_y.set(1.0 * hint_cy - view_cy, 0);
+                offset_x.set(1.0 * hint_cx - view_cx, 0);
+                offset_y.set(1.0 * hint_cy - view_cy, 0);
 
                 if ((bbox.width > 0) && (bbox.height > 0))
                 {
                     double scale_x = 1.0 * hint.width / bbox.width;
                     double scale_y = 1.0 * hint.height / bbox.height;
-                    progression.zoom.set(std::min(scale_x, scale_y), 1);
+                    zoom.set(std::min(scale_x, scale_y), 1);
                 }
             }
         }
 
         if (type & HIDING_ANIMATION)
         {
-            progression.alpha.flip();
-            progression.zoom.flip();
-            progression.offset_x.flip();
-            progression.offset_y.flip();
+            alpha.flip();
+            zoom.flip();
+            offset_x.flip();
+            offset_y.flip();
         }
 
         name = "animation-zoom-" + std::to_string(type);
@@ -132,18 +115,21 @@ class zoom_animation : public animation_base
             tr, wf::TRANSFORMER_HIGHLEVEL, name);
     }
 
-    bool step() override
+    bool step(int64_t target_us) override
     {
+        progression.set_time(target_us);
+        double p = progression.progress();
+
         auto our_transform = view->get_transformed_node()
             ->get_transformer<wf::scene::view_2d_transformer_t>(name);
-        float c = this->progression.zoom;
+        float c = zoom.at(p);
 
-        our_transform->alpha   = this->progression.alpha;
+        our_transform->alpha   = alpha.at(p);
         our_transform->scale_x = c;
         our_transform->scale_y = c;
 
-        our_transform->translation_x = this->progression.offset_x;
-        our_transform->translation_y = this->progression.offset_y;
+        our_transform->translation_x = offset_x.at(p);
+        our_transform->translation_y = offset_y.at(p);
 
         return this->progression.running();
     }
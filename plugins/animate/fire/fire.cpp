@@ -237,13 +237,13 @@ void FireAnimation::init(wayfire_view view, int dur, wf_animation_type type)
 
     auto bbox = view->get_transformed_node()->get_bounding_box();
     int msec  = dur * fire_duration_mod_for_height(bbox.height);
-    this->progression = wf::animation::simple_animation_t(wf::create_option<int>(
-        msec), wf::animation::smoothing::linear);
-    this->progression.animate(0, 1);
+    this->progression = timeline_progress_t(msec,
+        wf::animation::smoothing::linear);
+    this->line.set(0, 1);
 
     if (type & HIDING_ANIMATION)
     {
-        this->progression.flip();
+        this->line.flip();
     }
 
     name = "animation-fire-" + std::to_string(type);
@@ -253,12 +253,13 @@ void FireAnimation::init(wayfire_view view, int dur, wf_animation_type type)
         tr, wf::TRANSFORMER_HIGHLEVEL + 1, name);
 }
 
-bool FireAnimation::step()
+bool FireAnimation::step(int64_t target_us)
 {
+    this->progression.set_time(target_us);
     auto transformer = view->get_transformed_node()
         ->get_transformer<fire_node_t>(name);
 
-    transformer->set_progress_line(this->progression);
+    transformer->set_progress_line(line.at(progression.progress()));
     if (this->progression.running())
     {
         transformer->ps->spawn(transformer->ps->size() / 10);
@@ -14,13 +14,14 @@ class FireAnimation : public animation_base
 {
     std::string name; // the name of the transformer in the view's table
     wayfire_view view;
-    wf::animation::simple_animation_t progression;
+    timeline_progress_t progression;
+    timeline_transition_t line;
 
   public:
 
     ~FireAnimation();
     void init(wayfire_view view, int duration, wf_animation_type type) override;
-    bool step() override; /* return true if continue, false otherwise */
+    bool step(int64_t target_us) override; /* return true if continue, false otherwise */
     void reverse() override; /* reverse the animation */
 };
 
@@ -2,6 +2,10 @@
 #include <wayfire/output.hpp>
 #include <wayfire/workspace-manager.hpp>
 #include <wayfire/util/log.hpp>
+#include <wayfire/memory-accounting.hpp>
+
+/* The intermediate buffers of the blur algorithms */
+static const wf::memory_tag_t blur_buffer_tag = {"blur", "blur buffer"};
 
 static const char *blur_blend_vertex_shader =
     R"(
@@ -97,6 +101,7 @@ void wf_blur_base::render_iteration(wf::region_t blur_region,
     width  = std::max(width, 1);
     height = std::max(height, 1);
 
+    wf::memory_tag_scope_t memory_scope{blur_buffer_tag};
     out.allocate(width, height);
     out.bind();
 
@@ -156,6 +161,7 @@ wlr_box wf_blur_base::copy_region(wf::framebuffer_t& result,
     int degraded_height = subbox.height / degrade_opt;
 
     OpenGL::render_begin(source);
+    wf::memory_tag_scope_t memory_scope{blur_buffer_tag};
     result.allocate(degraded_width, degraded_height);
 
     GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, source.fb));
@@ -209,6 +215,7 @@ void wf_blur_base::pre_render(wlr_box src_box,
     auto view_box = target_fb.framebuffer_box_from_geometry_box(src_box);
 
     OpenGL::render_begin();
+    wf::memory_tag_scope_t memory_scope{blur_buffer_tag};
     fb[1].allocate(view_box.width, view_box.height);
     fb[1].bind();
     GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, fb[0].fb));
@@ -6,6 +6,8 @@
 #include <wayfire/view.hpp>
 #include <wayfire/matcher.hpp>
 #include <wayfire/output.hpp>
+#include <wayfire/output-layout.hpp>
+#include <wayfire/render-manager.hpp>
 #include <wayfire/view-transform.hpp>
 #include <wayfire/workspace-stream.hpp>
 #include <wayfire/workspace-manager.hpp>
@@ -23,6 +25,12 @@
 #include "wayfire/scene-render.hpp"
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-provider.hpp"
+#include "wayfire/memory-accounting.hpp"
+#include "ipc-helpers.hpp"
+#include "ipc-method-repository.hpp"
+#include <map>
+#include <set>
+#include <tuple>
 
 using blur_algorithm_provider =
     std::function<nonstd::observer_ptr<wf_blur_base>()>;
@@ -40,6 +48,209 @@ static int calculate_damage_padding(const wf::render_target_t& target, int blur_
     return std::ceil(blur_radius / scale);
 }
 
+static uint64_t region_area(const wf::region_t& region)
+{
+    uint64_t area = 0;
+    for (const auto& box : region)
+    {
+        area += (uint64_t)(box.x2 - box.x1) * (box.y2 - box.y1);
+    }
+
+    return area;
+}
+
+/**
+ * Counts how much more is repainted because of blur than what was actually
+ * damaged.
+ */
+struct blur_damage_stats_t
+{
+    uint64_t frames = 0;
+    /** Damaged pixels, before expanding the damage for blur. */
+    uint64_t requested_pixels = 0;
+    /** Repainted pixels, after expanding the damage for blur. */
+    uint64_t repainted_pixels = 0;
+    /** Frames which could use the cached background, see blur/cache_padding. */
+    uint64_t cache_hits   = 0;
+    uint64_t cache_misses = 0;
+
+    nlohmann::json to_json() const
+    {
+        nlohmann::json j;
+        j["frames"] = frames;
+        j["requested-pixels"] = requested_pixels;
+        j["repainted-pixels"] = repainted_pixels;
+        j["amplification"]    = requested_pixels ? 1.0 * repainted_pixels / requested_pixels : 1.0;
+        j["cache-hits"]   = cache_hits;
+        j["cache-misses"] = cache_misses;
+        return j;
+    }
+};
+
+/** A blurred node shown on an output, see blur_global_data_t::get_blurred_area(). */
+class blur_area_t
+{
+  public:
+    virtual wf::output_t *get_output() const = 0;
+    virtual wf::geometry_t get_blurred_box() const = 0;
+    virtual ~blur_area_t() = default;
+};
+
+class blur_global_data_t
+{
+    // Before doing a render pass, expand the damage by the blur radius.
+    // This is needed, because when blurring, the pixels that changed
+    // affect a larger area than the really damaged region, e.g. the region
+    // that comes from client damage.
+    wf::signal::connection_t<wf::scene::render_pass_begin_signal>
+    on_render_pass_begin = [=] (wf::scene::render_pass_begin_signal *ev)
+    {
+        if (!provider)
+        {
+            return;
+        }
+
+        pass_target = ev->target;
+        pass_damage = ev->damage;
+        ++pass_serials[target_key(ev->target)];
+
+        const int padding = calculate_damage_padding(ev->target, provider()->calculate_blur_radius());
+        ev->damage.expand_edges(padding);
+        ev->damage &= ev->target.geometry;
+        if (global_cache_enabled())
+        {
+            if (auto area = get_blurred_area(ev->target))
+            {
+                // The padding is sampled from the background caches, so the
+                // damage grows only where the blurred result itself changes.
+                ev->damage &= *area;
+                ev->damage |= pass_damage & ev->target.geometry;
+            }
+        }
+
+        ++stats.frames;
+        stats.requested_pixels += region_area(pass_damage);
+        stats.repainted_pixels += region_area(ev->damage);
+    };
+
+    wf::signal::connection_t<wf::scene::render_pass_end_signal>
+    on_render_pass_end = [=] (wf::scene::render_pass_end_signal *ev)
+    {
+        pass_target.reset();
+        pass_damage.clear();
+    };
+
+    using target_key_t = std::tuple<int, int, int, int>;
+    static target_key_t target_key(const wf::render_target_t& target)
+    {
+        auto& g = target.geometry;
+        return {g.x, g.y, g.width, g.height};
+    }
+
+    // Drop the background caches when blur uses more memory than its budget.
+    // Caching stays disabled until blur/cache_padding is changed, otherwise
+    // the caches would be filled again on the next frame.
+    wf::signal::connection_t<wf::memory_budget_exceeded_signal> on_budget_exceeded =
+        [=] (wf::memory_budget_exceeded_signal *ev)
+    {
+        if ((ev->owner == "blur") && cache_allowed)
+        {
+            LOGI("blur: over the memory budget, disabling background caches");
+            cache_allowed = false;
+            ++cache_generation;
+        }
+    };
+
+    std::optional<wf::render_target_t> pass_target;
+    wf::region_t pass_damage;
+    std::map<target_key_t, uint64_t> pass_serials;
+
+    /**
+     * @return The boxes of all blurred nodes on the output rendered to
+     *   @target, or nullopt if @target is not the framebuffer of an output.
+     */
+    std::optional<wf::region_t> get_blurred_area(const wf::render_target_t& target) const
+    {
+        wf::output_t *output = nullptr;
+        for (auto& wo : wf::get_core().output_layout->get_outputs())
+        {
+            auto fb = wo->render->get_target_framebuffer();
+            if ((fb.fb == target.fb) && (fb.geometry == target.geometry))
+            {
+                output = wo;
+            }
+        }
+
+        if (!output)
+        {
+            return {};
+        }
+
+        wf::region_t area;
+        for (auto& blurred : blurred_areas)
+        {
+            if (blurred->get_output() == output)
+            {
+                area |= blurred->get_blurred_box();
+            }
+        }
+
+        return area;
+    }
+
+  public:
+    /** Increased whenever the background caches should be freed. */
+    uint64_t cache_generation = 0;
+    /** False after the caches were dropped because of the memory budget. */
+    bool cache_allowed = true;
+
+    blur_algorithm_provider provider;
+    wf::option_wrapper_t<bool> cache_padding{"blur/cache_padding"};
+
+    /** The blurred nodes which are currently shown, registered by their render instances. */
+    std::set<blur_area_t*> blurred_areas;
+
+    /** @return Whether the background caches may be used, see blur/cache_padding. */
+    bool global_cache_enabled() const
+    {
+        return cache_padding && cache_allowed;
+    }
+
+    /** Damage expansion of whole render passes. */
+    blur_damage_stats_t stats;
+
+    blur_global_data_t()
+    {
+        wf::get_core().connect(&on_render_pass_begin);
+        wf::get_core().connect(&on_render_pass_end);
+        wf::get_core().connect(&on_budget_exceeded);
+        cache_padding.set_callback([=] () { cache_allowed = true; });
+    }
+
+    /**
+     * @return The damage of the render pass into @target which is currently
+     *   running, before it was expanded for blur, or nullptr if @target is
+     *   not the target of a render pass (for example an auxiliary buffer).
+     */
+    const wf::region_t *get_pass_damage(const wf::render_target_t& target) const
+    {
+        if (pass_target && (pass_target->fb == target.fb) &&
+            (pass_target->geometry == target.geometry))
+        {
+            return &pass_damage;
+        }
+
+        return nullptr;
+    }
+
+    /** @return The number of render passes so far into targets with the geometry of @target. */
+    uint64_t get_pass_serial(const wf::render_target_t& target) const
+    {
+        auto it = pass_serials.find(target_key(target));
+        return it == pass_serials.end() ? 0 : it->second;
+    }
+};
+
 namespace wf
 {
 namespace scene
@@ -48,6 +259,8 @@ class blur_node_t : public floating_inner_node_t
 {
   public:
     blur_algorithm_provider provider;
+    blur_damage_stats_t stats;
+
     blur_node_t(blur_algorithm_provider provider) : floating_inner_node_t(false)
     {
         this->provider = provider;
@@ -62,20 +275,115 @@ class blur_node_t : public floating_inner_node_t
         damage_callback push_damage, wf::output_t *shown_on) override;
 };
 
-class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
+class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>, public blur_area_t
 {
     wf::framebuffer_t saved_pixels;
     wf::region_t saved_pixels_region;
 
+    wf::output_t *shown_on;
+
+    // With blur/cache_padding, a copy of the background below the node, in
+    // the same layout as the render target. Instead of repainting the padding
+    // around the damage every frame, blur samples it from the cache. Only the
+    // part inside the node is kept, because blur never samples outside of it.
+    wf::framebuffer_t background_cache;
+    // The part of the cache to update from the render target, in framebuffer
+    // coordinates.
+    wf::region_t background_update;
+    // Whether render() samples from the cache this frame.
+    bool blur_from_cache = false;
+
+    // Everything which invalidates the cache when it changes.
+    struct cache_key_t
+    {
+        wf::geometry_t target_geometry;
+        std::optional<wf::geometry_t> target_subbuffer;
+        int viewport_width;
+        int viewport_height;
+        float scale;
+        glm::mat4 transform;
+        wf::geometry_t bbox;
+        int padding;
+
+        bool operator ==(const cache_key_t& other) const
+        {
+            return target_geometry == other.target_geometry &&
+                   target_subbuffer == other.target_subbuffer &&
+                   viewport_width == other.viewport_width &&
+                   viewport_height == other.viewport_height &&
+                   scale == other.scale && transform == other.transform &&
+                   bbox == other.bbox && padding == other.padding;
+        }
+    };
+
+    std::optional<cache_key_t> cache_key;
+    uint64_t cache_serial = 0;
+    uint64_t cache_generation = 0;
+
+    wf::shared_data::ref_ptr_t<blur_global_data_t> global_data;
+
+    /**
+     * Check whether the cache contains the background of the previous render
+     * pass with the same parameters, and remember the current parameters.
+     */
+    bool check_cache(const wf::render_target_t& target, wf::geometry_t bbox, int padding)
+    {
+        cache_key_t key = {
+            .target_geometry  = target.geometry,
+            .target_subbuffer = target.subbuffer,
+            .viewport_width   = target.viewport_width,
+            .viewport_height  = target.viewport_height,
+            .scale     = target.scale,
+            .transform = target.transform,
+            .bbox    = bbox,
+            .padding = padding,
+        };
+
+        // If a pass was skipped, the background may have changed since the
+        // last update of the cache.
+        if (cache_generation != global_data->cache_generation)
+        {
+            cache_generation = global_data->cache_generation;
+            cache_key.reset();
+            OpenGL::render_begin();
+            background_cache.release();
+            OpenGL::render_end();
+        }
+
+        const uint64_t serial = global_data->get_pass_serial(target);
+        const bool valid = cache_key && (*cache_key == key) && (serial == cache_serial + 1);
+        cache_key    = key;
+        cache_serial = serial;
+        return valid;
+    }
+
   public:
-    using transformer_render_instance_t::transformer_render_instance_t;
+    blur_render_instance_t(blur_node_t *self, damage_callback push_damage,
+        wf::output_t *shown_on) :
+        transformer_render_instance_t(self, push_damage, shown_on), shown_on(shown_on)
+    {
+        global_data->blurred_areas.insert(this);
+    }
+
     ~blur_render_instance_t()
     {
+        global_data->blurred_areas.erase(this);
         OpenGL::render_begin();
         saved_pixels.release();
+        background_cache.release();
         OpenGL::render_end();
     }
 
+    wf::output_t *get_output() const override
+    {
+        return shown_on;
+    }
+
+    wf::geometry_t get_blurred_box() const override
+    {
+        return self->get_bounding_box();
+    }
+
     bool is_fully_opaque(wf::region_t damage)
     {
         if (self->get_children().size() == 1)
@@ -113,6 +421,8 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
     {
         const int padding = calculate_damage_padding(target, self->provider()->calculate_blur_radius());
         auto bbox = self->get_bounding_box();
+        blur_from_cache = false;
+        background_update.clear();
 
         // In order to render a part of the blurred background, we need to sample
         // from area which is larger than the damaged area. However, the edges
@@ -126,6 +436,19 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
 
         if (is_fully_opaque(padded_region & target.geometry))
         {
+            if ((padded_region & target.geometry).empty())
+            {
+                // Nothing changed below us, so the cache stays up to date.
+                if (cache_key && (cache_serial + 1 == global_data->get_pass_serial(target)))
+                {
+                    ++cache_serial;
+                }
+            } else
+            {
+                // The background below the damage is not repainted.
+                cache_key.reset();
+            }
+
             // If there are no regions to blur, we can directly render them.
             for (auto& ch : this->children)
             {
@@ -135,6 +458,61 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
             return;
         }
 
+        const wf::region_t requested = padded_region & target.geometry;
+        const wf::region_t initial_damage = damage;
+        auto count_stats = [&] ()
+        {
+            auto& stats = self->stats;
+            ++stats.frames;
+            stats.requested_pixels += region_area(requested);
+            stats.repainted_pixels += region_area(requested | (damage ^ initial_damage));
+        };
+
+        const wf::region_t *pass_damage = nullptr;
+        wf::region_t cache_region;
+        if (global_data->global_cache_enabled())
+        {
+            pass_damage  = global_data->get_pass_damage(target);
+            cache_region = bbox;
+            cache_region &= target.geometry;
+        }
+
+        if (pass_damage && check_cache(target, bbox, padding))
+        {
+            ++self->stats.cache_hits;
+
+            // The padding around the damage has not changed since the last
+            // frame, so we only need to repaint the damage itself. However,
+            // the cache has to be updated where the background changed, even
+            // where it is hidden by opaque nodes above us.
+            damage |= *pass_damage & cache_region;
+            background_update = target.framebuffer_region_from_geometry_region(damage & cache_region);
+            blur_from_cache   = true;
+
+            count_stats();
+            instructions.push_back(render_instruction_t{
+                        .instance = this,
+                        .target   = target,
+                        .damage   = requested,
+                    });
+            return;
+        }
+
+        if (pass_damage)
+        {
+            // Repaint the whole node once, so that the cache can be filled.
+            // The nodes below repaint all of it before we render, so the cache
+            // gets only freshly rendered pixels.
+            ++self->stats.cache_misses;
+            padded_region = bbox;
+            background_update = target.framebuffer_region_from_geometry_region(cache_region);
+        } else
+        {
+            // The cache cannot be used for passes we do not know the damage
+            // of, so it has to be filled again afterwards.
+            cache_key.reset();
+        }
+
         padded_region.expand_edges(padding);
         padded_region &= bbox;
 
@@ -153,6 +531,8 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
         // Nodes below should re-render the padded areas so that we can sample from them
         damage |= padded_region;
 
+        static const wf::memory_tag_t saved_pixels_tag = {"blur", "saved pixels"};
+        wf::memory_tag_scope_t memory_scope{saved_pixels_tag};
         OpenGL::render_begin();
         saved_pixels.allocate(target.viewport_width, target.viewport_height);
         saved_pixels.bind();
@@ -169,6 +549,7 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
         }
 
         OpenGL::render_end();
+        count_stats();
         instructions.push_back(render_instruction_t{
                     .instance = this,
                     .target   = target,
@@ -176,14 +557,64 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
                 });
     }
 
+    /** Copy the background in background_update from @target to the cache. */
+    void update_background_cache(const wf::render_target_t& target)
+    {
+        if (background_update.empty())
+        {
+            return;
+        }
+
+        static const wf::memory_tag_t background_cache_tag = {"blur", "background cache"};
+        wf::memory_tag_scope_t memory_scope{background_cache_tag};
+        OpenGL::render_begin();
+        background_cache.allocate(target.viewport_width, target.viewport_height);
+        background_cache.bind();
+        GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, target.fb));
+        for (const auto& box : background_update)
+        {
+            GL_CALL(glBlitFramebuffer(
+                box.x1, target.viewport_height - box.y2,
+                box.x2, target.viewport_height - box.y1,
+                box.x1, target.viewport_height - box.y2,
+                box.x2, target.viewport_height - box.y1,
+                GL_COLOR_BUFFER_BIT, GL_NEAREST));
+        }
+
+        OpenGL::render_end();
+        background_update.clear();
+    }
+
     void render(const wf::render_target_t& target, const wf::region_t& damage) override
     {
+        update_background_cache(target);
+
         auto tex = get_texture(target.scale);
         auto bounding_box = self->get_bounding_box();
         if (!damage.empty())
         {
-            auto translucent_damage = calculate_translucent_damage(target, damage);
-            self->provider()->pre_render(bounding_box, translucent_damage, target);
+            if (blur_from_cache)
+            {
+                // Blur the padded damage, sampling from the cache, which is
+                // laid out exactly like the render target.
+                const int padding = calculate_damage_padding(target,
+                    self->provider()->calculate_blur_radius());
+                wf::region_t blur_region = damage;
+                blur_region.expand_edges(padding);
+                blur_region &= bounding_box;
+                blur_region &= target.geometry;
+
+                wf::render_target_t source = target;
+                source.fb  = background_cache.fb;
+                source.tex = background_cache.tex;
+                self->provider()->pre_render(bounding_box,
+                    calculate_translucent_damage(target, blur_region), source);
+            } else
+            {
+                auto translucent_damage = calculate_translucent_damage(target, damage);
+                self->provider()->pre_render(bounding_box, translucent_damage, target);
+            }
+
             auto reg = target.framebuffer_region_from_geometry_region(damage);
 
             for (const auto& rect : reg)
@@ -235,33 +666,6 @@ void blur_node_t::gen_render_instances(std::vector<render_instance_uptr>& instan
 }
 }
 
-class blur_global_data_t
-{
-    // Before doing a render pass, expand the damage by the blur radius.
-    // This is needed, because when blurring, the pixels that changed
-    // affect a larger area than the really damaged region, e.g. the region
-    // that comes from client damage.
-    wf::signal::connection_t<wf::scene::render_pass_begin_signal>
-    on_render_pass_begin = [=] (wf::scene::render_pass_begin_signal *ev)
-    {
-        if (!provider)
-        {
-            return;
-        }
-
-        const int padding = calculate_damage_padding(ev->target, provider()->calculate_blur_radius());
-        ev->damage.expand_edges(padding);
-        ev->damage &= ev->target.geometry;
-    };
-
-  public:
-    blur_algorithm_provider provider;
-    blur_global_data_t()
-    {
-        wf::get_core().connect(&on_render_pass_begin);
-    }
-};
-
 class wayfire_blur : public wf::per_output_plugin_instance_t
 {
     wf::button_callback button_toggle;
@@ -389,4 +793,66 @@ class wayfire_blur : public wf::per_output_plugin_instance_t
     }
 };
 
-DECLARE_WAYFIRE_PLUGIN(wf::per_output_plugin_t<wayfire_blur>);
+class wayfire_blur_plugin_t : public wf::per_output_plugin_t<wayfire_blur>
+{
+  public:
+    void init() override
+    {
+        per_output_plugin_t::init();
+        method_repository->register_method("blur/stats", get_stats);
+    }
+
+    void fini() override
+    {
+        method_repository->unregister_method("blur/stats");
+        per_output_plugin_t::fini();
+    }
+
+  private:
+    wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
+    wf::shared_data::ref_ptr_t<blur_global_data_t> global_data;
+
+    /**
+     * Report how much the damage was expanded for blur, for whole render
+     * passes and for each blurred view. The amplification is the ratio of
+     * repainted to damaged pixels.
+     */
+    wf::ipc::method_callback get_stats = [=] (nlohmann::json data)
+    {
+        bool reset = false;
+        if (data.is_object() && data.count("reset"))
+        {
+            WFJSON_EXPECT_FIELD(data, "reset", boolean);
+            reset = data["reset"].get<bool>();
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["passes"] = global_data->stats.to_json();
+        response["views"]  = nlohmann::json::array();
+        for (auto& view : wf::get_core().get_all_views())
+        {
+            auto node = view->get_transformed_node()->get_transformer<wf::scene::blur_node_t>();
+            if (!node)
+            {
+                continue;
+            }
+
+            auto stats = node->stats.to_json();
+            stats["id"] = view->get_id();
+            response["views"].push_back(stats);
+            if (reset)
+            {
+                node->stats = {};
+            }
+        }
+
+        if (reset)
+        {
+            global_data->stats = {};
+        }
+
+        return response;
+    };
+};
+
+DECLARE_WAYFIRE_PLUGIN(wayfire_blur_plugin_t);
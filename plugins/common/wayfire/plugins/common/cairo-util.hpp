@@ -99,6 +99,19 @@ struct cairo_text_t
      *   that dimension.
      */
     wf::dimensions_t render_text(const std::string& text, const params& par)
+    {
+        auto ret = rasterize_text(text, par);
+        upload_texture(tex);
+        return ret;
+    }
+
+    /**
+     * Same as render_text(), but render the text only to the cairo surface,
+     * without uploading it to the texture. This does not use OpenGL, so it
+     * may be called from other threads, as long as the object is not used
+     * concurrently.
+     */
+    wf::dimensions_t rasterize_text(const std::string& text, const params& par)
     {
         if (!cr)
         {
@@ -199,11 +212,17 @@ struct cairo_text_t
         g_object_unref(layout);
 
         cairo_surface_flush(surface);
+        return ret;
+    }
+
+    /**
+     * Upload the last text rendered by rasterize_text() to the given texture.
+     */
+    void upload_texture(wf::simple_texture_t& buffer)
+    {
         OpenGL::render_begin();
-        cairo_surface_upload_to_texture(surface, tex);
+        cairo_surface_upload_to_texture(surface, buffer);
         OpenGL::render_end();
-
-        return ret;
     }
 
     /**
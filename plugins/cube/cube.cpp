@@ -12,6 +12,7 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <wayfire/img.hpp>
+#include <wayfire/memory-accounting.hpp>
 
 #include "cube.hpp"
 #include "simple-background.hpp"
@@ -98,6 +99,8 @@ class wayfire_cube : public wf::per_output_plugin_instance_t, public wf::pointer
             void render(const wf::render_target_t& target,
                 const wf::region_t& region, const std::any& tag) override
             {
+                static const wf::memory_tag_t cube_face_tag = {"cube", "cube face"};
+                wf::memory_tag_scope_t memory_scope{cube_face_tag};
                 for (int i = 0; i < (int)ws_instances.size(); i++)
                 {
                     OpenGL::render_begin();
@@ -14,6 +14,7 @@
 #include <wayfire/nonstd/wlroots.hpp>
 #include <wayfire/plugins/common/geometry-animation.hpp>
 #include <wayfire/render-manager.hpp>
+#include <wayfire/snapshot-pool.hpp>
 #include <wayfire/plugins/wobbly/wobbly-signal.hpp>
 
 namespace wf
@@ -31,13 +32,14 @@ class crossfade_node_t : public scene::view_2d_transformer_t
   public:
     wayfire_view view;
     // The contents of the view before the change.
-    wf::render_target_t original_buffer;
+    wf::pooled_snapshot_t original_buffer;
 
   public:
     wf::geometry_t displayed_geometry;
     double overlay_alpha;
 
-    crossfade_node_t(wayfire_view view) : view_2d_transformer_t(view)
+    crossfade_node_t(wayfire_view view) : view_2d_transformer_t(view),
+        original_buffer(view->get_wm_geometry(), view->get_output()->handle->scale)
     {
         displayed_geometry = view->get_wm_geometry();
         this->view = view;
@@ -45,33 +47,17 @@ class crossfade_node_t : public scene::view_2d_transformer_t
         auto root_node = view->get_surface_root_node();
         const wf::geometry_t bbox = root_node->get_bounding_box();
 
-        original_buffer.geometry = view->get_wm_geometry();
-        original_buffer.scale    = view->get_output()->handle->scale;
-
-        OpenGL::render_begin();
-        auto w = original_buffer.scale * original_buffer.geometry.width;
-        auto h = original_buffer.scale * original_buffer.geometry.height;
-        original_buffer.allocate(w, h);
-        OpenGL::render_end();
-
         std::vector<scene::render_instance_uptr> instances;
         root_node->gen_render_instances(instances, [] (auto) {}, view->get_output());
 
         scene::render_pass_params_t params;
         params.background_color = {0, 0, 0, 0};
         params.damage    = bbox;
-        params.target    = original_buffer;
+        params.target    = original_buffer.get_target();
         params.instances = &instances;
         scene::run_render_pass(params, scene::RPASS_CLEAR_BACKGROUND);
     }
 
-    ~crossfade_node_t()
-    {
-        OpenGL::render_begin();
-        original_buffer.release();
-        OpenGL::render_end();
-    }
-
     std::string stringify() const override
     {
         return "crossfade";
@@ -133,7 +119,7 @@ class crossfade_render_instance_t : public scene::render_instance_t
         for (auto& box : region)
         {
             target.logic_scissor(wlr_box_from_pixman_box(box));
-            OpenGL::render_texture({self->original_buffer.tex}, target,
+            OpenGL::render_texture(self->original_buffer.get_texture(), target,
                 self->displayed_geometry, glm::vec4{1.0f, 1.0f, 1.0f, 1.0 - ra});
         }
 
@@ -44,14 +44,11 @@ class wayfire_demo_ipc : public wf::plugin_interface_t
     {
         WFJSON_EXPECT_FIELD(data, "id", number_integer);
 
-        for (auto view : wf::get_core().get_all_views())
+        if (auto view = wf::ipc::find_view_by_id(data["id"]))
         {
-            if (view->get_id() == data["id"])
-            {
-                auto response = wf::ipc::json_ok();
-                response["info"] = view_to_json(view);
-                return response;
-            }
+            auto response = wf::ipc::json_ok();
+            response["info"] = view_to_json(view);
+            return response;
         }
 
         return wf::ipc::json_error("no such view");
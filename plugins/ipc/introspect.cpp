@@ -0,0 +1,396 @@
+#include <wayfire/plugin.hpp>
+#include <wayfire/core.hpp>
+#include <wayfire/output.hpp>
+#include <wayfire/output-layout.hpp>
+#include <wayfire/render-manager.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include <wayfire/snapshot-pool.hpp>
+#include <wayfire/memory-accounting.hpp>
+#include <wayfire/scene-profiler.hpp>
+#include <wayfire/view-transform.hpp>
+#include <wayfire/util.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <time.h>
+
+#include "ipc-method-repository.hpp"
+#include "ipc-helpers.hpp"
+
+namespace wf
+{
+static int64_t get_monotonic_usec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1'000'000ll + ts.tv_nsec / 1000;
+}
+
+/**
+ * Records when the first frame after startup was rendered on any output.
+ */
+class first_frame_tracker_t
+{
+  public:
+    first_frame_tracker_t()
+    {
+        for (auto& wo : wf::get_core().output_layout->get_outputs())
+        {
+            auto hook = std::make_unique<wf::effect_hook_t>([=] () { frame_done(); });
+            wo->render->add_effect(hook.get(), OUTPUT_EFFECT_POST);
+            hooks.emplace_back(wo, std::move(hook));
+        }
+
+        wf::get_core().output_layout->connect(&on_output_removed);
+    }
+
+    ~first_frame_tracker_t()
+    {
+        remove_hooks();
+    }
+
+    /** The time the first frame finished rendering, or 0 if none has been rendered yet. */
+    int64_t first_frame_us = 0;
+
+  private:
+    std::vector<std::pair<wf::output_t*, std::unique_ptr<wf::effect_hook_t>>> hooks;
+    wf::wl_idle_call idle_remove_hooks;
+
+    wf::signal::connection_t<wf::output_pre_remove_signal> on_output_removed =
+        [=] (wf::output_pre_remove_signal *ev)
+    {
+        hooks.erase(std::remove_if(hooks.begin(), hooks.end(),
+            [=] (auto& h) { return h.first == ev->output; }), hooks.end());
+    };
+
+    void frame_done()
+    {
+        if (first_frame_us == 0)
+        {
+            first_frame_us = get_monotonic_usec();
+            // Not safe to remove hooks from inside a hook
+            idle_remove_hooks.run_once([=] () { remove_hooks(); });
+        }
+    }
+
+    void remove_hooks()
+    {
+        for (auto& [wo, hook] : hooks)
+        {
+            wo->render->rem_effect(hook.get());
+        }
+
+        hooks.clear();
+    }
+};
+
+static nlohmann::json usage_to_json(const wf::memory_accounting_t::usage_t& usage)
+{
+    nlohmann::json j;
+    j["live-bytes"] = usage.live_bytes;
+    j["peak-bytes"] = usage.peak_bytes;
+    j["allocations"] = usage.allocations;
+    return j;
+}
+
+static std::string demangle(const char *name)
+{
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result = (status == 0) ? demangled : name;
+    free(demangled);
+    return result;
+}
+
+static nlohmann::json profile_to_json(const wf::scene::node_profile_t& profile)
+{
+    nlohmann::json j;
+    j["render-instances"] = profile.render_instances;
+    j["schedule-calls"]   = profile.schedule_calls;
+    j["schedule-us"]  = profile.schedule_ns / 1000.0;
+    j["render-calls"] = profile.render_calls;
+    j["render-us"]    = profile.render_ns / 1000.0;
+
+    j["damage"] = nlohmann::json::array();
+    for (auto& record : profile.damage)
+    {
+        int64_t area = 0;
+        for (auto& box : record.region)
+        {
+            area += int64_t(box.x2 - box.x1) * (box.y2 - box.y1);
+        }
+
+        nlohmann::json d;
+        d["pass"]    = record.pass;
+        d["area"]    = area;
+        d["extents"] = wf::ipc::geometry_to_json(
+            wlr_box_from_pixman_box(record.region.get_extents()));
+        j["damage"].push_back(d);
+    }
+
+    return j;
+}
+
+static nlohmann::json node_to_json(wf::scene::node_t *node)
+{
+    nlohmann::json j;
+    j["type"] = demangle(typeid(*node).name());
+    j["description"] = node->stringify();
+    j["enabled"] = node->is_enabled();
+    j["flags"]   = node->flags();
+    j["bbox"]    = wf::ipc::geometry_to_json(node->get_bounding_box());
+
+    if (auto tmgr = dynamic_cast<wf::scene::transform_manager_node_t*>(node))
+    {
+        j["transformers"] = nlohmann::json::array();
+        for (auto& tr : tmgr->get_transformers())
+        {
+            nlohmann::json t;
+            t["name"]    = tr.name;
+            t["z-order"] = tr.z_order;
+            j["transformers"].push_back(t);
+        }
+    }
+
+    if (auto profile = wf::get_core().scene_profiler->get_profile(node))
+    {
+        j["profile"] = profile_to_json(*profile);
+    }
+
+    j["children"] = nlohmann::json::array();
+    for (auto& ch : node->get_children())
+    {
+        j["children"].push_back(node_to_json(ch.get()));
+    }
+
+    return j;
+}
+
+/**
+ * The introspect plugin reports the internal state of the compositor over
+ * IPC: the startup profile, animation timelines, snapshot buffers, memory
+ * accounting and the scenegraph. Unlike stipc, it does not inject input or
+ * change the session, so it is built even without the debug_ipc option.
+ */
+class introspect_plugin_t : public wf::plugin_interface_t
+{
+    wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
+
+  public:
+    void init() override
+    {
+        method_repository->register_method("introspect/startup", startup);
+        method_repository->register_method("introspect/animation/stats", animation_stats);
+        method_repository->register_method("introspect/snapshot_pool/stats", snapshot_pool_stats);
+        method_repository->register_method("introspect/memory/stats", memory_stats);
+        method_repository->register_method("introspect/memory/set_budget", memory_set_budget);
+        method_repository->register_method("introspect/scene/dump", scene_dump);
+        first_frame = std::make_unique<first_frame_tracker_t>();
+    }
+
+    void fini() override
+    {
+        method_repository->unregister_method("introspect/startup");
+        method_repository->unregister_method("introspect/animation/stats");
+        method_repository->unregister_method("introspect/snapshot_pool/stats");
+        method_repository->unregister_method("introspect/memory/stats");
+        method_repository->unregister_method("introspect/memory/set_budget");
+        method_repository->unregister_method("introspect/scene/dump");
+    }
+
+    std::unique_ptr<first_frame_tracker_t> first_frame;
+
+    /**
+     * Report how long the startup took, from the initialization of core until
+     * the first frame was rendered, and the load time of each plugin.
+     */
+    ipc::method_callback startup = [=] (nlohmann::json)
+    {
+        auto profile = wf::get_core().get_startup_profile();
+        auto since_init = [&] (int64_t us) -> nlohmann::json
+        {
+            if (us == 0)
+            {
+                return nullptr;
+            }
+
+            return (us - profile.init_start_us) / 1000.0;
+        };
+
+        auto response = wf::ipc::json_ok();
+        auto& report  = response["report"];
+        report["plugins-start-ms"]    = since_init(profile.plugins_start_us);
+        report["plugins-done-ms"]     = since_init(profile.plugins_done_us);
+        report["startup-finished-ms"] = since_init(profile.startup_finished_us);
+        report["first-frame-ms"] = since_init(first_frame->first_frame_us);
+
+        std::sort(profile.plugins.begin(), profile.plugins.end(), [] (auto& a, auto& b)
+        {
+            return a.load_us + a.create_us + a.init_us > b.load_us + b.create_us + b.init_us;
+        });
+
+        report["plugins"] = nlohmann::json::array();
+        for (auto& plugin : profile.plugins)
+        {
+            nlohmann::json p;
+            p["name"]      = plugin.name;
+            p["open-ms"]   = plugin.load_us / 1000.0;
+            p["create-ms"] = plugin.create_us / 1000.0;
+            p["init-ms"]   = plugin.init_us / 1000.0;
+            report["plugins"].push_back(p);
+        }
+
+        return response;
+    };
+
+    /**
+     * Report the number of running animations and the cost of ticking the
+     * animation timeline of each output.
+     */
+    ipc::method_callback animation_stats = [=] (nlohmann::json data)
+    {
+        auto response = wf::ipc::json_ok();
+        response["outputs"] = nlohmann::json::array();
+        for (auto& wo : wf::get_core().output_layout->get_outputs())
+        {
+            auto& timeline = wo->render->get_animation_timeline();
+            auto& stats    = timeline.get_stats();
+
+            nlohmann::json output;
+            output["name"] = wo->to_string();
+            output["running"] = timeline.size();
+            output["ticks"] = stats.ticks;
+            output["animations-ticked"] = stats.animations_ticked;
+            output["last-tick-us"]  = stats.last_tick_us;
+            output["total-tick-us"] = stats.total_tick_us;
+            output["max-tick-us"]   = stats.max_tick_us;
+            response["outputs"].push_back(output);
+        }
+
+        return response;
+    };
+
+    /**
+     * Report the usage of the pool of snapshot buffers. With `clear`, the
+     * idle buffers are freed after reporting.
+     */
+    ipc::method_callback snapshot_pool_stats = [=] (nlohmann::json data)
+    {
+        auto& pool  = wf::get_core().snapshot_pool;
+        auto& stats = pool->get_stats();
+
+        auto response = wf::ipc::json_ok();
+        response["hits"] = stats.hits;
+        response["misses"]    = stats.misses;
+        response["evictions"] = stats.evictions;
+        response["allocated-bytes"] = stats.allocated_bytes;
+        response["idle-bytes"] = stats.idle_bytes;
+        response["buffers-in-use"] = stats.buffers_in_use;
+
+        if (data.count("clear") && data["clear"].is_boolean() && data["clear"])
+        {
+            pool->clear();
+        }
+
+        return response;
+    };
+
+    /**
+     * Report the memory tracked for each owner and for each tag, with the
+     * budgets of the owners.
+     */
+    ipc::method_callback memory_stats = [=] (nlohmann::json)
+    {
+        auto& accounting = wf::get_core().memory_accounting;
+
+        auto response = wf::ipc::json_ok();
+        response["total"]  = usage_to_json(accounting->get_total_usage());
+        response["owners"] = nlohmann::json::object();
+        for (auto& [owner, usage] : accounting->get_usage_by_owner())
+        {
+            response["owners"][owner] = usage_to_json(usage);
+        }
+
+        for (auto& [owner, budget] : accounting->get_budgets())
+        {
+            response["owners"][owner]["budget"] = budget;
+        }
+
+        response["tags"] = nlohmann::json::array();
+        for (auto& [tag, usage] : accounting->get_usage_by_tag())
+        {
+            auto j = usage_to_json(usage);
+            j["owner"]   = tag.owner;
+            j["purpose"] = tag.purpose;
+            j["node"]    = tag.node;
+            response["tags"].push_back(j);
+        }
+
+        return response;
+    };
+
+    /** Set the soft memory budget of `owner` to `bytes`, 0 removes it. */
+    ipc::method_callback memory_set_budget = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "owner", string);
+        WFJSON_EXPECT_FIELD(data, "bytes", number_unsigned);
+        wf::get_core().memory_accounting->set_budget(
+            data["owner"].get<std::string>(), data["bytes"].get<size_t>());
+        return wf::ipc::json_ok();
+    };
+
+    /**
+     * Dump the whole scenegraph: the type, description, flags and bounding box
+     * of each node, and the transformers of views.
+     *
+     * Optional parameters:
+     * - `profile`: enable or disable the scene profiler. While it is enabled,
+     *   each node also reports its damage during the last render passes, and
+     *   the time spent scheduling and rendering its render instances.
+     *   Render instances are only wrapped, and thus `render-instances` and
+     *   the timings are only reported, for the children of generic inner
+     *   nodes and of output nodes. Nodes below a view or a transformer
+     *   generate their instances themselves and report 0, their time is
+     *   included in that of the view's node.
+     * - `history`: the number of render passes for which damage is kept.
+     * - `reset`: forget the data recorded so far, before dumping.
+     */
+    ipc::method_callback scene_dump = [=] (nlohmann::json data)
+    {
+        auto& profiler = wf::get_core().scene_profiler;
+        if (data.is_object())
+        {
+            if (data.count("history"))
+            {
+                WFJSON_EXPECT_FIELD(data, "history", number_unsigned);
+                profiler->set_history(data["history"].get<size_t>());
+            }
+
+            if (data.count("profile"))
+            {
+                WFJSON_EXPECT_FIELD(data, "profile", boolean);
+                profiler->set_enabled(data["profile"].get<bool>());
+            }
+
+            if (data.count("reset"))
+            {
+                WFJSON_EXPECT_FIELD(data, "reset", boolean);
+                if (data["reset"].get<bool>())
+                {
+                    profiler->reset();
+                }
+            }
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["profiling"] = profiler->is_enabled();
+        response["history"]   = profiler->get_history();
+        response["passes"]    = profiler->get_pass_count();
+        response["root"] = node_to_json(wf::get_core().scene().get());
+        return response;
+    };
+};
+}
+
+DECLARE_WAYFIRE_PLUGIN(wf::introspect_plugin_t);
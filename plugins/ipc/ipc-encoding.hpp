@@ -0,0 +1,54 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace wf
+{
+namespace ipc
+{
+/**
+ * The encoding of the messages exchanged with a client. Every message is
+ * preceded by its length as a 4-byte integer, regardless of the encoding.
+ *
+ * Clients start with JSON and may switch to a binary encoding with the
+ * ipc/set-encoding method. The reply to that method is still sent in the old
+ * encoding, all messages after it in both directions use the new one.
+ */
+enum class encoding_t
+{
+    JSON,
+    CBOR,
+    MSGPACK,
+};
+
+/** Encode a message, without the length header. */
+inline std::string encode_message(const nlohmann::json& message, encoding_t encoding)
+{
+    if (encoding == encoding_t::JSON)
+    {
+        return message.dump();
+    }
+
+    auto bytes = (encoding == encoding_t::CBOR) ?
+        nlohmann::json::to_cbor(message) : nlohmann::json::to_msgpack(message);
+    return std::string(bytes.begin(), bytes.end());
+}
+
+/** Decode a message. The result is discarded if the message is invalid. */
+inline nlohmann::json decode_message(const char *data, size_t len, encoding_t encoding)
+{
+    switch (encoding)
+    {
+      case encoding_t::CBOR:
+        return nlohmann::json::from_cbor(data, data + len, true, false);
+
+      case encoding_t::MSGPACK:
+        return nlohmann::json::from_msgpack(data, data + len, true, false);
+
+      default:
+        return nlohmann::json::parse(data, data + len, nullptr, false);
+    }
+}
+}
+}
@@ -5,7 +5,7 @@
 #include <wayfire/view.hpp>
 #include <wayfire/core.hpp>
 #include <wayfire/output-layout.hpp>
-#include <wayfire/core.hpp>
+#include <wayfire/view-registry.hpp>
 #include <nlohmann/json.hpp>
 
 namespace wf
@@ -14,15 +14,7 @@ namespace ipc
 {
 inline wayfire_view find_view_by_id(uint32_t id)
 {
-    for (auto view : wf::get_core().get_all_views())
-    {
-        if (view->get_id() == id)
-        {
-            return view;
-        }
-    }
-
-    return nullptr;
+    return wf::get_core().view_registry->find_by_id(id);
 }
 
 inline wf::output_t *find_output_by_id(int32_t id)
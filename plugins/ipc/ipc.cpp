@@ -1,9 +1,12 @@
 #include "ipc.hpp"
+#include "ipc-helpers.hpp"
+#include "wayfire/signal-definitions.hpp"
 #include "wayfire/plugins/common/shared-core-data.hpp"
 #include <wayfire/util/log.hpp>
 #include <wayfire/core.hpp>
 #include <wayfire/plugin.hpp>
 
+#include <algorithm>
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
@@ -25,6 +28,78 @@ wf::ipc::server_t::server_t()
     {
         do_accept_new_client();
     };
+
+    idle_flush_events.set_callback([=] ()
+    {
+        for (auto& client : clients)
+        {
+            client->flush_events();
+        }
+    });
+
+    idle_disconnect.set_callback([=] ()
+    {
+        auto to_disconnect = std::move(clients_to_disconnect);
+        clients_to_disconnect.clear();
+        for (auto& client : to_disconnect)
+        {
+            client_disappeared(client);
+        }
+    });
+
+    on_subscribe = [=] (nlohmann::json data)
+    {
+        if (!current_client)
+        {
+            return json_error("subscribe is only available to IPC clients");
+        }
+
+        std::vector<std::string> events;
+        if (data.is_object() && data.count("events"))
+        {
+            if (!data["events"].is_array())
+            {
+                return json_error("Field \"events\" does not have the correct type array");
+            }
+
+            for (auto& event : data["events"])
+            {
+                if (!event.is_string())
+                {
+                    return json_error("Event names must be strings");
+                }
+
+                events.push_back(event);
+            }
+        }
+
+        current_client->subscribe(std::move(events));
+        return json_ok();
+    };
+
+    on_set_encoding = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "encoding", string);
+        if (!current_client)
+        {
+            return json_error("set-encoding is only available to IPC clients");
+        }
+
+        static const std::map<std::string, encoding_t> encodings = {
+            {"json", encoding_t::JSON},
+            {"cbor", encoding_t::CBOR},
+            {"msgpack", encoding_t::MSGPACK},
+        };
+
+        auto it = encodings.find(data["encoding"].get<std::string>());
+        if (it == encodings.end())
+        {
+            return json_error("Unsupported encoding");
+        }
+
+        current_client->set_encoding(it->second);
+        return json_ok();
+    };
 }
 
 void wf::ipc::server_t::init(std::string socket_path)
@@ -39,10 +114,14 @@ void wf::ipc::server_t::init(std::string socket_path)
     listen(fd, 3);
     source = wl_event_loop_add_fd(wl_display_get_event_loop(wf::get_core().display),
         fd, WL_EVENT_READABLE, wl_loop_handle_ipc_fd_connection, &accept_new_client);
+    method_repository->register_method("ipc/subscribe", on_subscribe);
+    method_repository->register_method("ipc/set-encoding", on_set_encoding);
 }
 
 wf::ipc::server_t::~server_t()
 {
+    method_repository->unregister_method("ipc/subscribe");
+    method_repository->unregister_method("ipc/set-encoding");
     if (fd != -1)
     {
         close(fd);
@@ -119,6 +198,7 @@ void wf::ipc::server_t::do_accept_new_client()
 void wf::ipc::server_t::client_disappeared(client_t *client)
 {
     LOGD("Removing IPC client ", client);
+    clients_to_disconnect.erase(client);
 
     client_disconnected_signal ev;
     ev.client = client;
@@ -129,12 +209,63 @@ void wf::ipc::server_t::client_disappeared(client_t *client)
     clients.erase(it, clients.end());
 }
 
+void wf::ipc::server_t::disconnect_client_later(client_t *client)
+{
+    clients_to_disconnect.insert(client);
+    idle_disconnect.run_once();
+}
+
+size_t wf::ipc::server_t::get_max_buffer_size() const
+{
+    return std::max(0, (int)max_buffer_size);
+}
+
+wf::ipc::backpressure_policy_t wf::ipc::server_t::get_backpressure_policy() const
+{
+    const std::string policy = backpressure_policy;
+    if (policy == "drop")
+    {
+        return backpressure_policy_t::DROP;
+    } else if (policy == "disconnect")
+    {
+        return backpressure_policy_t::DISCONNECT;
+    }
+
+    return backpressure_policy_t::COALESCE;
+}
+
+bool wf::ipc::server_t::has_subscribers(const std::string& event) const
+{
+    return std::any_of(clients.begin(), clients.end(),
+        [&] (const auto& client) { return client->is_subscribed(event); });
+}
+
+void wf::ipc::server_t::publish_event(const std::string& name,
+    nlohmann::json event, const std::string& coalesce_key)
+{
+    event["event"] = name;
+    for (auto& client : clients)
+    {
+        if (client->is_subscribed(name))
+        {
+            client->queue_event(name + "/" + coalesce_key, event);
+            idle_flush_events.run_once();
+        }
+    }
+}
+
 void wf::ipc::server_t::handle_incoming_message(
     client_t *client, nlohmann::json message)
 {
     this->current_client = client;
     client->send_json(method_repository->call_method(message["method"], message["data"]));
     this->current_client = nullptr;
+
+    if (client->next_encoding)
+    {
+        client->encoding = *client->next_encoding;
+        client->next_encoding.reset();
+    }
 }
 
 /* --------------------------- Per-client code ------------------------------*/
@@ -163,6 +294,15 @@ wf::ipc::client_t::client_t(server_t *ipc, int fd)
     buffer.resize(MAX_MESSAGE_LEN + 1);
     this->handle_fd_activity = [=] (uint32_t event_mask)
     {
+        if (event_mask & WL_EVENT_WRITABLE)
+        {
+            flush_outgoing();
+            if (!(event_mask & ~WL_EVENT_WRITABLE))
+            {
+                return;
+            }
+        }
+
         handle_fd_incoming(event_mask);
     };
 }
@@ -251,10 +391,11 @@ void wf::ipc::client_t::handle_fd_incoming(uint32_t event_mask)
         // Finally, received the message, make sure we have a terminating NULL byte
         buffer[current_buffer_valid] = '\0';
         char *str    = buffer.data() + HEADER_LEN;
-        auto message = nlohmann::json::parse(str, nullptr, false);
+        auto message = decode(str, len);
         if (message.is_discarded())
         {
-            LOGE("Client's message could not be parsed: ", str);
+            LOGE("Client's message could not be parsed",
+                (encoding == encoding_t::JSON) ? std::string(": ") + str : std::string("!"));
             ipc->client_disappeared(this);
             return;
         }
@@ -279,29 +420,171 @@ wf::ipc::client_t::~client_t()
     close(this->fd);
 }
 
-static bool write_exact(int fd, char *buf, int n)
+/**
+ * Replies are always queued, but a client which lets this much data pile up
+ * (relative to the configured buffer size) is not reading at all.
+ */
+static constexpr size_t HARD_LIMIT_FACTOR = 4;
+
+void wf::ipc::client_t::set_encoding(encoding_t encoding)
+{
+    if (ipc->current_client == this)
+    {
+        next_encoding = encoding;
+    } else
+    {
+        this->encoding = encoding;
+    }
+}
+
+nlohmann::json wf::ipc::client_t::decode(const char *data, size_t len)
+{
+    return decode_message(data, len, encoding);
+}
+
+void wf::ipc::client_t::queue_json(const nlohmann::json& message)
+{
+    auto bytes = encode_message(message, encoding);
+    queue_message(bytes.data(), bytes.size());
+}
+
+void wf::ipc::client_t::queue_message(const char *data, size_t len)
+{
+    if (pending_bytes() + len + HEADER_LEN >
+        std::max(ipc->get_max_buffer_size(), (size_t)MAX_MESSAGE_LEN) * HARD_LIMIT_FACTOR)
+    {
+        LOGE("IPC client ", this, " is not reading its messages, disconnecting.");
+        ipc->disconnect_client_later(this);
+        return;
+    }
+
+    uint32_t header = len;
+    outgoing.insert(outgoing.end(), (char*)&header, (char*)&header + HEADER_LEN);
+    outgoing.insert(outgoing.end(), data, data + len);
+    flush_outgoing();
+}
+
+void wf::ipc::client_t::flush_outgoing()
 {
-    while (n > 0)
+    while (pending_bytes() > 0)
     {
-        int w = write(fd, buf, n);
-        if (w <= 0)
+        ssize_t w = send(fd, outgoing.data() + outgoing_start, pending_bytes(), MSG_NOSIGNAL);
+        if (w < 0)
         {
-            return false;
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+            {
+                LOGE("Failed to write to IPC client ", this, ": ", strerror(errno));
+                ipc->disconnect_client_later(this);
+                return;
+            }
+
+            break;
         }
 
-        n -= w;
+        outgoing_start += w;
+    }
+
+    if (pending_bytes() == 0)
+    {
+        outgoing.clear();
+        outgoing_start = 0;
+    } else if (outgoing_start > outgoing.size() / 2)
+    {
+        outgoing.erase(outgoing.begin(), outgoing.begin() + outgoing_start);
+        outgoing_start = 0;
+    }
+
+    // Wait for the socket to become writable only while there is data left.
+    const bool need_writable = pending_bytes() > 0;
+    if (need_writable != waiting_writable)
+    {
+        waiting_writable = need_writable;
+        wl_event_source_fd_update(source,
+            WL_EVENT_READABLE | (need_writable ? WL_EVENT_WRITABLE : 0));
     }
 
-    return true;
+    // The client caught up, send the events which were held back.
+    if (!need_writable && !pending_events.empty())
+    {
+        flush_events();
+    }
 }
 
 void wf::ipc::client_t::send_json(nlohmann::json json)
 {
-    std::string buffer = json.dump();
-    uint32_t len = buffer.length();
+    queue_json(json);
+}
+
+void wf::ipc::client_t::subscribe(std::vector<std::string> events)
+{
+    if (events.empty())
+    {
+        subscribed_all = true;
+    }
+
+    subscriptions.insert(events.begin(), events.end());
+}
+
+bool wf::ipc::client_t::is_subscribed(const std::string& event) const
+{
+    return subscribed_all || subscriptions.count(event);
+}
+
+void wf::ipc::client_t::queue_event(const std::string& coalesce_key, nlohmann::json event)
+{
+    const bool full = pending_bytes() >= ipc->get_max_buffer_size();
+    if (full)
+    {
+        switch (ipc->get_backpressure_policy())
+        {
+          case backpressure_policy_t::DROP:
+            return;
+
+          case backpressure_policy_t::DISCONNECT:
+            LOGE("IPC client ", this, " is too slow, disconnecting.");
+            ipc->disconnect_client_later(this);
+            return;
+
+          case backpressure_policy_t::COALESCE:
+            break;
+        }
+    }
+
+    // Under the coalescing policy, a newer event replaces an older pending one
+    // with the same key, so that the pending events stay bounded.
+    if (ipc->get_backpressure_policy() == backpressure_policy_t::COALESCE)
+    {
+        auto it = pending_event_keys.find(coalesce_key);
+        if (it != pending_event_keys.end())
+        {
+            pending_events[it->second] = std::move(event);
+            return;
+        }
+
+        pending_event_keys[coalesce_key] = pending_events.size();
+    }
+
+    pending_events.push_back(std::move(event));
+}
+
+void wf::ipc::client_t::flush_events()
+{
+    if (pending_events.empty() || (pending_bytes() >= ipc->get_max_buffer_size()))
+    {
+        // Nothing to do, or wait until the client has read what it already has.
+        return;
+    }
 
-    write_exact(fd, (char*)&len, 4);
-    write_exact(fd, buffer.data(), len);
+    nlohmann::json batch;
+    batch["events"] = std::move(pending_events);
+    pending_events.clear();
+    pending_event_keys.clear();
+    queue_json(batch);
 }
 
 namespace wf
@@ -311,6 +594,62 @@ class ipc_plugin_t : public wf::plugin_interface_t
   private:
     shared_data::ref_ptr_t<ipc::server_t> server;
 
+    static nlohmann::json view_to_json(wayfire_view view)
+    {
+        nlohmann::json description;
+        description["id"]     = view->get_id();
+        description["app-id"] = view->get_app_id();
+        description["title"]  = view->get_title();
+        description["geometry"] = ipc::geometry_to_json(view->get_wm_geometry());
+        description["output"]   = view->get_output() ? (int)view->get_output()->get_id() : -1;
+        return description;
+    }
+
+    void publish_view_event(const std::string& name, wayfire_view view)
+    {
+        if (view && server->has_subscribers(name))
+        {
+            nlohmann::json event;
+            event["view"] = view_to_json(view);
+            server->publish_event(name, std::move(event), std::to_string(view->get_id()));
+        }
+    }
+
+    wf::signal::connection_t<wf::view_mapped_signal> on_view_mapped = [=] (wf::view_mapped_signal *ev)
+    {
+        publish_view_event("view-mapped", ev->view);
+    };
+
+    wf::signal::connection_t<wf::view_unmapped_signal> on_view_unmapped =
+        [=] (wf::view_unmapped_signal *ev)
+    {
+        publish_view_event("view-unmapped", ev->view);
+    };
+
+    wf::signal::connection_t<wf::view_title_changed_signal> on_title_changed =
+        [=] (wf::view_title_changed_signal *ev)
+    {
+        publish_view_event("view-title-changed", ev->view);
+    };
+
+    wf::signal::connection_t<wf::view_app_id_changed_signal> on_app_id_changed =
+        [=] (wf::view_app_id_changed_signal *ev)
+    {
+        publish_view_event("view-app-id-changed", ev->view);
+    };
+
+    wf::signal::connection_t<wf::view_geometry_changed_signal> on_geometry_changed =
+        [=] (wf::view_geometry_changed_signal *ev)
+    {
+        publish_view_event("view-geometry-changed", ev->view);
+    };
+
+    wf::signal::connection_t<wf::keyboard_focus_changed_signal> on_focus_changed =
+        [=] (wf::keyboard_focus_changed_signal *ev)
+    {
+        publish_view_event("view-focused", wf::node_to_view(ev->new_focus));
+    };
+
   public:
     void init() override
     {
@@ -319,6 +658,13 @@ class ipc_plugin_t : public wf::plugin_interface_t
         std::string socket = pre_socket ?: "/tmp/wayfire-" + dname + ".socket";
         setenv("WAYFIRE_SOCKET", socket.c_str(), 1);
         server->init(socket);
+
+        wf::get_core().connect(&on_view_mapped);
+        wf::get_core().connect(&on_view_unmapped);
+        wf::get_core().connect(&on_title_changed);
+        wf::get_core().connect(&on_app_id_changed);
+        wf::get_core().connect(&on_geometry_changed);
+        wf::get_core().connect(&on_focus_changed);
     }
 
     bool is_unloadable() override
@@ -4,17 +4,41 @@
 #include <sys/un.h>
 #include <wayfire/object.hpp>
 #include <variant>
+#include <map>
+#include <optional>
+#include <set>
 #include <wayland-server.h>
 #include <wayfire/plugins/common/shared-core-data.hpp>
 #include "ipc-method-repository.hpp"
+#include "ipc-encoding.hpp"
 #include "wayfire/signal-provider.hpp"
+#include "wayfire/util.hpp"
+#include <wayfire/option-wrapper.hpp>
 
 namespace wf
 {
 namespace ipc
 {
+/**
+ * What the server does with events for a client whose outgoing buffer is full,
+ * i.e. a client which does not read its socket fast enough.
+ */
+enum class backpressure_policy_t
+{
+    /** Drop new events until the client catches up. */
+    DROP,
+    /** Keep only the latest event per event type and view until the client catches up. */
+    COALESCE,
+    /** Disconnect the client. */
+    DISCONNECT,
+};
+
 /**
  * Represents a single connected client to the IPC socket.
+ *
+ * Messages to the client are never written with blocking calls. They are
+ * appended to a per-client outgoing buffer, which is drained whenever the
+ * socket becomes writable, so that a slow client cannot stall the compositor.
  */
 class server_t;
 class client_t
@@ -22,8 +46,37 @@ class client_t
   public:
     client_t(server_t *server, int client_fd);
     ~client_t();
+
+    /**
+     * Queue a message for the client. Replies are always queued, unless the
+     * client has fallen so far behind that it has to be disconnected.
+     */
     void send_json(nlohmann::json json);
 
+    /**
+     * Subscribe the client to the given events. An empty list subscribes it to
+     * all events.
+     */
+    void subscribe(std::vector<std::string> events);
+
+    /** Check whether the client is subscribed to the given event. */
+    bool is_subscribed(const std::string& event) const;
+
+    /**
+     * Queue an event for the client. Events are sent in batches, once per
+     * iteration of the event loop, see server_t::publish_event().
+     */
+    void queue_event(const std::string& coalesce_key, nlohmann::json event);
+
+    /** Send all pending events as a single batch. */
+    void flush_events();
+
+    /**
+     * Switch the encoding used with the client. If a method call from this
+     * client is in progress, the switch happens after its reply is sent.
+     */
+    void set_encoding(encoding_t encoding);
+
   private:
     int fd;
     wl_event_source *source;
@@ -36,6 +89,41 @@ class client_t
     /** Handle incoming data on the socket */
     std::function<void(uint32_t)> handle_fd_activity;
     void handle_fd_incoming(uint32_t);
+
+    /**
+     * Data which has not been written to the socket yet. The valid data starts
+     * at outgoing_start, the buffer is compacted once it has been drained.
+     */
+    std::vector<char> outgoing;
+    size_t outgoing_start = 0;
+    bool waiting_writable = false;
+
+    size_t pending_bytes() const
+    {
+        return outgoing.size() - outgoing_start;
+    }
+
+    encoding_t encoding = encoding_t::JSON;
+    std::optional<encoding_t> next_encoding;
+
+    /** Encode a message with the client's encoding and queue it. */
+    void queue_json(const nlohmann::json& message);
+    /** Decode a message in the client's encoding, discarded on error. */
+    nlohmann::json decode(const char *data, size_t len);
+
+    /** Append a message with its length header to the outgoing buffer. */
+    void queue_message(const char *data, size_t len);
+    /** Write as much of the outgoing buffer as possible without blocking. */
+    void flush_outgoing();
+
+    bool subscribed_all = false;
+    std::set<std::string> subscriptions;
+
+    /** Events waiting for the next batch, and the index of each coalesce key. */
+    std::vector<nlohmann::json> pending_events;
+    std::map<std::string, size_t> pending_event_keys;
+
+    friend class server_t;
 };
 
 /**
@@ -66,6 +154,28 @@ class server_t : public wf::signal::provider_t
         return current_client;
     }
 
+    /**
+     * Send an event to all clients subscribed to it.
+     *
+     * Events are not written immediately. They are collected per client and
+     * sent as one batch when the event loop goes idle. If a client's buffer is
+     * full, the event is handled according to the backpressure policy.
+     *
+     * @param name The name of the event, clients subscribe to events by name.
+     * @param event The event data. The event name is added to it as "event".
+     * @param coalesce_key Events with the same name and coalesce key may be
+     *   merged under the COALESCE policy, so that only the last one is sent.
+     */
+    void publish_event(const std::string& name, nlohmann::json event,
+        const std::string& coalesce_key = "");
+
+    /** Check whether any client is subscribed to the given event. */
+    bool has_subscribers(const std::string& event) const;
+
+    /** The configured limit on the unsent data per client, in bytes. */
+    size_t get_max_buffer_size() const;
+    backpressure_policy_t get_backpressure_policy() const;
+
   private:
     friend class client_t;
     wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
@@ -76,6 +186,19 @@ class server_t : public wf::signal::provider_t
 
     void client_disappeared(client_t *client);
 
+    /**
+     * Disconnect a client once the event loop is idle. Used when the client
+     * cannot be destroyed immediately, e.g. while sending to it.
+     */
+    void disconnect_client_later(client_t *client);
+    std::set<client_t*> clients_to_disconnect;
+    wf::wl_idle_call idle_disconnect;
+
+    wf::wl_idle_call idle_flush_events;
+
+    wf::option_wrapper_t<int> max_buffer_size{"ipc/max_client_buffer"};
+    wf::option_wrapper_t<std::string> backpressure_policy{"ipc/backpressure_policy"};
+
     int fd = -1;
 
     /**
@@ -88,6 +211,9 @@ class server_t : public wf::signal::provider_t
 
     std::function<void()> accept_new_client;
     void do_accept_new_client();
+
+    method_callback on_subscribe;
+    method_callback on_set_encoding;
 };
 }
 }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace wf
+{
+namespace ipc
+{
+/**
+ * A collection of measurements (frame times, latencies, etc.) which can be
+ * summarized for a machine-readable benchmark report.
+ *
+ * All samples are kept until reset(), so that exact percentiles can be
+ * computed. To bound memory usage, samples beyond max_samples are only counted
+ * in the count, minimum, maximum and mean.
+ */
+class sample_stats_t
+{
+  public:
+    static constexpr size_t max_samples = 1 << 20;
+
+    void add(double value)
+    {
+        if (samples.size() < max_samples)
+        {
+            samples.push_back(value);
+            sorted = false;
+        }
+
+        ++count;
+        sum += value;
+        min  = (count == 1) ? value : std::min(min, value);
+        max  = (count == 1) ? value : std::max(max, value);
+    }
+
+    void reset()
+    {
+        samples.clear();
+        count = 0;
+        sum   = min = max = 0;
+    }
+
+    size_t get_count() const
+    {
+        return count;
+    }
+
+    double get_mean() const
+    {
+        return count ? sum / count : 0.0;
+    }
+
+    double get_min() const
+    {
+        return min;
+    }
+
+    double get_max() const
+    {
+        return max;
+    }
+
+    /**
+     * Get the given percentile (0 to 100) with the nearest-rank method, or 0 if
+     * there are no samples.
+     */
+    double get_percentile(double p)
+    {
+        if (samples.empty())
+        {
+            return 0.0;
+        }
+
+        if (!sorted)
+        {
+            std::sort(samples.begin(), samples.end());
+            sorted = true;
+        }
+
+        p = std::clamp(p, 0.0, 100.0);
+        size_t rank = std::ceil(p / 100.0 * samples.size());
+        return samples[std::clamp(rank, (size_t)1, samples.size()) - 1];
+    }
+
+    nlohmann::json to_json()
+    {
+        nlohmann::json j;
+        j["count"] = count;
+        j["min"]   = get_min();
+        j["max"]   = get_max();
+        j["mean"]  = get_mean();
+        j["p50"]   = get_percentile(50);
+        j["p95"]   = get_percentile(95);
+        j["p99"]   = get_percentile(99);
+        return j;
+    }
+
+  private:
+    std::vector<double> samples;
+    bool sorted  = true;
+    size_t count = 0;
+    double sum   = 0;
+    double min   = 0;
+    double max   = 0;
+};
+}
+}
@@ -6,7 +6,16 @@
 #include <wayfire/output.hpp>
 #include <wayfire/workspace-manager.hpp>
 #include <wayfire/output-layout.hpp>
+#include <wayfire/render-manager.hpp>
+#include <wayfire/img.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <getopt.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
 #include <wayland-server-core.h>
 #include <wayland-server-protocol.h>
 
@@ -15,6 +24,7 @@
 
 #include "ipc.hpp"
 #include "ipc-helpers.hpp"
+#include "sample-stats.hpp"
 #include <wayfire/touch/touch.hpp>
 
 extern "C" {
@@ -162,6 +172,38 @@ class headless_input_backend_t
         wlr_backend_destroy(backend);
     }
 
+    /**
+     * Attach @param count new keyboards, then detach them again.
+     *
+     * @return The time it took to attach each keyboard, in milliseconds.
+     */
+    std::vector<double> bench_keyboard_attach(int count)
+    {
+        std::vector<std::unique_ptr<wlr_keyboard>> keyboards;
+        std::vector<double> times;
+        for (int i = 0; i < count; i++)
+        {
+            auto kbd = std::make_unique<wlr_keyboard>();
+            wlr_keyboard_init(kbd.get(), &keyboard_impl, "stipc_bench_keyboard");
+
+            timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            wl_signal_emit_mutable(&backend->events.new_input, &kbd->base);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+
+            times.push_back((end.tv_sec - start.tv_sec) * 1000.0 +
+                (end.tv_nsec - start.tv_nsec) / 1'000'000.0);
+            keyboards.push_back(std::move(kbd));
+        }
+
+        for (auto& kbd : keyboards)
+        {
+            wlr_keyboard_finish(kbd.get());
+        }
+
+        return times;
+    }
+
     void do_key(uint32_t key, wl_keyboard_key_state state)
     {
         wlr_keyboard_key_event ev;
@@ -310,9 +352,401 @@ class headless_input_backend_t
     headless_input_backend_t& operator =(headless_input_backend_t&&) = delete;
 };
 
+static int64_t timespec_to_usec(const timespec& ts)
+{
+    return ts.tv_sec * 1'000'000ll + ts.tv_nsec / 1000;
+}
+
+static int64_t timeval_to_usec(const timeval& tv)
+{
+    return tv.tv_sec * 1'000'000ll + tv.tv_usec;
+}
+
+static int64_t get_monotonic_usec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return timespec_to_usec(ts);
+}
+
+/**
+ * Records frame timings on a single output while a benchmark is running.
+ *
+ * Commit-to-present latency is measured from each commit of the main surface
+ * of a view on the output to the presentation of the first frame which started
+ * after it.
+ */
+class frame_recorder_t
+{
+  public:
+    frame_recorder_t(wf::output_t *output) : output(output)
+    {
+        output->render->add_effect(&on_frame_start, OUTPUT_EFFECT_PRE);
+        output->render->add_effect(&on_frame_end, OUTPUT_EFFECT_POST);
+
+        on_present.set_callback([=] (void *data)
+        {
+            auto ev = static_cast<wlr_output_event_present*>(data);
+            if (ev->presented && (frame_start > 0))
+            {
+                const int64_t when = timespec_to_usec(*ev->when);
+                present_latency.add((when - frame_start) / 1000.0);
+                ++presented_frames;
+                for (auto commit : commits_in_frame)
+                {
+                    commit_latency.add((when - commit) / 1000.0);
+                }
+
+                commits_in_frame.clear();
+            }
+
+            frame_start = 0;
+        });
+        on_present.connect(&output->handle->events.present);
+    }
+
+    ~frame_recorder_t()
+    {
+        output->render->rem_effect(&on_frame_start);
+        output->render->rem_effect(&on_frame_end);
+    }
+
+    /** A view on the output committed its surface. */
+    void add_commit(int64_t time)
+    {
+        pending_commits.push_back(time);
+    }
+
+    nlohmann::json to_json()
+    {
+        nlohmann::json j;
+        j["output"] = output->to_string();
+        j["frames"] = frame_time.get_count();
+        j["presented-frames"] = presented_frames;
+        j["frame-time-ms"]    = frame_time.to_json();
+        j["frame-interval-ms"] = frame_interval.to_json();
+        j["paint-to-present-ms"] = present_latency.to_json();
+        j["commit-to-present-ms"] = commit_latency.to_json();
+        return j;
+    }
+
+    wf::output_t *get_output() const
+    {
+        return output;
+    }
+
+  private:
+    wf::output_t *output;
+    int64_t frame_start = 0;
+    int64_t last_frame_start = 0;
+    uint64_t presented_frames = 0;
+
+    ipc::sample_stats_t frame_time;
+    ipc::sample_stats_t frame_interval;
+    ipc::sample_stats_t present_latency;
+    ipc::sample_stats_t commit_latency;
+
+    /* Commits since the last frame started, and commits shown by the current frame */
+    std::vector<int64_t> pending_commits;
+    std::vector<int64_t> commits_in_frame;
+
+    wf::effect_hook_t on_frame_start = [=] ()
+    {
+        frame_start = get_monotonic_usec();
+        commits_in_frame.insert(commits_in_frame.end(),
+            pending_commits.begin(), pending_commits.end());
+        pending_commits.clear();
+        if (last_frame_start > 0)
+        {
+            frame_interval.add((frame_start - last_frame_start) / 1000.0);
+        }
+
+        last_frame_start = frame_start;
+    };
+
+    wf::effect_hook_t on_frame_end = [=] ()
+    {
+        if (frame_start > 0)
+        {
+            frame_time.add((get_monotonic_usec() - frame_start) / 1000.0);
+        }
+    };
+
+    wf::wl_listener_wrapper on_present;
+};
+
+/**
+ * A benchmark run started by stipc/bench/start. It records the frames on all
+ * outputs which exist when the benchmark starts, the commits of all views, and
+ * the CPU time used by the compositor process.
+ *
+ * Outputs which are removed during the run are reported with the data
+ * recorded until their removal.
+ */
+class benchmark_t
+{
+  public:
+    benchmark_t(std::string scenario) : scenario(scenario)
+    {
+        for (auto& wo : wf::get_core().output_layout->get_outputs())
+        {
+            recorders.push_back(std::make_unique<frame_recorder_t>(wo));
+        }
+
+        for (auto& view : wf::get_core().get_all_views())
+        {
+            if (view->is_mapped())
+            {
+                watch_commits(view);
+            }
+        }
+
+        wf::get_core().output_layout->connect(&on_output_removed);
+        wf::get_core().connect(&on_view_mapped);
+        wf::get_core().connect(&on_view_unmapped);
+
+        getrusage(RUSAGE_SELF, &start_usage);
+        start_time = get_monotonic_usec();
+    }
+
+    nlohmann::json report()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        const double wall_ms = (get_monotonic_usec() - start_time) / 1000.0;
+        const double user_ms = (timeval_to_usec(usage.ru_utime) -
+            timeval_to_usec(start_usage.ru_utime)) / 1000.0;
+        const double sys_ms = (timeval_to_usec(usage.ru_stime) -
+            timeval_to_usec(start_usage.ru_stime)) / 1000.0;
+
+        nlohmann::json j;
+        j["scenario"]    = scenario;
+        j["duration-ms"] = wall_ms;
+        j["cpu"]["user-ms"]   = user_ms;
+        j["cpu"]["system-ms"] = sys_ms;
+        j["cpu"]["percent"]   = wall_ms > 0 ? 100.0 * (user_ms + sys_ms) / wall_ms : 0.0;
+        j["outputs"] = nlohmann::json::array();
+        for (auto& recorder : recorders)
+        {
+            j["outputs"].push_back(recorder->to_json());
+        }
+
+        for (auto& removed : removed_outputs)
+        {
+            j["outputs"].push_back(removed);
+        }
+
+        return j;
+    }
+
+  private:
+    std::string scenario;
+    int64_t start_time;
+    rusage start_usage;
+    std::vector<std::unique_ptr<frame_recorder_t>> recorders;
+    std::vector<nlohmann::json> removed_outputs;
+    std::map<wayfire_view, std::unique_ptr<wf::wl_listener_wrapper>> commit_listeners;
+
+    void watch_commits(wayfire_view view)
+    {
+        auto surface = view->get_wlr_surface();
+        if (!surface || commit_listeners.count(view))
+        {
+            return;
+        }
+
+        auto& listener = commit_listeners[view];
+        listener = std::make_unique<wf::wl_listener_wrapper>();
+        listener->set_callback([=] (void*)
+        {
+            for (auto& recorder : recorders)
+            {
+                if (recorder->get_output() == view->get_output())
+                {
+                    recorder->add_commit(get_monotonic_usec());
+                }
+            }
+        });
+        listener->connect(&surface->events.commit);
+    }
+
+    wf::signal::connection_t<wf::view_mapped_signal> on_view_mapped = [=] (wf::view_mapped_signal *ev)
+    {
+        watch_commits(ev->view);
+    };
+
+    wf::signal::connection_t<wf::view_unmapped_signal> on_view_unmapped =
+        [=] (wf::view_unmapped_signal *ev)
+    {
+        commit_listeners.erase(ev->view);
+    };
+
+    wf::signal::connection_t<wf::output_pre_remove_signal> on_output_removed =
+        [=] (wf::output_pre_remove_signal *ev)
+    {
+        auto it = std::find_if(recorders.begin(), recorders.end(), [&] (auto& recorder)
+        {
+            return recorder->get_output() == ev->output;
+        });
+
+        if (it != recorders.end())
+        {
+            removed_outputs.push_back((*it)->to_json());
+            recorders.erase(it);
+        }
+    };
+};
+
+/**
+ * Moves the cursor in a circle with the given rate of motion events, like a
+ * high polling rate mouse, and measures the CPU time used to process them.
+ * Each motion event is followed by a pointer frame, like events from libinput.
+ */
+class pointer_motion_benchmark_t
+{
+  public:
+    pointer_motion_benchmark_t(headless_input_backend_t *input, double rate,
+        int duration_ms, wf::pointf_t center, double radius) :
+        input(input), rate(rate), center(center), radius(radius)
+    {
+        total_events = std::max(1, (int)(rate * duration_ms / 1000.0));
+        start_stats  = wf::get_core().get_pointer_motion_stats();
+        getrusage(RUSAGE_SELF, &start_usage);
+        start_time = get_monotonic_usec();
+
+        feed_timer.set_timeout(1, [=] ()
+        {
+            feed_events();
+            return fed_events < total_events;
+        });
+    }
+
+    bool is_running() const
+    {
+        return fed_events < total_events;
+    }
+
+    nlohmann::json report()
+    {
+        rusage usage = end_usage;
+        auto stats   = end_stats;
+        int64_t end  = end_time;
+        if (is_running())
+        {
+            getrusage(RUSAGE_SELF, &usage);
+            stats = wf::get_core().get_pointer_motion_stats();
+            end   = get_monotonic_usec();
+        }
+
+        const double wall_ms = (end - start_time) / 1000.0;
+        const double cpu_ms  = (timeval_to_usec(usage.ru_utime) - timeval_to_usec(start_usage.ru_utime) +
+            timeval_to_usec(usage.ru_stime) - timeval_to_usec(start_usage.ru_stime)) / 1000.0;
+
+        nlohmann::json j;
+        j["running"]     = is_running();
+        j["rate"]        = rate;
+        j["events"]      = fed_events;
+        j["duration-ms"] = wall_ms;
+        j["cpu-ms"] = cpu_ms;
+        j["cpu-ms-per-second"] = wall_ms > 0 ? 1000.0 * cpu_ms / wall_ms : 0.0;
+        j["motion-events"] = stats.motion_events - start_stats.motion_events;
+        j["hit-tests"] = stats.hit_tests - start_stats.hit_tests;
+        j["flushes"]   = stats.flushes - start_stats.flushes;
+        return j;
+    }
+
+  private:
+    headless_input_backend_t *input;
+    double rate;
+    wf::pointf_t center;
+    double radius;
+
+    int total_events;
+    int fed_events = 0;
+    int64_t start_time;
+    int64_t end_time = 0;
+    rusage start_usage;
+    rusage end_usage;
+    wf::pointer_motion_stats_t start_stats;
+    wf::pointer_motion_stats_t end_stats;
+    wf::wl_timer feed_timer;
+
+    void feed_events()
+    {
+        /* Catch up with the events which should have arrived until now, the
+         * timer may fire late if the compositor is busy */
+        const int64_t elapsed = get_monotonic_usec() - start_time;
+        const int target = std::min(total_events, (int)(elapsed * rate / 1'000'000.0));
+        for (; fed_events < target; ++fed_events)
+        {
+            const double angle = 2 * M_PI * fed_events / rate;
+            input->do_motion(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle));
+        }
+
+        if (!is_running())
+        {
+            getrusage(RUSAGE_SELF, &end_usage);
+            end_stats = wf::get_core().get_pointer_motion_stats();
+            end_time  = get_monotonic_usec();
+        }
+    }
+};
+
+/**
+ * Captures the next frame of an output to a file, either with the synchronous
+ * image_io::write_to_file() or with image_io::write_to_file_async().
+ */
+class screenshot_t
+{
+  public:
+    using callback_t = std::function<void (screenshot_t*, const image_io::capture_result_t&)>;
+
+    screenshot_t(wf::output_t *output, std::string file, bool async, callback_t on_done) :
+        output(output), file(file), async(async), on_done(on_done)
+    {
+        output->render->add_effect(&on_frame, OUTPUT_EFFECT_OVERLAY);
+        output->render->damage_whole();
+    }
+
+    ~screenshot_t()
+    {
+        output->render->rem_effect(&on_frame);
+    }
+
+    wf::output_t*const output;
+    const std::string file;
+    const bool async;
+
+  private:
+    callback_t on_done;
+
+    wf::effect_hook_t on_frame = [=] ()
+    {
+        output->render->rem_effect(&on_frame);
+        auto fb = output->render->get_target_framebuffer();
+        if (async)
+        {
+            image_io::write_to_file_async(file, fb,
+                [=] (const image_io::capture_result_t& result)
+            {
+                on_done(this, result);
+            });
+        } else
+        {
+            image_io::capture_result_t result;
+            int64_t start = get_monotonic_usec();
+            image_io::write_to_file(file, fb);
+            result.success = (access(file.c_str(), F_OK) == 0);
+            result.main_thread_us = result.total_us = get_monotonic_usec() - start;
+            on_done(this, result);
+        }
+    };
+};
+
 class stipc_plugin_t : public wf::plugin_interface_t
 {
     wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
+    wf::shared_data::ref_ptr_t<wf::ipc::server_t> ipc_server;
 
   public:
     void init() override
@@ -335,6 +769,19 @@ class stipc_plugin_t : public wf::plugin_interface_t
         method_repository->register_method("stipc/tablet/tool_axis", do_tool_axis);
         method_repository->register_method("stipc/tablet/tool_tip", do_tool_tip);
         method_repository->register_method("stipc/tablet/pad_button", do_pad_button);
+        method_repository->register_method("stipc/bench/start", bench_start);
+        method_repository->register_method("stipc/bench/stop", bench_stop);
+        method_repository->register_method("stipc/bench/drag", bench_drag);
+        method_repository->register_method("stipc/bench/scenario", bench_scenario);
+        method_repository->register_method("stipc/bench/damage", bench_damage);
+        method_repository->register_method("stipc/screenshot", screenshot);
+        method_repository->register_method("stipc/screenshot/stats", screenshot_stats);
+        method_repository->register_method("stipc/layer_shell/stats", layer_shell_stats);
+        method_repository->register_method("stipc/bench/keyboard_attach", bench_keyboard_attach);
+        method_repository->register_method("stipc/bench/pointer_motion", bench_pointer_motion);
+        method_repository->register_method("stipc/bench/pointer_motion/report",
+            bench_pointer_motion_report);
+        wf::get_core().connect(&on_layer_shell_arranged);
     }
 
     bool is_unloadable() override
@@ -376,7 +823,6 @@ class stipc_plugin_t : public wf::plugin_interface_t
 
     ipc::method_callback layout_views = [] (nlohmann::json data)
     {
-        auto views = wf::get_core().get_all_views();
         WFJSON_EXPECT_FIELD(data, "views", array);
         for (auto v : data["views"])
         {
@@ -386,12 +832,8 @@ class stipc_plugin_t : public wf::plugin_interface_t
             WFJSON_EXPECT_FIELD(v, "width", number);
             WFJSON_EXPECT_FIELD(v, "height", number);
 
-            auto it = std::find_if(views.begin(), views.end(), [&] (auto& view)
-            {
-                return view->get_id() == v["id"];
-            });
-
-            if (it == views.end())
+            auto view = wf::ipc::find_view_by_id(v["id"]);
+            if (!view)
             {
                 return wf::ipc::json_error("Could not find view with id " +
                     std::to_string((int)v["id"]));
@@ -406,11 +848,11 @@ class stipc_plugin_t : public wf::plugin_interface_t
                     return wf::ipc::json_error("Unknown output " + (std::string)v["output"]);
                 }
 
-                wf::get_core().move_view_to_output(*it, wo, false);
+                wf::get_core().move_view_to_output(view, wo, false);
             }
 
             wf::geometry_t g{v["x"], v["y"], v["width"], v["height"]};
-            (*it)->set_geometry(g);
+            view->set_geometry(g);
         }
 
         return wf::ipc::json_ok();
@@ -582,8 +1024,26 @@ class stipc_plugin_t : public wf::plugin_interface_t
             return wf::ipc::json_error("run command needs a cmd to run");
         }
 
+        if (data.count("count"))
+        {
+            WFJSON_EXPECT_FIELD(data, "count", number_unsigned);
+        }
+
         auto response = wf::ipc::json_ok();
+        auto start = get_monotonic_usec();
         response["pid"] = wf::get_core().run(data["cmd"]);
+        response["spawn-time-us"] = get_monotonic_usec() - start;
+
+        // Further instances, for example to load a benchmark with N clients
+        if (data.count("count"))
+        {
+            response["pids"] = nlohmann::json::array({response["pid"]});
+            for (int i = 1; i < data["count"].get<int>(); i++)
+            {
+                response["pids"].push_back(wf::get_core().run(data["cmd"]));
+            }
+        }
+
         return response;
     };
 
@@ -643,6 +1103,508 @@ class stipc_plugin_t : public wf::plugin_interface_t
         return wf::ipc::json_ok();
     };
 
+    std::unique_ptr<benchmark_t> benchmark;
+
+    /**
+     * Start recording frame times, paint-to-present latency and CPU usage.
+     * A running benchmark is discarded.
+     */
+    ipc::method_callback bench_start = [=] (nlohmann::json data)
+    {
+        std::string scenario = "unnamed";
+        if (data.is_object() && data.count("scenario") && data["scenario"].is_string())
+        {
+            scenario = data["scenario"];
+        }
+
+        benchmark = std::make_unique<benchmark_t>(scenario);
+        return wf::ipc::json_ok();
+    };
+
+    /** Stop the running benchmark and return its report. */
+    ipc::method_callback bench_stop = [=] (nlohmann::json)
+    {
+        if (!benchmark)
+        {
+            return wf::ipc::json_error("no benchmark is running");
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["report"] = benchmark->report();
+        benchmark.reset();
+        return response;
+    };
+
+    /**
+     * Drag with the given button (`combo`, as for feed_button, default
+     * BTN_LEFT) from one point to another. The motion is
+     * split into steps, and each step is fed after the given delay, so that
+     * the compositor renders frames in between like with a real drag.
+     */
+    ipc::method_callback bench_drag = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "from", object);
+        WFJSON_EXPECT_FIELD(data["from"], "x", number);
+        WFJSON_EXPECT_FIELD(data["from"], "y", number);
+        WFJSON_EXPECT_FIELD(data, "to", object);
+        WFJSON_EXPECT_FIELD(data["to"], "x", number);
+        WFJSON_EXPECT_FIELD(data["to"], "y", number);
+        WFJSON_EXPECT_FIELD(data, "steps", number_unsigned);
+        WFJSON_EXPECT_FIELD(data, "delay", number_unsigned);
+
+        if (drag_timer.is_connected())
+        {
+            return wf::ipc::json_error("a drag is already in progress");
+        }
+
+        key_t button = {false, BTN_LEFT};
+        if (data.count("combo"))
+        {
+            auto result = parse_key(data);
+            if (!std::get_if<key_t>(&result))
+            {
+                return wf::ipc::json_error(std::get<std::string>(result));
+            }
+
+            button = std::get<key_t>(result);
+        }
+
+        drag.from = {data["from"]["x"].get<double>(), data["from"]["y"].get<double>()};
+        drag.to   = {data["to"]["x"].get<double>(), data["to"]["y"].get<double>()};
+        drag.steps  = std::max(1, data["steps"].get<int>());
+        drag.step   = 0;
+        drag.button = button;
+
+        input->do_motion(drag.from.x, drag.from.y);
+        if (button.modifier)
+        {
+            input->do_key(KEY_LEFTMETA, WL_KEYBOARD_KEY_STATE_PRESSED);
+        }
+
+        input->do_button(button.code, WLR_BUTTON_PRESSED);
+        drag_timer.set_timeout(std::max(1, data["delay"].get<int>()), [=] ()
+        {
+            ++drag.step;
+            double progress = 1.0 * drag.step / drag.steps;
+            input->do_motion(drag.from.x + (drag.to.x - drag.from.x) * progress,
+                drag.from.y + (drag.to.y - drag.from.y) * progress);
+            if (drag.step < drag.steps)
+            {
+                return true;
+            }
+
+            input->do_button(drag.button.code, WLR_BUTTON_RELEASED);
+            if (drag.button.modifier)
+            {
+                input->do_key(KEY_LEFTMETA, WL_KEYBOARD_KEY_STATE_RELEASED);
+            }
+
+            return false;
+        });
+
+        return wf::ipc::json_ok();
+    };
+
+    struct key_step_t
+    {
+        int code;
+        bool pressed;
+    };
+
+    /** Press and release a key. */
+    static void add_tap(std::vector<key_step_t>& steps, int code)
+    {
+        steps.push_back({code, true});
+        steps.push_back({code, false});
+    }
+
+    /**
+     * The key presses of the built-in scenarios, for the default bindings of
+     * the plugins they exercise.
+     */
+    static std::vector<key_step_t> scenario_steps(const std::string& name)
+    {
+        std::vector<key_step_t> steps;
+        if (name == "alt-tab")
+        {
+            // switcher: <alt> KEY_TAB
+            steps.push_back({KEY_LEFTALT, true});
+            for (int i = 0; i < 3; i++)
+            {
+                add_tap(steps, KEY_TAB);
+            }
+
+            steps.push_back({KEY_LEFTALT, false});
+        } else if (name == "expo")
+        {
+            // expo: <super>, to open and close it again
+            add_tap(steps, KEY_LEFTMETA);
+            add_tap(steps, KEY_LEFTMETA);
+        } else if (name == "workspace-switch")
+        {
+            // vswitch: <super> <alt> KEY_RIGHT and back
+            steps.push_back({KEY_LEFTMETA, true});
+            steps.push_back({KEY_LEFTALT, true});
+            add_tap(steps, KEY_RIGHT);
+            add_tap(steps, KEY_LEFT);
+            steps.push_back({KEY_LEFTALT, false});
+            steps.push_back({KEY_LEFTMETA, false});
+        }
+
+        return steps;
+    }
+
+    /**
+     * Run a scripted keyboard scenario: one key event is fed every `delay`
+     * milliseconds, and the whole script is repeated `repeat` times (default
+     * 1). The script is either a built-in `scenario` (alt-tab, expo or
+     * workspace-switch, using the default bindings) or a list of `keys`, each
+     * with `key` (an evdev key name) and `state` (pressed or not).
+     *
+     * Combined with stipc/bench/start and stop, this measures the frames
+     * rendered during the animations of the scenario.
+     */
+    ipc::method_callback bench_scenario = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "delay", number_unsigned);
+        if (key_script.timer.is_connected() || drag_timer.is_connected())
+        {
+            return wf::ipc::json_error("a scenario or drag is already in progress");
+        }
+
+        std::vector<key_step_t> steps;
+        if (data.count("keys"))
+        {
+            WFJSON_EXPECT_FIELD(data, "keys", array);
+            for (auto& k : data["keys"])
+            {
+                WFJSON_EXPECT_FIELD(k, "key", string);
+                WFJSON_EXPECT_FIELD(k, "state", boolean);
+                int code = libevdev_event_code_from_name(EV_KEY, k["key"].get<std::string>().c_str());
+                if (code == -1)
+                {
+                    return wf::ipc::json_error("Failed to parse evdev key " + k["key"].dump());
+                }
+
+                steps.push_back({code, k["state"].get<bool>()});
+            }
+        } else
+        {
+            WFJSON_EXPECT_FIELD(data, "scenario", string);
+            steps = scenario_steps(data["scenario"]);
+        }
+
+        if (steps.empty())
+        {
+            return wf::ipc::json_error("unknown scenario or no keys");
+        }
+
+        int repeat = 1;
+        if (data.count("repeat"))
+        {
+            WFJSON_EXPECT_FIELD(data, "repeat", number_unsigned);
+            repeat = std::max(1, data["repeat"].get<int>());
+        }
+
+        key_script.steps = steps;
+        key_script.total = steps.size() * repeat;
+        key_script.next  = 0;
+        key_script.timer.set_timeout(std::max(1, data["delay"].get<int>()), [=] ()
+        {
+            auto& step = key_script.steps[key_script.next % key_script.steps.size()];
+            input->do_key(step.code, step.pressed ?
+                WL_KEYBOARD_KEY_STATE_PRESSED : WL_KEYBOARD_KEY_STATE_RELEASED);
+            return ++key_script.next < key_script.total;
+        });
+
+        auto response = wf::ipc::json_ok();
+        response["steps"] = key_script.total;
+        return response;
+    };
+
+    /**
+     * Damage a view the given number of times (default 1000) and report the
+     * average cost of a single damage. Comparing the results with different
+     * workspace grid sizes shows how damage scales with the grid, which
+     * matters mostly for sticky views.
+     */
+    ipc::method_callback bench_damage = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "id", number_unsigned);
+        auto view = wf::ipc::find_view_by_id(data["id"]);
+        if (!view || !view->get_output())
+        {
+            return wf::ipc::json_error("no such view");
+        }
+
+        int iterations = 1000;
+        if (data.count("iterations"))
+        {
+            WFJSON_EXPECT_FIELD(data, "iterations", number_integer);
+            iterations = data["iterations"].get<int>();
+            if (iterations <= 0)
+            {
+                return wf::ipc::json_error("iterations must be positive");
+            }
+        }
+
+        int64_t start  = get_monotonic_usec();
+        for (int i = 0; i < iterations; i++)
+        {
+            view->damage();
+        }
+
+        const double total_us = get_monotonic_usec() - start;
+        auto grid = view->get_output()->workspace->get_workspace_grid_size();
+
+        auto response = wf::ipc::json_ok();
+        response["sticky"]     = view->sticky;
+        response["workspaces"] = grid.width * grid.height;
+        response["iterations"] = iterations;
+        response["ns-per-damage"] = 1000.0 * total_us / iterations;
+        return response;
+    };
+
+    struct
+    {
+        wf::pointf_t from, to;
+        int steps = 1;
+        int step  = 0;
+        key_t button;
+    } drag;
+    wf::wl_timer drag_timer;
+
+    struct
+    {
+        std::vector<key_step_t> steps;
+        size_t next  = 0;
+        size_t total = 0;
+        wf::wl_timer timer;
+    } key_script;
+
+    std::vector<std::unique_ptr<screenshot_t>> screenshots;
+    std::vector<screenshot_t*> finished_screenshots;
+    wf::wl_idle_call idle_cleanup_screenshots;
+
+    /* Main-thread stall per capture, in milliseconds */
+    ipc::sample_stats_t screenshot_stall[2];
+    /* Time until the file was written, in milliseconds */
+    ipc::sample_stats_t screenshot_latency[2];
+
+    void screenshot_done(screenshot_t *shot, const image_io::capture_result_t& result)
+    {
+        screenshot_stall[shot->async].add(result.main_thread_us / 1000.0);
+        screenshot_latency[shot->async].add(result.total_us / 1000.0);
+
+        nlohmann::json event;
+        event["output-id"] = shot->output->get_id();
+        event["file"]    = shot->file;
+        event["async"]   = shot->async;
+        event["success"] = result.success;
+        event["main-thread-us"] = result.main_thread_us;
+        event["total-us"] = result.total_us;
+        ipc_server->publish_event("stipc/screenshot", event);
+
+        // The callback may run from the screenshot's own effect hook.
+        finished_screenshots.push_back(shot);
+        idle_cleanup_screenshots.run_once([=] ()
+        {
+            for (auto finished : finished_screenshots)
+            {
+                screenshots.erase(std::remove_if(screenshots.begin(), screenshots.end(),
+                    [=] (auto& s) { return s.get() == finished; }), screenshots.end());
+            }
+
+            finished_screenshots.clear();
+        });
+    }
+
+    /**
+     * Save the next frame of an output to a file. By default, the capture is
+     * asynchronous, `async: false` uses the old synchronous readback.
+     *
+     * The reply is sent immediately. Completion is reported with the
+     * stipc/screenshot event, which contains the time the main thread was
+     * blocked by the capture.
+     */
+    ipc::method_callback screenshot = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "output-id", number_integer);
+        WFJSON_EXPECT_FIELD(data, "file", string);
+
+        auto wo = wf::ipc::find_output_by_id(data["output-id"].get<int>());
+        if (!wo)
+        {
+            return wf::ipc::json_error("output not found");
+        }
+
+        bool async = true;
+        if (data.count("async") && data["async"].is_boolean())
+        {
+            async = data["async"];
+        }
+
+        screenshots.push_back(std::make_unique<screenshot_t>(wo, data["file"], async,
+            [=] (screenshot_t *shot, const image_io::capture_result_t& result)
+        {
+            screenshot_done(shot, result);
+        }));
+
+        return wf::ipc::json_ok();
+    };
+
+    /** Compare the main-thread stall of synchronous and asynchronous captures. */
+    ipc::method_callback screenshot_stats = [=] (nlohmann::json data)
+    {
+        auto response = wf::ipc::json_ok();
+        static const char *names[] = {"sync", "async"};
+        for (int i = 0; i < 2; i++)
+        {
+            response["stats"][names[i]]["main-thread-ms"] = screenshot_stall[i].to_json();
+            response["stats"][names[i]]["total-ms"] = screenshot_latency[i].to_json();
+        }
+
+        if (data.is_object() && data.count("reset"))
+        {
+            WFJSON_EXPECT_FIELD(data, "reset", boolean);
+            if (data["reset"].get<bool>())
+            {
+                for (int i = 0; i < 2; i++)
+                {
+                    screenshot_stall[i].reset();
+                    screenshot_latency[i].reset();
+                }
+            }
+        }
+
+        return response;
+    };
+
+    /**
+     * Measure how long it takes to attach a keyboard. All keyboards use the
+     * same configuration, so after the first one their keymap is cached.
+     */
+    ipc::method_callback bench_keyboard_attach = [=] (nlohmann::json data)
+    {
+        int count = 10;
+        if (data.is_object() && data.count("count") && data["count"].is_number_integer())
+        {
+            count = std::clamp(data["count"].get<int>(), 1, 1000);
+        }
+
+        auto times = input->bench_keyboard_attach(count);
+        ipc::sample_stats_t stats;
+        for (auto t : times)
+        {
+            stats.add(t);
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["report"]["attach-ms"] = stats.to_json();
+        return response;
+    };
+
+    struct
+    {
+        int changes = 0;
+        int arrangements = 0;
+        int full_arrangements = 0;
+        int configured = 0;
+        int workarea_changes = 0;
+    } layer_shell_counters;
+
+    wf::signal::connection_t<wf::layer_shell_arranged_signal> on_layer_shell_arranged =
+        [=] (wf::layer_shell_arranged_signal *ev)
+    {
+        auto& c = layer_shell_counters;
+        c.changes += ev->changes;
+        c.arrangements++;
+        c.full_arrangements += ev->full;
+        c.configured += ev->configured;
+        c.workarea_changes += (ev->old_workarea != ev->new_workarea);
+    };
+
+    /**
+     * Count how often layer-shell surfaces were arranged, compared to the
+     * number of commits, maps and unmaps which required an arrangement.
+     */
+    ipc::method_callback layer_shell_stats = [=] (nlohmann::json data)
+    {
+        auto& c = layer_shell_counters;
+        auto response = wf::ipc::json_ok();
+        response["stats"]["changes"] = c.changes;
+        response["stats"]["arrangements"] = c.arrangements;
+        response["stats"]["full-arrangements"] = c.full_arrangements;
+        response["stats"]["configured"] = c.configured;
+        response["stats"]["workarea-changes"] = c.workarea_changes;
+
+        if (data.is_object() && data.count("reset"))
+        {
+            WFJSON_EXPECT_FIELD(data, "reset", boolean);
+            if (data["reset"].get<bool>())
+            {
+                c = {};
+            }
+        }
+
+        return response;
+    };
+
+    std::unique_ptr<pointer_motion_benchmark_t> motion_benchmark;
+
+    /**
+     * Start moving the cursor in a circle (`center`, `radius`) with `rate`
+     * motion events per second (default 1000) for `duration` milliseconds
+     * (default 1000). The result is available from
+     * stipc/bench/pointer_motion/report. Comparing runs with and without
+     * input/coalesce_pointer_motion shows the effect of coalescing.
+     */
+    ipc::method_callback bench_pointer_motion = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "center", object);
+        WFJSON_EXPECT_FIELD(data["center"], "x", number);
+        WFJSON_EXPECT_FIELD(data["center"], "y", number);
+        WFJSON_EXPECT_FIELD(data, "duration", number_unsigned);
+        if (motion_benchmark && motion_benchmark->is_running())
+        {
+            return wf::ipc::json_error("a pointer motion benchmark is already running");
+        }
+
+        double rate = 1000.0;
+        if (data.count("rate"))
+        {
+            WFJSON_EXPECT_FIELD(data, "rate", number);
+            rate = std::clamp(data["rate"].get<double>(), 1.0, 100000.0);
+        }
+
+        double radius = 100.0;
+        if (data.count("radius"))
+        {
+            WFJSON_EXPECT_FIELD(data, "radius", number);
+            radius = data["radius"].get<double>();
+        }
+
+        int duration_ms = std::clamp<int64_t>(data["duration"].get<int64_t>(), 1, 600'000);
+        wf::pointf_t center = {data["center"]["x"].get<double>(), data["center"]["y"].get<double>()};
+
+        motion_benchmark = std::make_unique<pointer_motion_benchmark_t>(input.get(),
+            rate, duration_ms, center, radius);
+        return wf::ipc::json_ok();
+    };
+
+    ipc::method_callback bench_pointer_motion_report = [=] (nlohmann::json)
+    {
+        if (!motion_benchmark)
+        {
+            return wf::ipc::json_error("no pointer motion benchmark was started");
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["report"] = motion_benchmark->report();
+        return response;
+    };
+
+
     std::unique_ptr<headless_input_backend_t> input;
 };
 }
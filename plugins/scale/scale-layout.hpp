@@ -0,0 +1,130 @@
+#pragma once
+
+#include <wayfire/geometry.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace wf
+{
+namespace scale
+{
+/**
+ * The slot of a view in the scale grid.
+ */
+struct slot_t
+{
+    int row = 0;
+    int col = 0;
+    /* The box of the slot, in output-local coordinates */
+    double x = 0;
+    double y = 0;
+    double width  = 0;
+    double height = 0;
+
+    bool operator ==(const slot_t& other) const
+    {
+        return row == other.row && col == other.col && x == other.x &&
+               y == other.y && width == other.width && height == other.height;
+    }
+
+    bool operator !=(const slot_t& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * A view to be arranged, identified by @key, with its wm geometry.
+ */
+template<class Key>
+struct layout_item_t
+{
+    Key key;
+    wf::geometry_t geometry;
+};
+
+template<class Key>
+struct layout_t
+{
+    std::map<Key, slot_t> slots;
+    /* The number of views in each row */
+    std::vector<int> row_sizes;
+};
+
+/**
+ * Arrange the items in a grid on the workarea. Initial code borrowed from the
+ * compiz scale plugin algorithm: the items are split in sqrt(n + 1) rows,
+ * sorted by their vertical position, and each row is sorted by the horizontal
+ * position of its items.
+ */
+template<class Key>
+layout_t<Key> compute_layout(std::vector<layout_item_t<Key>> items,
+    wf::geometry_t workarea, int spacing)
+{
+    layout_t<Key> layout;
+    if (items.empty())
+    {
+        return layout;
+    }
+
+    // First ensure a consistent sorting of all views using a persistent
+    // identifier before sorting by geometry.
+    // This is so that if two views have exactly the same geometry,
+    // they will always appear in the same order in the output list.
+    std::sort(items.begin(), items.end(), [] (const auto& a, const auto& b)
+    {
+        return a.key < b.key;
+    });
+    std::stable_sort(items.begin(), items.end(), [] (const auto& a, const auto& b)
+    {
+        auto& ga = a.geometry;
+        auto& gb = b.geometry;
+        return std::tie(ga.y, ga.height, ga.x, ga.width) <
+               std::tie(gb.y, gb.height, gb.x, gb.width);
+    });
+
+    const size_t n = items.size();
+    const int rows = std::sqrt(n + 1);
+    const size_t views_per_row = (size_t)std::ceil((double)n / rows);
+    const size_t cnt_rows = (n + views_per_row - 1) / views_per_row;
+
+    const double scaled_height = std::max((double)
+        (workarea.height - (cnt_rows + 1) * spacing) / cnt_rows, 1.0);
+
+    for (size_t i = 0; i < cnt_rows; i++)
+    {
+        auto begin = items.begin() + i * views_per_row;
+        auto end   = items.begin() + std::min((i + 1) * views_per_row, n);
+        std::stable_sort(begin, end, [] (const auto& a, const auto& b)
+        {
+            auto& ga = a.geometry;
+            auto& gb = b.geometry;
+            return std::tie(ga.x, ga.width, ga.y, ga.height) <
+                   std::tie(gb.x, gb.width, gb.y, gb.height);
+        });
+
+        const size_t cnt_cols = end - begin;
+        layout.row_sizes.push_back(cnt_cols);
+        const double scaled_width = std::max((double)
+            (workarea.width - (cnt_cols + 1) * spacing) / cnt_cols, 1.0);
+
+        for (size_t j = 0; j < cnt_cols; j++)
+        {
+            slot_t slot;
+            slot.row    = i;
+            slot.col    = j;
+            slot.x      = workarea.x + spacing + (spacing + scaled_width) * j;
+            slot.y      = workarea.y + spacing + (spacing + scaled_height) * i;
+            slot.width  = scaled_width;
+            slot.height = scaled_height;
+            layout.slots[(begin + j)->key] = slot;
+        }
+    }
+
+    return layout;
+}
+}
+}
@@ -31,8 +31,64 @@ static wayfire_view find_toplevel_parent(wayfire_view view)
     return view;
 }
 
+scale_title_rasterizer_t::~scale_title_rasterizer_t()
+{
+    if (!thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    cond.notify_one();
+    thread.join();
+}
+
+void scale_title_rasterizer_t::submit(std::shared_ptr<scale_title_job_t> job)
+{
+    // Started with the first title, so that it never runs if titles are disabled
+    if (!thread.joinable())
+    {
+        thread = std::thread([=] () { run(); });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+
+    cond.notify_one();
+}
+
+void scale_title_rasterizer_t::run()
+{
+    while (true)
+    {
+        std::shared_ptr<scale_title_job_t> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [=] { return stopping || !queue.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        job->size = job->result.rasterize_text(job->text, job->par);
+        job->done.store(true, std::memory_order_release);
+    }
+}
+
 /**
  * Class storing an overlay with a view's title, only stored for parent views.
+ *
+ * The overlay is freed when scale ends on the view's output.
  */
 struct view_title_texture_t : public wf::custom_data_t
 {
@@ -42,6 +98,12 @@ struct view_title_texture_t : public wf::custom_data_t
     bool overflow = false;
     wayfire_view dialog; /* the texture should be rendered on top of this dialog */
 
+    scale_title_rasterizer_t *rasterizer;
+    /* The title which is being rendered, if any */
+    std::shared_ptr<scale_title_job_t> pending;
+    /* The title or the parameters changed since the texture was rendered */
+    bool needs_update = false;
+
     /**
      * Render the overlay text in our texture, cropping it to the size by
      * the given box.
@@ -52,23 +114,61 @@ struct view_title_texture_t : public wf::custom_data_t
         update_overlay_texture();
     }
 
+    /**
+     * Start rendering the overlay text in the background. If a title is
+     * already being rendered, the new one is started after it is collected.
+     */
     void update_overlay_texture()
     {
-        auto res = overlay.render_text(view->get_title(), par);
-        overflow = res.width > overlay.tex.width;
+        if (pending)
+        {
+            needs_update |= (pending->text != view->get_title()) ||
+                (pending->par.max_size != par.max_size) ||
+                (pending->par.output_scale != par.output_scale);
+            return;
+        }
+
+        needs_update = false;
+        pending = std::make_shared<scale_title_job_t>();
+        pending->text = view->get_title();
+        pending->par  = par;
+        rasterizer->submit(pending);
     }
 
-    wf::signal::connection_t<wf::view_title_changed_signal> view_changed_title =
-        [=] (wf::view_title_changed_signal *ev)
+    /**
+     * Upload the rendered title, if it is ready.
+     *
+     * @return Whether the texture changed.
+     */
+    bool collect_overlay_texture()
     {
-        if (overlay.tex.tex != (GLuint) - 1)
+        if (!pending || !pending->done.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        pending->result.upload_texture(overlay.tex);
+        overflow = pending->size.width > overlay.tex.width;
+        pending.reset();
+
+        if (needs_update)
         {
             update_overlay_texture();
         }
+
+        return true;
+    }
+
+    wf::signal::connection_t<wf::view_title_changed_signal> view_changed_title =
+        [=] (wf::view_title_changed_signal *ev)
+    {
+        // Rendered again the next time the overlay is shown
+        needs_update = true;
     };
 
     view_title_texture_t(wayfire_view v, int font_size, const wf::color_t& bg_color,
-        const wf::color_t& text_color, float output_scale) : view(v)
+        const wf::color_t& text_color, float output_scale,
+        scale_title_rasterizer_t *rasterizer) : view(v), rasterizer(rasterizer)
     {
         par.font_size    = font_size;
         par.bg_color     = bg_color;
@@ -115,7 +215,8 @@ class title_overlay_node_t : public node_t
         if (!data)
         {
             auto new_data = new view_title_texture_t(view, parent.title_font_size,
-                parent.bg_color, parent.text_color, parent.output->handle->scale);
+                parent.bg_color, parent.text_color, parent.output->handle->scale,
+                parent.rasterizer.get());
             view->store_data<view_title_texture_t>(std::unique_ptr<view_title_texture_t>(
                 new_data));
             return *new_data;
@@ -194,30 +295,48 @@ class title_overlay_node_t : public node_t
             return;
         }
 
-        overlay_shown = true;
         auto box = find_maximal_title_size();
         auto output_scale = parent.output->handle->scale;
 
+        auto& tex = get_overlay_texture(find_toplevel_parent(view));
+        if (tex.collect_overlay_texture())
+        {
+            this->do_push_damage(get_bounding_box());
+        }
+
         /**
          * regenerate the overlay texture in the following cases:
-         * 1. Output's scale changed
-         * 2. The overlay does not fit anymore
-         * 3. The overlay previously did not fit, but there is more space now
-         * TODO: check if this wastes too high CPU power when views are being
-         * animated and maybe redraw less frequently
+         * 1. The title changed, or the texture was never rendered
+         * 2. Output's scale changed
+         * 3. The overlay does not fit anymore
+         * 4. The overlay previously did not fit, but there is more space now
+         * While the views are animated, the rasterizer renders the newest
+         * size once it is done with the previous one.
          */
-        auto& tex = get_overlay_texture(find_toplevel_parent(view));
-        if ((tex.overlay.tex.tex == (GLuint) - 1) ||
+        if (tex.needs_update || (tex.overlay.tex.tex == (GLuint) - 1) ||
             (output_scale != tex.par.output_scale) ||
             (tex.overlay.tex.width > box.width * output_scale) ||
             (tex.overflow &&
              (tex.overlay.tex.width < std::floor(box.width * output_scale))))
         {
-            this->do_push_damage(get_bounding_box());
             tex.par.output_scale = output_scale;
             tex.update_overlay_texture({box.width, box.height});
         }
 
+        if (tex.pending)
+        {
+            // Check for the result again on the next frame
+            parent.output->render->schedule_redraw();
+        }
+
+        if (tex.overlay.tex.tex == (GLuint) - 1)
+        {
+            overlay_shown = false;
+            return;
+        }
+
+        overlay_shown = true;
+
         geometry.width  = tex.overlay.tex.width / output_scale;
         geometry.height = tex.overlay.tex.height / output_scale;
 
@@ -268,7 +387,6 @@ class title_overlay_node_t : public node_t
     ~title_overlay_node_t()
     {
         output->render->rem_effect(&pre_render);
-        view->erase_data<view_title_texture_t>();
     }
 
     void gen_render_instances(
@@ -381,6 +499,9 @@ scale_show_title_t::scale_show_title_t() :
 
         post_absolute_motion.disconnect();
         post_motion.disconnect();
+
+        // The overlays are not shown anymore, even while scale animates out
+        erase_title_textures(output);
     }
 },
 
@@ -462,6 +583,20 @@ void scale_show_title_t::fini()
 {
     post_motion.disconnect();
     post_absolute_motion.disconnect();
+
+    /* The overlays refer to the rasterizer and to code in the plugin */
+    erase_title_textures(nullptr);
+}
+
+void scale_show_title_t::erase_title_textures(wf::output_t *output)
+{
+    for (auto& view : wf::get_core().get_all_views())
+    {
+        if (!output || (view->get_output() == output))
+        {
+            view->erase_data<view_title_texture_t>();
+        }
+    }
 }
 
 void scale_show_title_t::update_title_overlay_opt()
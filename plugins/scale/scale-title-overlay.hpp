@@ -2,11 +2,19 @@
 
 #include "wayfire/signal-definitions.hpp"
 #include "wayfire/signal-provider.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include <wayfire/plugin.hpp>
 #include <wayfire/output.hpp>
 #include <wayfire/plugins/scale-signal.hpp>
+#include <wayfire/plugins/common/cairo-util.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
 
 namespace wf
 {
@@ -16,6 +24,44 @@ class title_overlay_node_t;
 }
 }
 
+/**
+ * A request to render a title, handled by scale_title_rasterizer_t.
+ */
+struct scale_title_job_t
+{
+    std::string text;
+    wf::cairo_text_t::params par;
+
+    /* Set by the rasterizer thread, valid once done is set */
+    wf::cairo_text_t result;
+    wf::dimensions_t size;
+    std::atomic<bool> done{false};
+};
+
+/**
+ * Renders titles with Cairo and Pango on a background thread, so that opening
+ * scale with many views does not block the compositor while all titles are
+ * rendered. The results are uploaded to textures on the main thread.
+ *
+ * A single rasterizer is shared by the scale instances on all outputs.
+ */
+class scale_title_rasterizer_t
+{
+  public:
+    scale_title_rasterizer_t() = default;
+    ~scale_title_rasterizer_t();
+
+    void submit(std::shared_ptr<scale_title_job_t> job);
+
+  private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::shared_ptr<scale_title_job_t>> queue;
+    bool stopping = false;
+    std::thread thread;
+
+    void run();
+};
 
 class scale_show_title_t
 {
@@ -28,6 +74,7 @@ class scale_show_title_t
     wf::option_wrapper_t<int> title_font_size{"scale/title_font_size"};
     wf::option_wrapper_t<std::string> title_position{"scale/title_position"};
     wf::output_t *output;
+    wf::shared_data::ref_ptr_t<scale_title_rasterizer_t> rasterizer;
 
   public:
     scale_show_title_t();
@@ -61,4 +108,7 @@ class scale_show_title_t
 
     void update_title_overlay_opt();
     void update_title_overlay_mouse();
+
+    /** Free the title overlays of the views on @output, or of all views if null. */
+    static void erase_title_textures(wf::output_t *output);
 };
@@ -23,6 +23,7 @@
 #include <linux/input-event-codes.h>
 
 #include "scale.hpp"
+#include "scale-layout.hpp"
 #include "scale-title-overlay.hpp"
 #include "wayfire/core.hpp"
 #include "wayfire/debug.hpp"
@@ -734,7 +735,7 @@ class wayfire_scale : public wf::per_output_plugin_instance_t,
         std::vector<wayfire_view> views;
 
         for (auto& view :
-             output->workspace->get_views_in_layer(wf::LAYER_WORKSPACE))
+             output->workspace->get_cached_views_in_layer(wf::LAYER_WORKSPACE))
         {
             if ((view->role != wf::VIEW_ROLE_TOPLEVEL) || !view->is_mapped())
             {
@@ -753,7 +754,7 @@ class wayfire_scale : public wf::per_output_plugin_instance_t,
         std::vector<wayfire_view> views;
 
         for (auto& view :
-             output->workspace->get_views_in_layer(wf::LAYER_WORKSPACE))
+             output->workspace->get_cached_views_in_layer(wf::LAYER_WORKSPACE))
         {
             if ((view->role != wf::VIEW_ROLE_TOPLEVEL) || !view->is_mapped())
             {
@@ -809,65 +810,34 @@ class wayfire_scale : public wf::per_output_plugin_instance_t,
         double translation_y,
         double target_alpha)
     {
-        view_data.animation.scale_animation.scale_x.set(
-            view_data.transformer->scale_x, scale_x);
-        view_data.animation.scale_animation.scale_y.set(
-            view_data.transformer->scale_y, scale_y);
-        view_data.animation.scale_animation.translation_x.set(
-            view_data.transformer->translation_x, translation_x);
-        view_data.animation.scale_animation.translation_y.set(
-            view_data.transformer->translation_y, translation_y);
-        view_data.animation.scale_animation.start();
-        view_data.fade_animation = wf::animation::simple_animation_t(
-            wf::option_wrapper_t<int>{"scale/duration"});
-        view_data.fade_animation.animate(view_data.transformer->alpha,
-            target_alpha);
-    }
+        auto& animation = view_data.animation.scale_animation;
+        auto& tr = view_data.transformer;
 
-    static bool view_compare_x(const wayfire_view& a, const wayfire_view& b)
-    {
-        auto vg_a = a->get_wm_geometry();
-        std::vector<int> a_coords = {vg_a.x, vg_a.width, vg_a.y, vg_a.height};
-        auto vg_b = b->get_wm_geometry();
-        std::vector<int> b_coords = {vg_b.x, vg_b.width, vg_b.y, vg_b.height};
-        return a_coords < b_coords;
-    }
-
-    static bool view_compare_y(const wayfire_view& a, const wayfire_view& b)
-    {
-        auto vg_a = a->get_wm_geometry();
-        std::vector<int> a_coords = {vg_a.y, vg_a.height, vg_a.x, vg_a.width};
-        auto vg_b = b->get_wm_geometry();
-        std::vector<int> b_coords = {vg_b.y, vg_b.height, vg_b.x, vg_b.width};
-        return a_coords < b_coords;
-    }
-
-    std::vector<std::vector<wayfire_view>> view_sort(
-        std::vector<wayfire_view>& views)
-    {
-        std::vector<std::vector<wayfire_view>> view_grid;
-        // First ensure a consistent sorting of all views using a persistent
-        // identifier before sorting by geometry.
-        // This is so that if two views have exactly the same geometry,
-        // they will always appear in the same order in the output list.
-        std::sort(views.begin(), views.end(), [] (auto a, auto b)
-        {
-            return a.get() < b.get();
-        });
-        std::stable_sort(views.begin(), views.end(), view_compare_y);
-
-        int rows = sqrt(views.size() + 1);
-        int views_per_row = (int)std::ceil((double)views.size() / rows);
-        size_t n = views.size();
-        for (size_t i = 0; i < n; i += views_per_row)
+        /* Views which keep their slot are already animating towards the same
+         * target, or have reached it. Restarting their animation would only
+         * make them stutter. */
+        const bool same_target = (animation.scale_x.end == scale_x) &&
+            (animation.scale_y.end == scale_y) &&
+            (animation.translation_x.end == translation_x) &&
+            (animation.translation_y.end == translation_y);
+        const bool at_target = (tr->scale_x == scale_x) && (tr->scale_y == scale_y) &&
+            (tr->translation_x == translation_x) && (tr->translation_y == translation_y);
+        if (!same_target || (!animation.running() && !at_target))
         {
-            size_t j = std::min(i + views_per_row, n);
-            view_grid.emplace_back(views.begin() + i, views.begin() + j);
-            std::stable_sort(view_grid.back().begin(), view_grid.back().end(),
-                view_compare_x);
+            animation.scale_x.set(tr->scale_x, scale_x);
+            animation.scale_y.set(tr->scale_y, scale_y);
+            animation.translation_x.set(tr->translation_x, translation_x);
+            animation.translation_y.set(tr->translation_y, translation_y);
+            animation.start();
         }
 
-        return view_grid;
+        if ((view_data.fade_animation.end != target_alpha) ||
+            (!view_data.fade_animation.running() && (tr->alpha != target_alpha)))
+        {
+            view_data.fade_animation = wf::animation::simple_animation_t(
+                wf::option_wrapper_t<int>{"scale/duration"});
+            view_data.fade_animation.animate(tr->alpha, target_alpha);
+        }
     }
 
     /* Filter the views to be arranged by layout_slots() */
@@ -908,8 +878,8 @@ class wayfire_scale : public wf::per_output_plugin_instance_t,
     }
 
     /* Compute target scale layout geometry for all the view transformers
-     * and start animating. Initial code borrowed from the compiz scale
-     * plugin algorithm */
+     * and start animating the views whose target changed. The grid itself is
+     * computed by wf::scale::compute_layout() */
     void layout_slots(std::vector<wayfire_view> views)
     {
         if (!views.size())
@@ -924,119 +894,115 @@ class wayfire_scale : public wf::per_output_plugin_instance_t,
 
         filter_views(views);
 
-        auto workarea = output->workspace->get_workarea();
-
-        auto sorted_rows = view_sort(views);
-        size_t cnt_rows  = sorted_rows.size();
+        std::vector<wf::scale::layout_item_t<wayfire_view>> items;
+        items.reserve(views.size());
+        for (auto& view : views)
+        {
+            items.push_back({view, view->get_wm_geometry()});
+        }
 
-        const double scaled_height = std::max((double)
-            (workarea.height - (cnt_rows + 1) * spacing) / cnt_rows, 1.0);
-        current_row_sizes.clear();
+        auto layout = wf::scale::compute_layout(std::move(items),
+            output->workspace->get_workarea(), spacing);
+        current_row_sizes = layout.row_sizes;
 
-        for (size_t i = 0; i < cnt_rows; i++)
+        for (auto& [view, slot] : layout.slots)
         {
-            size_t cnt_cols = sorted_rows[i].size();
-            current_row_sizes.push_back(cnt_cols);
-            const double scaled_width = std::max((double)
-                (workarea.width - (cnt_cols + 1) * spacing) / cnt_cols, 1.0);
+            const int i = slot.row;
+            const int j = slot.col;
+            const double x = slot.x;
+            const double y = slot.y;
+            const double scaled_width  = slot.width;
+            const double scaled_height = slot.height;
 
-            for (size_t j = 0; j < cnt_cols; j++)
+            // Calculate current transformation of the view, in order to
+            // ensure that new views in the view tree start directly at the
+            // correct position
+            double main_view_dx    = 0;
+            double main_view_dy    = 0;
+            double main_view_scale = 1.0;
+            if (scale_data.count(view))
             {
-                double x = workarea.x + spacing + (spacing + scaled_width) * j;
-                double y = workarea.y + spacing + (spacing + scaled_height) * i;
-
-                auto view = sorted_rows[i][j];
-
-                // Calculate current transformation of the view, in order to
-                // ensure that new views in the view tree start directly at the
-                // correct position
-                double main_view_dx    = 0;
-                double main_view_dy    = 0;
-                double main_view_scale = 1.0;
-                if (scale_data.count(view))
+                main_view_dx    = scale_data[view].transformer->translation_x;
+                main_view_dy    = scale_data[view].transformer->translation_y;
+                main_view_scale = scale_data[view].transformer->scale_x;
+            }
+
+            // Calculate target alpha for this view and its children
+            double target_alpha =
+                (view == current_focus_view) ? 1 : (double)inactive_alpha;
+
+            // Helper function to calculate the desired scale for a view
+            const auto& calculate_scale = [=] (wf::dimensions_t vg)
+            {
+                double w = std::max(1.0, scaled_width);
+                double h = std::max(1.0, scaled_height);
+
+                const double scale = std::min(w / vg.width, h / vg.height);
+                if (!allow_scale_zoom)
+                {
+                    return std::min(scale, max_scale_factor);
+                }
+
+                return scale;
+            };
+
+            add_transformer(view);
+            auto geom = view->get_wm_geometry();
+            double view_scale = calculate_scale({geom.width, geom.height});
+            for (auto& child : view->enumerate_views(false))
+            {
+                // Ensure a transformer for the view, and make sure that
+                // new views in the view tree start off with the correct
+                // attributes set.
+                auto new_child   = add_transformer(child);
+                auto& child_data = scale_data[child];
+                if (new_child)
                 {
-                    main_view_dx    = scale_data[view].transformer->translation_x;
-                    main_view_dy    = scale_data[view].transformer->translation_y;
-                    main_view_scale = scale_data[view].transformer->scale_x;
+                    child_data.transformer->translation_x = main_view_dx;
+                    child_data.transformer->translation_y = main_view_dy;
+                    child_data.transformer->scale_x = main_view_scale;
+                    child_data.transformer->scale_y = main_view_scale;
                 }
 
-                // Calculate target alpha for this view and its children
-                double target_alpha =
-                    (view == current_focus_view) ? 1 : (double)inactive_alpha;
+                if (child_data.visibility ==
+                    view_scale_data::view_visibility_t::HIDDEN)
+                {
+                    wf::scene::set_node_enabled(
+                        child->get_transformed_node(), true);
+                }
+
+                child_data.visibility =
+                    view_scale_data::view_visibility_t::VISIBLE;
+
+                child_data.row = i;
+                child_data.col = j;
 
-                // Helper function to calculate the desired scale for a view
-                const auto& calculate_scale = [=] (wf::dimensions_t vg)
+                if (!active)
                 {
-                    double w = std::max(1.0, scaled_width);
-                    double h = std::max(1.0, scaled_height);
-
-                    const double scale = std::min(w / vg.width, h / vg.height);
-                    if (!allow_scale_zoom)
-                    {
-                        return std::min(scale, max_scale_factor);
-                    }
-
-                    return scale;
-                };
-
-                add_transformer(view);
-                auto geom = view->get_wm_geometry();
-                double view_scale = calculate_scale({geom.width, geom.height});
-                for (auto& child : view->enumerate_views(false))
+                    // On exit, we just animate towards normal state
+                    setup_view_transform(child_data, 1, 1, 0, 0, 1);
+                    continue;
+                }
+
+                auto vg = child->get_wm_geometry();
+                wf::pointf_t center = {vg.x + vg.width / 2.0,
+                    vg.y + vg.height / 2.0};
+
+                // Take padding into account
+                double scale = calculate_scale({vg.width, vg.height});
+                // Ensure child is not scaled more than parent
+                if (!allow_scale_zoom &&
+                    (child != view) &&
+                    (max_scale_child > 0.0))
                 {
-                    // Ensure a transformer for the view, and make sure that
-                    // new views in the view tree start off with the correct
-                    // attributes set.
-                    auto new_child   = add_transformer(child);
-                    auto& child_data = scale_data[child];
-                    if (new_child)
-                    {
-                        child_data.transformer->translation_x = main_view_dx;
-                        child_data.transformer->translation_y = main_view_dy;
-                        child_data.transformer->scale_x = main_view_scale;
-                        child_data.transformer->scale_y = main_view_scale;
-                    }
-
-                    if (child_data.visibility ==
-                        view_scale_data::view_visibility_t::HIDDEN)
-                    {
-                        wf::scene::set_node_enabled(
-                            child->get_transformed_node(), true);
-                    }
-
-                    child_data.visibility =
-                        view_scale_data::view_visibility_t::VISIBLE;
-
-                    child_data.row = i;
-                    child_data.col = j;
-
-                    if (!active)
-                    {
-                        // On exit, we just animate towards normal state
-                        setup_view_transform(child_data, 1, 1, 0, 0, 1);
-                        continue;
-                    }
-
-                    auto vg = child->get_wm_geometry();
-                    wf::pointf_t center = {vg.x + vg.width / 2.0,
-                        vg.y + vg.height / 2.0};
-
-                    // Take padding into account
-                    double scale = calculate_scale({vg.width, vg.height});
-                    // Ensure child is not scaled more than parent
-                    if (!allow_scale_zoom &&
-                        (child != view) &&
-                        (max_scale_child > 0.0))
-                    {
-                        scale = std::min(max_scale_child * view_scale, scale);
-                    }
-
-                    // Target geometry is centered around the center slot
-                    const double dx = x - center.x + scaled_width / 2.0;
-                    const double dy = y - center.y + scaled_height / 2.0;
-                    setup_view_transform(child_data, scale, scale,
-                        dx, dy, target_alpha);
+                    scale = std::min(max_scale_child * view_scale, scale);
                 }
+
+                // Target geometry is centered around the center slot
+                const double dx = x - center.x + scaled_width / 2.0;
+                const double dy = y - center.y + scaled_height / 2.0;
+                setup_view_transform(child_data, scale, scale,
+                    dx, dy, target_alpha);
             }
         }
 
@@ -494,7 +494,7 @@ class WayfireSwitcher : public wf::per_output_plugin_instance_t, public wf::keyb
     // returns a list of mapped views
     std::vector<wayfire_view> get_workspace_views() const
     {
-        auto all_views = output->workspace->get_views_on_workspace(
+        const auto& all_views = output->workspace->get_cached_views_on_workspace(
             output->workspace->get_current_workspace(),
             wf::WM_LAYERS, true);
 
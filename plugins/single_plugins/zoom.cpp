@@ -2,7 +2,215 @@
 #include <wayfire/output.hpp>
 #include <wayfire/opengl.hpp>
 #include <wayfire/render-manager.hpp>
+#include <wayfire/scene-operations.hpp>
+#include <wayfire/scene-render.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include <wayfire/workspace-manager.hpp>
+#include <wayfire/workspace-stream.hpp>
 #include <wayfire/util/duration.hpp>
+#include <chrono>
+
+#include "ipc-helpers.hpp"
+#include "ipc-method-repository.hpp"
+#include "sample-stats.hpp"
+
+/**
+ * A node which shows a part of the current workspace of an output, magnified
+ * over the whole output.
+ *
+ * The workspace is rendered directly into a render target whose logical
+ * geometry is the zoomed-in viewport, so surfaces are drawn once at the
+ * magnified resolution, and damage outside of the viewport does not cause
+ * any repaint.
+ */
+class zoom_node_t : public wf::scene::node_t
+{
+    class zoom_render_instance_t : public wf::scene::render_instance_t
+    {
+        zoom_node_t *self;
+        wf::scene::damage_callback push_damage;
+        std::vector<wf::scene::render_instance_uptr> children;
+
+        wf::signal::connection_t<wf::scene::node_damage_signal> on_zoom_damage =
+            [=] (wf::scene::node_damage_signal *ev)
+        {
+            push_damage(ev->region);
+        };
+
+      public:
+        zoom_render_instance_t(zoom_node_t *self,
+            wf::scene::damage_callback push_damage)
+        {
+            this->self = self;
+            this->push_damage = push_damage;
+            self->connect(&on_zoom_damage);
+
+            auto push_damage_child = [=] (const wf::region_t& damage)
+            {
+                this->push_damage(self->viewport_to_output(damage));
+            };
+
+            self->stream->gen_render_instances(children, push_damage_child,
+                self->output);
+        }
+
+        void schedule_instructions(
+            std::vector<wf::scene::render_instruction_t>& instructions,
+            const wf::render_target_t& target, wf::region_t& damage) override
+        {
+            auto bbox = self->get_bounding_box();
+            auto our_damage = self->output_to_viewport(damage & bbox);
+            if (our_damage.empty())
+            {
+                return;
+            }
+
+            // The viewport is stretched over the part of the framebuffer
+            // which the output occupies.
+            wf::render_target_t zoomed = target;
+            zoomed.geometry  = self->viewport;
+            zoomed.subbuffer = target.framebuffer_box_from_geometry_box(bbox);
+            zoomed.scale     = target.scale * bbox.width / self->viewport.width;
+
+            for (auto& ch : children)
+            {
+                ch->schedule_instructions(instructions, zoomed, our_damage);
+            }
+
+            damage ^= bbox;
+        }
+
+        void presentation_feedback(wf::output_t *output) override
+        {
+            for (auto& ch : children)
+            {
+                ch->presentation_feedback(output);
+            }
+        }
+
+        void compute_visibility(wf::output_t *output, wf::region_t& visible) override
+        {
+            // Only the part of the viewport shown on the visible part of the
+            // output is visible.
+            auto zoomed_region = self->output_to_viewport(visible & self->get_bounding_box());
+            for (auto& ch : children)
+            {
+                ch->compute_visibility(output, zoomed_region);
+            }
+        }
+    };
+
+  public:
+    zoom_node_t(wf::output_t *output) : node_t(false)
+    {
+        this->output = output;
+        this->viewport = output->get_relative_geometry();
+        this->stream   = std::make_shared<wf::workspace_stream_node_t>(output,
+            output->workspace->get_current_workspace());
+        update_damage_clip();
+    }
+
+    /**
+     * Stop clipping the damage of the output's layers, for example when the
+     * node is about to be removed.
+     */
+    void release_damage_clip()
+    {
+        for (int i = 0; i < (int)wf::scene::layer::ALL_LAYERS; i++)
+        {
+            output->node_for_layer((wf::scene::layer)i)->damage_clip.reset();
+        }
+    }
+
+    /**
+     * Set the part of the workspace, in output-local coordinates, which is
+     * shown over the whole output.
+     */
+    void set_viewport(wf::geometry_t viewport)
+    {
+        if (viewport == this->viewport)
+        {
+            return;
+        }
+
+        this->viewport = viewport;
+        update_damage_clip();
+        wf::scene::damage_node(this, get_bounding_box());
+    }
+
+    void gen_render_instances(
+        std::vector<wf::scene::render_instance_uptr>& instances,
+        wf::scene::damage_callback push_damage, wf::output_t *shown_on) override
+    {
+        if (shown_on != this->output)
+        {
+            return;
+        }
+
+        instances.push_back(std::make_unique<zoom_render_instance_t>(
+            this, push_damage));
+    }
+
+    std::string stringify() const override
+    {
+        return "zoom " + stringify_flags();
+    }
+
+    wf::geometry_t get_bounding_box() override
+    {
+        return output->get_layout_geometry();
+    }
+
+  private:
+    wf::output_t *output;
+    wf::geometry_t viewport;
+    std::shared_ptr<wf::workspace_stream_node_t> stream;
+
+    /**
+     * The output's layers are still rendered below the zoom node, but only the
+     * part of them inside of the viewport can change what is shown, so their
+     * unzoomed damage is clipped to it. The zoomed damage comes from the stream.
+     */
+    void update_damage_clip()
+    {
+        auto clip = viewport + wf::origin(output->get_layout_geometry());
+        for (int i = 0; i < (int)wf::scene::layer::ALL_LAYERS; i++)
+        {
+            output->node_for_layer((wf::scene::layer)i)->damage_clip = clip;
+        }
+    }
+
+    /**
+     * Map each rectangle of @region from @from to @to, keeping only the part
+     * inside of @from. The result is grown by a pixel, so that rounding never
+     * loses damage.
+     */
+    static wf::region_t map_region(const wf::region_t& region,
+        wf::geometry_t from, wf::geometry_t to)
+    {
+        wf::region_t result;
+        for (auto& rect : region & from)
+        {
+            auto box = wf::scale_box(from, to, wlr_box_from_pixman_box(rect));
+            result |= wf::geometry_t{box.x - 1, box.y - 1,
+                box.width + 2, box.height + 2};
+        }
+
+        return result & to;
+    }
+
+    /** Map damage in output-local coordinates to the layout coordinates of the zoomed image. */
+    wf::region_t viewport_to_output(const wf::region_t& region)
+    {
+        return map_region(region, viewport, get_bounding_box());
+    }
+
+    /** Map damage in layout coordinates to the output-local coordinates of the viewport. */
+    wf::region_t output_to_viewport(const wf::region_t& region)
+    {
+        return map_region(region, get_bounding_box(), viewport);
+    }
+};
 
 class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
 {
@@ -12,23 +220,69 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
         NEAREST = 1,
     };
 
+    enum zoom_mode_t
+    {
+        ZOOM_MODE_NONE        = -1,
+        ZOOM_MODE_NATIVE      = 0,
+        ZOOM_MODE_POSTPROCESS = 1,
+    };
+
     wf::option_wrapper_t<wf::keybinding_t> modifier{"zoom/modifier"};
     wf::option_wrapper_t<double> speed{"zoom/speed"};
     wf::option_wrapper_t<int> smoothing_duration{"zoom/smoothing_duration"};
     wf::option_wrapper_t<int> interpolation_method{"zoom/interpolation_method"};
+    wf::option_wrapper_t<bool> native_render{"zoom/native_render"};
     wf::animation::simple_animation_t progression{smoothing_duration};
-    bool hook_set = false;
+    zoom_mode_t mode = ZOOM_MODE_NONE;
+    std::shared_ptr<zoom_node_t> zoom_node;
 
     wf::plugin_activation_data_t grab_interface = {
         .name = "zoom",
         .capabilities = 0,
     };
 
+    /** Frame statistics, indexed by zoom_mode_t. */
+    wf::ipc::sample_stats_t frame_time[2];
+    wf::ipc::sample_stats_t repaint_fraction[2];
+    std::chrono::steady_clock::time_point frame_start;
+    double last_repaint_fraction = 0.0;
+
   public:
     void init() override
     {
         progression.set(1, 1);
         output->add_axis(modifier, &axis);
+        native_render.set_callback([=] ()
+        {
+            if (mode != ZOOM_MODE_NONE)
+            {
+                unset_hook();
+                set_hook();
+            }
+        });
+    }
+
+    /**
+     * Zoom to the given level. Without animation, the level is applied
+     * immediately, which is useful for benchmarks.
+     */
+    void set_zoom(float level, bool animate)
+    {
+        level = wf::clamp(level, 1.0f, 50.0f);
+        if (animate)
+        {
+            progression.animate(level);
+        } else
+        {
+            progression.set(level, level);
+        }
+
+        if (mode == ZOOM_MODE_NONE)
+        {
+            set_hook();
+        }
+
+        output->render->schedule_redraw();
     }
 
     void update_zoom_target(float delta)
@@ -39,14 +293,31 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
 
         if (target != progression.end)
         {
-            progression.animate(target);
+            set_zoom(target, true);
+        }
+    }
 
-            if (!hook_set)
-            {
-                hook_set = true;
-                output->render->add_post(&render_hook);
-                output->render->set_redraw_always();
-            }
+    nlohmann::json get_stats()
+    {
+        nlohmann::json stats;
+        static const char *names[] = {"native", "postprocess"};
+        for (int i : {ZOOM_MODE_NATIVE, ZOOM_MODE_POSTPROCESS})
+        {
+            stats[names[i]]["frame-time-us"]    = frame_time[i].to_json();
+            stats[names[i]]["repaint-fraction"] = repaint_fraction[i].to_json();
+        }
+
+        stats["level"] = (double)progression;
+        stats["mode"]  = (mode == ZOOM_MODE_NONE) ? "none" : names[mode];
+        return stats;
+    }
+
+    void reset_stats()
+    {
+        for (int i : {ZOOM_MODE_NATIVE, ZOOM_MODE_POSTPROCESS})
+        {
+            frame_time[i].reset();
+            repaint_fraction[i].reset();
         }
     }
 
@@ -67,6 +338,141 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
         return true;
     };
 
+    /**
+     * Get the part of the output which is visible at the given zoom level.
+     * It is placed so that the point under the cursor stays in place.
+     */
+    wf::geometry_t get_zoom_viewport(float level)
+    {
+        auto oc = output->get_cursor_position();
+        double x, y;
+        wlr_box b = output->get_relative_geometry();
+        wlr_box_closest_point(&b, oc.x, oc.y, &x, &y);
+
+        const float scale = (level - 1) / level;
+        return wf::geometry_t{
+            .x     = int(x * scale),
+            .y     = int(y * scale),
+            .width = std::max(1, int(b.width / level)),
+            .height = std::max(1, int(b.height / level)),
+        };
+    }
+
+    bool zoom_finished()
+    {
+        return !progression.running() && (progression - 1 <= 0.01);
+    }
+
+    wf::effect_hook_t pre_hook = [=] ()
+    {
+        frame_start = std::chrono::steady_clock::now();
+        if (mode != ZOOM_MODE_NATIVE)
+        {
+            return;
+        }
+
+        if (zoom_finished())
+        {
+            unset_hook();
+            return;
+        }
+
+        // Changing the viewport damages the output. Frames are requested
+        // without damage only while the animation runs, so that it can finish
+        // even if the viewport does not change.
+        zoom_node->set_viewport(get_zoom_viewport(progression));
+        if (progression.running())
+        {
+            output->render->schedule_redraw();
+        }
+    };
+
+    wf::effect_hook_t overlay_hook = [=] ()
+    {
+        const double area = output->handle->width * output->handle->height;
+        double damaged = 0;
+        for (auto& box : output->render->get_swap_damage())
+        {
+            damaged += (box.x2 - box.x1) * (box.y2 - box.y1);
+        }
+
+        last_repaint_fraction = (mode == ZOOM_MODE_NATIVE && area > 0) ?
+            std::min(1.0, damaged / area) : 1.0;
+    };
+
+    wf::effect_hook_t post_frame_hook = [=] ()
+    {
+        if (mode == ZOOM_MODE_NONE)
+        {
+            return;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - frame_start;
+        frame_time[mode].add(
+            std::chrono::duration<double, std::micro>(elapsed).count());
+        repaint_fraction[mode].add(last_repaint_fraction);
+    };
+
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_pointer_motion_event>>
+    on_motion = [=] (wf::post_input_event_signal<wlr_pointer_motion_event>*)
+    {
+        update_viewport();
+    };
+
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_pointer_motion_absolute_event>>
+    on_motion_absolute =
+        [=] (wf::post_input_event_signal<wlr_pointer_motion_absolute_event>*)
+    {
+        update_viewport();
+    };
+
+    wf::signal::connection_t<wf::workspace_changed_signal> on_workspace_changed =
+        [=] (wf::workspace_changed_signal *ev)
+    {
+        // The zoom node shows a single workspace, so it has to be recreated.
+        if (mode == ZOOM_MODE_NATIVE)
+        {
+            wf::scene::remove_child(zoom_node);
+            add_zoom_node();
+        }
+    };
+
+    void update_viewport()
+    {
+        if (mode == ZOOM_MODE_NATIVE)
+        {
+            zoom_node->set_viewport(get_zoom_viewport(progression));
+        }
+    }
+
+    void add_zoom_node()
+    {
+        zoom_node = std::make_shared<zoom_node_t>(output);
+        zoom_node->set_viewport(get_zoom_viewport(progression));
+        wf::scene::add_front(wf::get_core().scene(), zoom_node);
+    }
+
+    void set_hook()
+    {
+        output->render->add_effect(&pre_hook, wf::OUTPUT_EFFECT_PRE);
+        output->render->add_effect(&overlay_hook, wf::OUTPUT_EFFECT_OVERLAY);
+        output->render->add_effect(&post_frame_hook, wf::OUTPUT_EFFECT_POST);
+
+        if (native_render)
+        {
+            mode = ZOOM_MODE_NATIVE;
+            add_zoom_node();
+            wf::get_core().connect(&on_motion);
+            wf::get_core().connect(&on_motion_absolute);
+            output->connect(&on_workspace_changed);
+        } else
+        {
+            mode = ZOOM_MODE_POSTPROCESS;
+            output->render->add_post(&render_hook);
+            output->render->set_redraw_always();
+        }
+    }
+
     wf::post_hook_t render_hook = [=] (const wf::framebuffer_t& source,
                                        const wf::framebuffer_t& destination)
     {
@@ -106,7 +512,7 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
             GL_COLOR_BUFFER_BIT, interpolation));
         OpenGL::render_end();
 
-        if (!progression.running() && (progression - 1 <= 0.01))
+        if (zoom_finished())
         {
             unset_hook();
         }
@@ -114,20 +520,110 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
 
     void unset_hook()
     {
-        output->render->set_redraw_always(false);
-        output->render->rem_post(&render_hook);
-        hook_set = false;
+        if (mode == ZOOM_MODE_NATIVE)
+        {
+            zoom_node->release_damage_clip();
+            wf::scene::remove_child(zoom_node);
+            zoom_node = nullptr;
+            on_motion.disconnect();
+            on_motion_absolute.disconnect();
+            on_workspace_changed.disconnect();
+        } else if (mode == ZOOM_MODE_POSTPROCESS)
+        {
+            output->render->set_redraw_always(false);
+            output->render->rem_post(&render_hook);
+        }
+
+        output->render->rem_effect(&pre_hook);
+        output->render->rem_effect(&overlay_hook);
+        output->render->rem_effect(&post_frame_hook);
+        mode = ZOOM_MODE_NONE;
     }
 
     void fini() override
     {
-        if (hook_set)
+        if (mode != ZOOM_MODE_NONE)
         {
-            output->render->rem_post(&render_hook);
+            unset_hook();
         }
 
         output->rem_binding(&axis);
     }
 };
 
-DECLARE_WAYFIRE_PLUGIN(wf::per_output_plugin_t<wayfire_zoom_screen>);
+class wayfire_zoom_plugin_t : public wf::per_output_plugin_t<wayfire_zoom_screen>
+{
+  public:
+    void init() override
+    {
+        per_output_plugin_t::init();
+        method_repository->register_method("zoom/set", set_zoom);
+        method_repository->register_method("zoom/stats", get_stats);
+    }
+
+    void fini() override
+    {
+        method_repository->unregister_method("zoom/set");
+        method_repository->unregister_method("zoom/stats");
+        per_output_plugin_t::fini();
+    }
+
+  private:
+    wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
+
+    wayfire_zoom_screen *find_instance(const nlohmann::json& data)
+    {
+        auto wo = wf::ipc::find_output_by_id(data["output-id"].get<int>());
+        if (!wo || !output_instance.count(wo))
+        {
+            return nullptr;
+        }
+
+        return output_instance[wo].get();
+    }
+
+    wf::ipc::method_callback set_zoom = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "output-id", number_integer);
+        WFJSON_EXPECT_FIELD(data, "level", number);
+
+        auto instance = find_instance(data);
+        if (!instance)
+        {
+            return wf::ipc::json_error("output not found");
+        }
+
+        bool animate = data.contains("animate") && data["animate"].is_boolean() &&
+            data["animate"].get<bool>();
+        instance->set_zoom(data["level"].get<double>(), animate);
+        return wf::ipc::json_ok();
+    };
+
+    /**
+     * Report the frame times and the repainted part of the output of the
+     * native and the postprocessing modes, so that both can be compared, for
+     * example on headless outputs.
+     */
+    wf::ipc::method_callback get_stats = [=] (nlohmann::json data)
+    {
+        WFJSON_EXPECT_FIELD(data, "output-id", number_integer);
+
+        auto instance = find_instance(data);
+        if (!instance)
+        {
+            return wf::ipc::json_error("output not found");
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["stats"] = instance->get_stats();
+        if (data.contains("reset") && data["reset"].is_boolean() &&
+            data["reset"].get<bool>())
+        {
+            instance->reset_stats();
+        }
+
+        return response;
+    };
+};
+
+DECLARE_WAYFIRE_PLUGIN(wayfire_zoom_plugin_t);
@@ -113,6 +113,7 @@ class tile_plugin_t : public wf::per_output_plugin_instance_t, public wf::pointe
     {
         auto output_geometry = output->get_relative_geometry();
         auto wsize = output->workspace->get_workspace_grid_size();
+        tile::relayout_transaction_t relayout;
         for (int i = 0; i < wsize.width; i++)
         {
             for (int j = 0; j < wsize.height; j++)
@@ -136,6 +137,7 @@ class tile_plugin_t : public wf::per_output_plugin_instance_t, public wf::pointe
             .internal = inner_gaps,
         };
 
+        tile::relayout_transaction_t relayout;
         for (auto& col : roots)
         {
             for (auto& root : col)
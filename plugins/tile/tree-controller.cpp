@@ -302,6 +302,8 @@ void move_view_controller_t::input_released()
         return;
     }
 
+    // Resize all views affected by the drop together
+    relayout_transaction_t relayout;
     if (split == INSERT_SWAP)
     {
         std::swap(grabbed_view->geometry, dropped_at->geometry);
@@ -318,6 +320,10 @@ void move_view_controller_t::input_released()
 
         std::swap(*it1, *it2);
 
+        /* The geometry of the views was swapped above, but they still need
+         * to be resized */
+        grabbed_view->mark_dirty();
+        dropped_at->mark_dirty();
         p1->set_geometry(p1->geometry);
         p2->set_geometry(p2->geometry);
         return;
@@ -537,6 +543,7 @@ void resize_view_controller_t::input_motion(wf::point_t input)
         return;
     }
 
+    relayout_transaction_t relayout;
     if (horizontal_pair.first && horizontal_pair.second)
     {
         int dy = input.y - last_point.y;
@@ -5,6 +5,7 @@
 #include <wayfire/output.hpp>
 #include <wayfire/workspace-manager.hpp>
 #include <wayfire/view-transform.hpp>
+#include <wayfire/transaction/view-instructions.hpp>
 #include <algorithm>
 #include <wayfire/plugins/crossfade.hpp>
 #include <wayfire/plugins/common/util.hpp>
@@ -13,9 +14,51 @@ namespace wf
 {
 namespace tile
 {
+static int relayout_depth = 0;
+static wf::txn::transaction_uptr_t relayout_tx;
+
+relayout_transaction_t::relayout_transaction_t()
+{
+    if (relayout_depth++ == 0)
+    {
+        relayout_tx = wf::txn::transaction_t::create();
+    }
+}
+
+relayout_transaction_t::~relayout_transaction_t()
+{
+    if (--relayout_depth == 0)
+    {
+        auto tx = std::move(relayout_tx);
+        if (!tx->get_objects().empty())
+        {
+            wf::txn::transaction_manager_t::get().submit(std::move(tx));
+        }
+    }
+}
+
+wf::txn::transaction_t*relayout_transaction_t::current()
+{
+    return relayout_tx.get();
+}
+
 void tree_node_t::set_geometry(wf::geometry_t geometry)
 {
     this->geometry = geometry;
+    this->dirty    = false;
+}
+
+void tree_node_t::mark_dirty()
+{
+    for (tree_node_t *node = this; node; node = node->parent.get())
+    {
+        node->dirty = true;
+    }
+}
+
+bool tree_node_t::needs_relayout(wf::geometry_t new_geometry) const
+{
+    return dirty || (new_geometry != geometry);
 }
 
 nonstd::observer_ptr<split_node_t> tree_node_t::as_split_node()
@@ -94,6 +137,8 @@ void split_node_t::recalculate_children(wf::geometry_t available)
         return;
     }
 
+    // Children whose geometry changes are resized together
+    relayout_transaction_t relayout;
     double old_child_sum = 0.0;
     for (auto& child : this->children)
     {
@@ -125,6 +170,9 @@ void split_node_t::recalculate_children(wf::geometry_t available)
         int32_t child_size = child_end - child_start;
         child->set_geometry(get_child_geometry(child_start, child_size));
     }
+
+    /* Changing the gaps of the children above marks the node dirty again */
+    this->dirty = false;
 }
 
 void split_node_t::add_child(std::unique_ptr<tree_node_t> child, int index)
@@ -194,12 +242,22 @@ std::unique_ptr<tree_node_t> split_node_t::remove_child(
 
 void split_node_t::set_geometry(wf::geometry_t geometry)
 {
+    if (!needs_relayout(geometry))
+    {
+        return;
+    }
+
     tree_node_t::set_geometry(geometry);
     recalculate_children(geometry);
 }
 
 void split_node_t::set_gaps(const gap_size_t& gaps)
 {
+    if (this->gaps != gaps)
+    {
+        mark_dirty();
+    }
+
     this->gaps = gaps;
     for (const auto& child : this->children)
     {
@@ -338,8 +396,14 @@ view_node_t::view_node_t(wayfire_view view)
     });
     this->on_decoration_changed.set_callback([=] (auto)
     {
+        mark_dirty();
         set_geometry(geometry);
     });
+    this->on_fullscreen.set_callback([=] (auto)
+    {
+        // The view gets a different size with the same node geometry
+        mark_dirty();
+    });
     on_adjust_transformer.set_callback([=] (auto)
     {
         update_transformer();
@@ -347,6 +411,7 @@ view_node_t::view_node_t(wayfire_view view)
 
     view->connect(&on_geometry_changed);
     view->connect(&on_decoration_changed);
+    view->connect(&on_fullscreen);
     view->connect(&on_adjust_transformer);
 }
 
@@ -364,6 +429,7 @@ void view_node_t::set_gaps(const gap_size_t& size)
         (this->gaps.right != size.right))
     {
         this->gaps = size;
+        mark_dirty();
     }
 }
 
@@ -444,6 +510,12 @@ static nonstd::observer_ptr<wf::grid::grid_animation_t> ensure_animation(
 
 void view_node_t::set_geometry(wf::geometry_t geometry)
 {
+    if (!needs_relayout(geometry))
+    {
+        return;
+    }
+
+    relayout_transaction_t relayout;
     tree_node_t::set_geometry(geometry);
 
     if (!view->is_mapped())
@@ -451,10 +523,21 @@ void view_node_t::set_geometry(wf::geometry_t geometry)
         return;
     }
 
+    if (!this->needs_crossfade())
+    {
+        // Resize the view together with the rest of the relayout
+        wf::txn::view_state_t state;
+        state.geometry    = calculate_target_geometry();
+        state.tiled_edges = TILED_EDGES_ALL;
+        relayout_transaction_t::current()->add_instruction(
+            wf::txn::view_state_instruction_t::get(view, state));
+        return;
+    }
+
     view->set_tiled(TILED_EDGES_ALL);
 
     auto target = calculate_target_geometry();
-    if (this->needs_crossfade() && (target != view->get_wm_geometry()))
+    if (target != view->get_wm_geometry())
     {
         view->get_transformed_node()->rem_transformer(scale_transformer_name);
         ensure_animation(view, animation_duration)
@@ -4,6 +4,7 @@
 #include "wayfire/signal-definitions.hpp"
 #include <wayfire/view.hpp>
 #include <wayfire/option-wrapper.hpp>
+#include <wayfire/transaction/transaction.hpp>
 
 namespace wf
 {
@@ -32,6 +33,35 @@ struct gap_size_t
     int32_t bottom = 0;
     /* Gap for internal splits */
     int32_t internal = 0;
+
+    bool operator ==(const gap_size_t& other) const
+    {
+        return left == other.left && right == other.right && top == other.top &&
+               bottom == other.bottom && internal == other.internal;
+    }
+
+    bool operator !=(const gap_size_t& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * While an instance of this class exists, the new geometry and tiled state of
+ * the views which are rearranged by the tree are collected in a transaction,
+ * which is submitted when the last instance is destroyed. This way, all views
+ * affected by a relayout are resized together.
+ */
+struct relayout_transaction_t
+{
+    relayout_transaction_t();
+    ~relayout_transaction_t();
+
+    relayout_transaction_t(const relayout_transaction_t&) = delete;
+    relayout_transaction_t& operator =(const relayout_transaction_t&) = delete;
+
+    /** @return The transaction which is being collected, or nullptr. */
+    static wf::txn::transaction_t *current();
 };
 
 struct tree_node_t
@@ -45,9 +75,21 @@ struct tree_node_t
     /** The geometry occupied by the node */
     wf::geometry_t geometry;
 
-    /** Set the geometry available for the node and its subnodes. */
+    /**
+     * Set the geometry available for the node and its subnodes.
+     *
+     * Nodes which are not dirty and whose geometry does not change are
+     * skipped together with their subtrees.
+     */
     virtual void set_geometry(wf::geometry_t geometry);
 
+    /**
+     * Mark the node and its parents as needing a relayout even if their
+     * geometry does not change, for example because the state of the view
+     * changed or because the node was moved in the tree.
+     */
+    void mark_dirty();
+
     /** Set the gaps for the node and subnodes. */
     virtual void set_gaps(const gap_size_t& gaps) = 0;
 
@@ -62,6 +104,12 @@ struct tree_node_t
   protected:
     /* Gaps */
     gap_size_t gaps;
+
+    /* Whether the node needs a relayout regardless of its geometry */
+    bool dirty = true;
+
+    /** @return Whether setting the given geometry changes anything. */
+    bool needs_relayout(wf::geometry_t new_geometry) const;
 };
 
 /**
@@ -175,6 +223,7 @@ struct view_node_t : public tree_node_t
 
     wf::signal::connection_t<view_geometry_changed_signal> on_geometry_changed;
     wf::signal::connection_t<view_decoration_changed_signal> on_decoration_changed;
+    wf::signal::connection_t<view_fullscreen_signal> on_fullscreen;
     wf::signal::connection_t<tile_adjust_transformer_signal> on_adjust_transformer;
 
     wf::option_wrapper_t<int> animation_duration{"simple-tile/animation_duration"};
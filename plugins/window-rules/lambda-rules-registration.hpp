@@ -20,6 +20,13 @@ namespace wf
 {
 struct lambda_rule_registration_t;
 
+/**
+ * on: core
+ * when: A lambda rule has been registered or unregistered.
+ */
+struct lambda_rules_changed_signal
+{};
+
 using map_type = std::map<std::string, std::shared_ptr<lambda_rule_registration_t>>;
 
 using lambda_reg_t = std::function<bool (std::string, wayfire_view)>;
@@ -92,6 +99,15 @@ struct lambda_rule_registration_t
      */
     std::shared_ptr<wf::lambda_rule_t> rule_instance;
 
+    /**
+     * @brief current_signal, current_view The context of the evaluation in
+     * progress. The if/else wrappers are bound to the rule instance once on
+     * registration and read the context from here, so that window rules do not
+     * need to rebuild them for every signal.
+     */
+    std::string current_signal;
+    wayfire_view current_view = nullptr;
+
     // Friendship for window rules to be able to execute the rules.
     friend class ::wayfire_window_rules_t;
 
@@ -171,7 +187,27 @@ class lambda_rules_registrations_t : public custom_data_t
             return true; // Error, failed to parse rule.
         }
 
+        // Bind the wrappers once, they pick up the signal and view from the
+        // registration when the rule is applied.
+        auto reg = registration.get();
+        registration->rule_instance->setIfLambda([reg] () -> bool
+        {
+            return reg->if_lambda(reg->current_signal, reg->current_view);
+        });
+
+        if (registration->else_lambda)
+        {
+            registration->rule_instance->setElseLambda([reg] () -> bool
+            {
+                return reg->else_lambda(reg->current_signal, reg->current_view);
+            });
+        }
+
         _registrations.emplace(key, registration);
+        ++_generation;
+
+        lambda_rules_changed_signal ev;
+        get_core().emit(&ev);
 
         return false;
     }
@@ -185,7 +221,24 @@ class lambda_rules_registrations_t : public custom_data_t
      */
     void unregister_lambda_rule(std::string key)
     {
-        _registrations.erase(key);
+        if (_registrations.erase(key))
+        {
+            ++_generation;
+
+            lambda_rules_changed_signal ev;
+            get_core().emit(&ev);
+        }
+    }
+
+    /**
+     * @brief generation Gets a counter which is incremented whenever the set of
+     * registered rules changes.
+     *
+     * @return The current generation of the rules map.
+     */
+    uint64_t generation() const
+    {
+        return _generation;
     }
 
     /**
@@ -211,6 +264,11 @@ class lambda_rules_registrations_t : public custom_data_t
      */
     map_type _registrations;
 
+    /**
+     * @brief _generation Incremented on each registration and unregistration.
+     */
+    uint64_t _generation = 0;
+
     // Necessary for window-rules to manage the lifetime of the object
     uint32_t window_rule_instances = 0;
     friend class ::wayfire_window_rules_t;
@@ -1,6 +1,9 @@
 #include <algorithm>
+#include <cctype>
 #include <cfloat>
+#include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include <wayfire/per-output-plugin.hpp>
@@ -17,8 +20,167 @@
 
 #include "lambda-rules-registration.hpp"
 #include "view-action-interface.hpp"
+#include "ipc-method-repository.hpp"
+#include "wayfire/plugins/common/shared-core-data.hpp"
 #include "wayfire/signal-provider.hpp"
 
+namespace wf
+{
+namespace window_rules
+{
+/**
+ * Properties of the view access interface which a rule condition may reference.
+ */
+static const std::set<std::string> view_properties = {
+    "app_id", "title", "role", "fullscreen", "activated", "minimized",
+    "focusable", "mapped", "tiled-left", "tiled-right", "tiled-top",
+    "tiled-bottom", "maximized", "floating", "type",
+};
+
+/**
+ * Information about a rule, extracted from its text so that the rule can be
+ * indexed without evaluating it.
+ */
+struct rule_info_t
+{
+    /** The signal in the `on <signal>` clause, empty if it could not be found. */
+    std::string signal;
+    /** The view properties which the rule's condition references. */
+    std::set<std::string> properties;
+};
+
+/**
+ * Scan the text of a rule for its signal and the view properties it references.
+ * String literals are skipped, so `title contains "app_id"` depends only on title.
+ */
+inline rule_info_t scan_rule(const std::string& text)
+{
+    rule_info_t info;
+    std::vector<std::string> words;
+
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        if ((c == '"') || (c == '\''))
+        {
+            i = text.find(c, i + 1);
+            i = (i == std::string::npos) ? text.size() : i + 1;
+        } else if (std::isalpha((unsigned char)c) || (c == '_'))
+        {
+            size_t start = i;
+            while ((i < text.size()) && (std::isalnum((unsigned char)text[i]) ||
+                                         (text[i] == '_') || (text[i] == '-')))
+            {
+                ++i;
+            }
+
+            words.push_back(text.substr(start, i - start));
+        } else
+        {
+            ++i;
+        }
+    }
+
+    if ((words.size() >= 2) && (words[0] == "on"))
+    {
+        info.signal = words[1];
+    }
+
+    for (size_t j = 2; j < words.size(); j++)
+    {
+        if (words[j] == "then")
+        {
+            break;
+        }
+
+        if (view_properties.count(words[j]))
+        {
+            info.properties.insert(words[j]);
+        }
+    }
+
+    return info;
+}
+
+/**
+ * Signals which are emitted when a single view property changes. On them, only
+ * rules whose condition references the property can have a different outcome.
+ */
+static const std::map<std::string, std::string> property_signals = {
+    {"title-changed", "title"},
+    {"app-id-changed", "app_id"},
+};
+
+/**
+ * Evaluation counters, shared between the instances on all outputs.
+ */
+struct stats_t
+{
+    uint64_t signals     = 0;
+    uint64_t evaluations = 0;
+    /** Rules which were not evaluated because they do not depend on the change. */
+    uint64_t skipped = 0;
+    std::map<std::string, uint64_t> evaluations_per_signal;
+
+    /** The view properties referenced by the rules on each signal. */
+    std::map<std::string, std::set<std::string>> signal_properties;
+
+    /** Evaluations in the current and in the last full second. */
+    int64_t second_start = 0;
+    uint64_t current_second = 0;
+    uint64_t last_second    = 0;
+
+    void count_signal()
+    {
+        ++signals;
+    }
+
+    void count_evaluation(const std::string& signal)
+    {
+        roll_second();
+        ++evaluations;
+        ++current_second;
+        ++evaluations_per_signal[signal];
+    }
+
+    void roll_second()
+    {
+        auto now = wf::get_current_time();
+        if (now - second_start >= 1000)
+        {
+            last_second    = (now - second_start < 2000) ? current_second : 0;
+            current_second = 0;
+            second_start   = now;
+        }
+    }
+
+    nlohmann::json to_json()
+    {
+        roll_second();
+        nlohmann::json j;
+        j["signals"]     = signals;
+        j["evaluations"] = evaluations;
+        j["skipped"]     = skipped;
+        j["evaluations-per-second"] = last_second;
+        j["evaluations-per-signal"] = nlohmann::json::object();
+        for (auto& [signal, count] : evaluations_per_signal)
+        {
+            j["evaluations-per-signal"][signal] = count;
+        }
+
+        j["index"] = nlohmann::json::object();
+        for (auto& [signal, properties] : signal_properties)
+        {
+            j["index"][signal.empty() ? "unknown" : signal] = properties;
+        }
+
+        return j;
+    }
+};
+}
+}
+
 class wayfire_window_rules_t : public wf::per_output_plugin_instance_t
 {
   public:
@@ -28,6 +190,8 @@ class wayfire_window_rules_t : public wf::per_output_plugin_instance_t
 
   private:
     void setup_rules_from_config();
+    void update_lambda_index();
+    void update_property_listeners();
     wf::lexer_t _lexer;
 
     // Created rule handler.
@@ -55,18 +219,75 @@ class wayfire_window_rules_t : public wf::per_output_plugin_instance_t
         apply("fullscreened", ev->view);
     };
 
+    // Title and app-id changes are only listened for if a rule needs them.
+    wf::signal::connection_t<wf::view_title_changed_signal> _title_changed =
+        [=] (wf::view_title_changed_signal *ev)
+    {
+        if (ev->view->get_output() == output)
+        {
+            apply("title-changed", ev->view);
+        }
+    };
+
+    wf::signal::connection_t<wf::view_app_id_changed_signal> _app_id_changed =
+        [=] (wf::view_app_id_changed_signal *ev)
+    {
+        if (ev->view->get_output() == output)
+        {
+            apply("app-id-changed", ev->view);
+        }
+    };
+
+    // Reindex the lambda rules as soon as they change, so that the title and
+    // app-id listeners are connected before the first such change.
+    wf::signal::connection_t<wf::lambda_rules_changed_signal> _lambda_rules_changed =
+        [=] (wf::lambda_rules_changed_signal *ev)
+    {
+        update_lambda_index();
+    };
+
     // Auto-reload on changes to config file
     wf::signal::connection_t<wf::reload_config_signal> _reload_config = [=] (wf::reload_config_signal *ev)
     {
-        setup_rules_from_config();
+        if (ev->diff.section_changed("window-rules"))
+        {
+            setup_rules_from_config();
+        }
+    };
+
+    /**
+     * Rules indexed by the signal they react to. Rules whose signal could not be
+     * determined from their text are kept under the empty key and tried on
+     * every signal.
+     */
+    struct indexed_rule_t
+    {
+        std::shared_ptr<wf::rule_t> rule;
+        /** The view properties the rule's condition references. */
+        std::set<std::string> properties;
+    };
+
+    std::map<std::string, std::vector<indexed_rule_t>> _rules;
+
+    struct indexed_lambda_t
+    {
+        std::string key;
+        std::shared_ptr<wf::lambda_rule_registration_t> registration;
+        std::set<std::string> properties;
     };
 
-    std::vector<std::shared_ptr<wf::rule_t>> _rules;
+    /** Lambda rules indexed like _rules, rebuilt when the registrations change. */
+    std::map<std::string, std::vector<indexed_lambda_t>> _lambda_rules;
+    uint64_t _lambda_generation = (uint64_t)-1;
+
+    /** The view properties referenced by the config rules on each signal. */
+    std::map<std::string, std::set<std::string>> _config_properties;
 
     wf::view_access_interface_t _access_interface;
     wf::view_action_interface_t _action_interface;
 
     nonstd::observer_ptr<wf::lambda_rules_registrations_t> _lambda_registrations;
+    wf::shared_data::ref_ptr_t<wf::window_rules::stats_t> _stats;
 };
 
 void wayfire_window_rules_t::init()
@@ -82,10 +303,15 @@ void wayfire_window_rules_t::init()
     output->connect(&_minimized);
     output->connect(&_fullscreened);
     wf::get_core().connect(&_reload_config);
+    wf::get_core().connect(&_lambda_rules_changed);
 }
 
 void wayfire_window_rules_t::fini()
 {
+    _title_changed.disconnect();
+    _app_id_changed.disconnect();
+    _lambda_rules_changed.disconnect();
+    _lambda_rules.clear();
     _lambda_registrations->window_rule_instances--;
     if (_lambda_registrations->window_rule_instances == 0)
     {
@@ -112,87 +338,193 @@ void wayfire_window_rules_t::apply(const std::string & signal, wayfire_view view
         return;
     }
 
-    for (const auto & rule : _rules)
+    update_lambda_index();
+    _stats->count_signal();
+
+    // On a property change, rules which are not indexed under the signal and
+    // do not look at the property are skipped. Rules registered on the signal
+    // and rules without a condition are always applied.
+    auto changed = wf::window_rules::property_signals.find(signal);
+    auto affected = [&] (const std::string& key, const std::set<std::string>& properties)
     {
-        _access_interface.set_view(view);
-        _action_interface.set_view(view);
-        auto error = rule->apply(signal, _access_interface, _action_interface);
-        if (error)
+        if ((key == signal) || (changed == wf::window_rules::property_signals.end()) ||
+            properties.empty() || properties.count(changed->second))
         {
-            LOGE("Window-rules: Error while executing rule on ", signal, " signal.");
+            return true;
         }
-    }
 
-    auto bounds = _lambda_registrations->rules();
-    auto begin  = std::get<0>(bounds);
-    auto end    = std::get<1>(bounds);
-    while (begin != end)
+        ++_stats->skipped;
+        return false;
+    };
+
+    // Rules are indexed by their signal, so only rules which can react to this
+    // signal (and the few whose signal is unknown) are evaluated.
+    for (const auto& key : {signal, std::string{}})
     {
-        auto registration = std::get<1>(*begin);
-        bool error = false;
+        auto it = _rules.find(key);
+        if (it == _rules.end())
+        {
+            continue;
+        }
 
-        // Assume we will use the view access interface.
         _access_interface.set_view(view);
-        wf::access_interface_t & access_iface = _access_interface;
-
-        // If a custom access interface is set in the regoistration, use this one.
-        if (registration->access_interface != nullptr)
+        _action_interface.set_view(view);
+        for (const auto & entry : it->second)
         {
-            access_iface = *registration->access_interface;
+            if (!affected(key, entry.properties))
+            {
+                continue;
+            }
+
+            _stats->count_evaluation(signal);
+            auto error = entry.rule->apply(signal, _access_interface, _action_interface);
+            if (error)
+            {
+                LOGE("Window-rules: Error while executing rule on ", signal, " signal.");
+            }
         }
+    }
 
-        // Load if lambda wrapper.
-        if (registration->if_lambda != nullptr)
+    for (const auto& key : {signal, std::string{}})
+    {
+        auto it = _lambda_rules.find(key);
+        if (it == _lambda_rules.end())
         {
-            registration->rule_instance->setIfLambda(
-                [registration, signal, view] () -> bool
-            {
-                return registration->if_lambda(signal, view);
-            });
+            continue;
         }
 
-        // Load else lambda wrapper.
-        if (registration->else_lambda)
+        // Copy, a lambda may register or unregister other lambda rules.
+        auto matching = it->second;
+        for (auto& entry : matching)
         {
-            registration->rule_instance->setElseLambda(
-                [registration, signal, view] () -> bool
+            if (!affected(key, entry.properties))
             {
-                return registration->else_lambda(signal, view);
-            });
-        }
+                continue;
+            }
 
-        // Run the lambda rule.
-        error = registration->rule_instance->apply(signal, _access_interface);
+            auto& registration = entry.registration;
 
-        // Unload wrappers.
-        registration->rule_instance->setIfLambda(nullptr);
-        registration->rule_instance->setElseLambda(nullptr);
+            // Use the view access interface unless the registration has a
+            // custom one.
+            _access_interface.set_view(view);
+            wf::access_interface_t *access_iface = &_access_interface;
+            if (registration->access_interface != nullptr)
+            {
+                access_iface = registration->access_interface.get();
+            }
 
-        if (error)
-        {
-            LOGE("Window-rules: Error while executing rule on signal: ", signal,
-                ", rule text:", registration->rule);
+            registration->current_signal = signal;
+            registration->current_view   = view;
+
+            _stats->count_evaluation(signal);
+            bool error = registration->rule_instance->apply(signal, *access_iface);
+
+            registration->current_view = nullptr;
+            if (error)
+            {
+                LOGE("Window-rules: Error while executing rule on signal: ", signal,
+                    ", rule text:", registration->rule);
+            }
         }
+    }
+}
 
-        ++begin;
+void wayfire_window_rules_t::update_lambda_index()
+{
+    if (_lambda_generation == _lambda_registrations->generation())
+    {
+        return;
+    }
+
+    _lambda_generation = _lambda_registrations->generation();
+    _lambda_rules.clear();
+
+    auto properties = _config_properties;
+    auto bounds     = _lambda_registrations->rules();
+    for (auto it = std::get<0>(bounds); it != std::get<1>(bounds); ++it)
+    {
+        auto info = wf::window_rules::scan_rule(it->second->rule);
+        _lambda_rules[info.signal].push_back({it->first, it->second, info.properties});
+        properties[info.signal].insert(info.properties.begin(), info.properties.end());
+    }
+
+    _stats->signal_properties = std::move(properties);
+    update_property_listeners();
+}
+
+void wayfire_window_rules_t::update_property_listeners()
+{
+    auto needs_signal = [&] (const std::string& signal)
+    {
+        // Rules with an unknown signal may react to any signal.
+        return _rules.count(signal) || _lambda_rules.count(signal) ||
+               _rules.count("") || _lambda_rules.count("");
+    };
+
+    _title_changed.disconnect();
+    if (needs_signal("title-changed"))
+    {
+        wf::get_core().connect(&_title_changed);
+    }
+
+    _app_id_changed.disconnect();
+    if (needs_signal("app-id-changed"))
+    {
+        wf::get_core().connect(&_app_id_changed);
     }
 }
 
 void wayfire_window_rules_t::setup_rules_from_config()
 {
     _rules.clear();
+    _config_properties.clear();
 
     // Build rule list.
     auto section = wf::get_core().config.get_section("window-rules");
     for (auto opt : section->get_registered_options())
     {
-        _lexer.reset(opt->get_value_str());
+        auto text = opt->get_value_str();
+        _lexer.reset(text);
         auto rule = wf::rule_parser_t().parse(_lexer);
         if (rule != nullptr)
         {
-            _rules.push_back(rule);
+            auto info = wf::window_rules::scan_rule(text);
+            _rules[info.signal].push_back({rule, info.properties});
+            _config_properties[info.signal].insert(
+                info.properties.begin(), info.properties.end());
         }
     }
+
+    // Force the lambda rules to be reindexed as well.
+    _lambda_generation = (uint64_t)-1;
+    update_lambda_index();
 }
 
-DECLARE_WAYFIRE_PLUGIN(wf::per_output_plugin_t<wayfire_window_rules_t>);
+class wayfire_window_rules_plugin_t : public wf::per_output_plugin_t<wayfire_window_rules_t>
+{
+  public:
+    void init() override
+    {
+        per_output_plugin_t::init();
+        method_repository->register_method("window-rules/stats", get_stats);
+    }
+
+    void fini() override
+    {
+        method_repository->unregister_method("window-rules/stats");
+        per_output_plugin_t::fini();
+    }
+
+  private:
+    wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
+    wf::shared_data::ref_ptr_t<wf::window_rules::stats_t> stats;
+
+    wf::ipc::method_callback get_stats = [=] (nlohmann::json)
+    {
+        auto response = wf::ipc::json_ok();
+        response["stats"] = stats->to_json();
+        return response;
+    };
+};
+
+DECLARE_WAYFIRE_PLUGIN(wayfire_window_rules_plugin_t);
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <wayfire/geometry.hpp>
+#include <cstdint>
+#include <vector>
+
+extern "C"
+{
+#include "wobbly.h"
+}
+
+/**
+ * CPU-side mesh generation for the wobbly model. It does not use OpenGL, so
+ * that it can be benchmarked and tested on its own.
+ */
+namespace wobbly_mesh
+{
+/**
+ * Enumerate the needed triangles for rendering the model, with positions
+ * taken from the vertices computed by wobbly_add_geometry().
+ *
+ * Used when the mesh is evaluated on the CPU.
+ */
+inline void prepare_geometry(wobbly_surface *model, wf::geometry_t src_box,
+    std::vector<float>& vert, std::vector<float>& uv)
+{
+    float x = src_box.x, y = src_box.y, w = src_box.width, h = src_box.height;
+    std::vector<int> idx;
+
+    int per_row = model->x_cells + 1;
+
+    for (int j = 0; j < model->y_cells; j++)
+    {
+        for (int i = 0; i < model->x_cells; i++)
+        {
+            idx.push_back(i * per_row + j);
+            idx.push_back((i + 1) * per_row + j + 1);
+            idx.push_back(i * per_row + j + 1);
+
+            idx.push_back(i * per_row + j);
+            idx.push_back((i + 1) * per_row + j);
+            idx.push_back((i + 1) * per_row + j + 1);
+        }
+    }
+
+    if (!model->v || !model->uv)
+    {
+        for (auto id : idx)
+        {
+            float tile_w = w / model->x_cells;
+            float tile_h = h / model->y_cells;
+
+            int i = id / per_row;
+            int j = id % per_row;
+
+            vert.push_back(i * tile_w + x);
+            vert.push_back(j * tile_h + y);
+
+            uv.push_back(1.0f * i / model->x_cells);
+            uv.push_back(1.0f - 1.0f * j / model->y_cells);
+        }
+    } else
+    {
+        for (auto i : idx)
+        {
+            vert.push_back(model->v[2 * i]);
+            vert.push_back(model->v[2 * i + 1]);
+
+            uv.push_back(model->uv[2 * i]);
+            uv.push_back(model->uv[2 * i + 1]);
+        }
+    }
+}
+
+/**
+ * Generate the static part of the mesh for the given grid resolution: the
+ * patch parameters (u, v) in [0, 1] of each grid vertex and the indices of the
+ * triangles. It only depends on the resolution, so it can be built once and
+ * kept on the GPU, where the bezier patch is evaluated for each vertex.
+ *
+ * The triangles are the same as the ones from prepare_geometry().
+ */
+inline void build_grid_mesh(int x_cells, int y_cells,
+    std::vector<float>& params, std::vector<uint16_t>& indices)
+{
+    const int iw = x_cells + 1;
+    const int ih = y_cells + 1;
+
+    params.clear();
+    params.reserve(2 * iw * ih);
+    for (int j = 0; j < ih; j++)
+    {
+        for (int i = 0; i < iw; i++)
+        {
+            params.push_back(1.0f * i / x_cells);
+            params.push_back(1.0f * j / y_cells);
+        }
+    }
+
+    indices.clear();
+    indices.reserve(6 * x_cells * y_cells);
+    for (int j = 0; j < y_cells; j++)
+    {
+        for (int i = 0; i < x_cells; i++)
+        {
+            const uint16_t tl = j * iw + i;
+            const uint16_t tr = j * iw + i + 1;
+            const uint16_t bl = (j + 1) * iw + i;
+            const uint16_t br = (j + 1) * iw + i + 1;
+
+            indices.insert(indices.end(), {tl, br, bl, tl, tr, br});
+        }
+    }
+}
+
+/**
+ * Get the control points of the bezier patch to be uploaded for the current
+ * frame. If the model is not wobbling, the control points are spread evenly
+ * over @src_box, which makes the patch exactly the rectangle.
+ */
+inline void get_control_points(wobbly_surface *model, wf::geometry_t src_box,
+    float points[2 * WOBBLY_CONTROL_POINTS])
+{
+    if (wobbly_get_control_points(model, points))
+    {
+        return;
+    }
+
+    for (int j = 0; j < 4; j++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            points[2 * (j * 4 + i)]     = src_box.x + src_box.width * i / 3.0f;
+            points[2 * (j * 4 + i) + 1] = src_box.y + src_box.height * j / 3.0f;
+        }
+    }
+}
+
+/** The largest grid resolution which can be indexed with 16-bit indices. */
+static constexpr int MAX_GPU_GRID_CELLS = 254;
+}
@@ -593,6 +593,23 @@ void wobbly_add_geometry(struct wobbly_surface *surface)
     }
 }
 
+int wobbly_get_control_points(struct wobbly_surface *surface, float *points)
+{
+    WobblyWindow *ww = surface->ww;
+    int i;
+
+    if (!ww->wobbly || !ww->model)
+        return 0;
+
+    for (i = 0; i < GRID_WIDTH * GRID_HEIGHT; i++)
+    {
+        *points++ = ww->model->objects[i].position.x;
+        *points++ = ww->model->objects[i].position.y;
+    }
+
+    return 1;
+}
+
 void wobbly_resize(struct wobbly_surface *surface, int width, int height)
 {
     WobblyWindow *ww = surface->ww;
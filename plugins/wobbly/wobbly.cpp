@@ -1,6 +1,7 @@
 #include "wayfire/debug.hpp"
 #include "wayfire/opengl.hpp"
 #include "wayfire/region.hpp"
+#include <map>
 #include <memory>
 #include <wayfire/per-output-plugin.hpp>
 #include <wayfire/signal-definitions.hpp>
@@ -10,11 +11,7 @@
 #include <wayfire/render-manager.hpp>
 #include <wayfire/plugins/common/util.hpp>
 
-extern "C"
-{
-#include "wobbly.h"
-}
-
+#include "wobbly-mesh.hpp"
 #include "wayfire/plugins/wobbly/wobbly-signal.hpp"
 
 namespace wobbly_graphics
@@ -48,11 +45,54 @@ void main()
     gl_FragColor = get_pixel(uvpos);
 }
 )";
+
+/* Evaluates the bezier patch for each vertex of the static grid mesh. */
+const char *gpu_vertex_source =
+    R"(
+#version 100
+attribute highp vec2 patchPosition;
+varying highp vec2 uvpos;
+uniform mat4 MVP;
+uniform highp vec2 control[16];
+
+highp vec4 bernstein(highp float t)
+{
+    highp float s = 1.0 - t;
+    return vec4(s * s * s, 3.0 * t * s * s, 3.0 * t * t * s, t * t * t);
+}
+
+highp vec2 patch_row(int j, highp vec4 b)
+{
+    return b.x * control[j * 4] + b.y * control[j * 4 + 1] +
+        b.z * control[j * 4 + 2] + b.w * control[j * 4 + 3];
+}
+
+void main() {
+    highp vec4 bu = bernstein(patchPosition.x);
+    highp vec4 bv = bernstein(patchPosition.y);
+    highp vec2 position = bv.x * patch_row(0, bu) + bv.y * patch_row(1, bu) +
+        bv.z * patch_row(2, bu) + bv.w * patch_row(3, bu);
+
+    gl_Position = MVP * vec4(position, 0.0, 1.0);
+    uvpos = vec2(patchPosition.x, 1.0 - patchPosition.y);
+}
+)";
 }
 
 OpenGL::program_t program;
+OpenGL::program_t gpu_program;
 int times_loaded = 0;
 
+/** The static part of the mesh for a grid resolution, stored on the GPU. */
+struct gpu_mesh_t
+{
+    GLuint vbo = 0;
+    GLuint ibo = 0;
+    int index_count = 0;
+};
+
+std::map<std::pair<int, int>, gpu_mesh_t> gpu_meshes;
+
 void load_program()
 {
     if (times_loaded++ > 0)
@@ -62,6 +102,7 @@ void load_program()
 
     OpenGL::render_begin();
     program.compile(vertex_source, frag_source);
+    gpu_program.compile(gpu_vertex_source, frag_source);
     OpenGL::render_end();
 }
 
@@ -71,62 +112,71 @@ void destroy_program()
     {
         OpenGL::render_begin();
         program.free_resources();
+        gpu_program.free_resources();
+        for (auto& [resolution, mesh] : gpu_meshes)
+        {
+            GL_CALL(glDeleteBuffers(1, &mesh.vbo));
+            GL_CALL(glDeleteBuffers(1, &mesh.ibo));
+        }
+
+        gpu_meshes.clear();
         OpenGL::render_end();
     }
 }
 
-/**
- * Enumerate the needed triangles for rendering the model
- */
-void prepare_geometry(wobbly_surface *model, wf::geometry_t src_box,
-    std::vector<float>& vert, std::vector<float>& uv)
+/* Requires bound opengl context */
+const gpu_mesh_t& get_gpu_mesh(int x_cells, int y_cells)
 {
-    float x = src_box.x, y = src_box.y, w = src_box.width, h = src_box.height;
-    std::vector<int> idx;
+    auto& mesh = gpu_meshes[{x_cells, y_cells}];
+    if (mesh.vbo)
+    {
+        return mesh;
+    }
 
-    int per_row = model->x_cells + 1;
+    std::vector<float> params;
+    std::vector<uint16_t> indices;
+    wobbly_mesh::build_grid_mesh(x_cells, y_cells, params, indices);
 
-    for (int j = 0; j < model->y_cells; j++)
-    {
-        for (int i = 0; i < model->x_cells; i++)
-        {
-            idx.push_back(i * per_row + j);
-            idx.push_back((i + 1) * per_row + j + 1);
-            idx.push_back(i * per_row + j + 1);
+    GL_CALL(glGenBuffers(1, &mesh.vbo));
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo));
+    GL_CALL(glBufferData(GL_ARRAY_BUFFER, params.size() * sizeof(float),
+        params.data(), GL_STATIC_DRAW));
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
 
-            idx.push_back(i * per_row + j);
-            idx.push_back((i + 1) * per_row + j);
-            idx.push_back((i + 1) * per_row + j + 1);
-        }
-    }
+    GL_CALL(glGenBuffers(1, &mesh.ibo));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo));
+    GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+        indices.data(), GL_STATIC_DRAW));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
-    if (!model->v || !model->uv)
-    {
-        for (auto id : idx)
-        {
-            float tile_w = w / model->x_cells;
-            float tile_h = h / model->y_cells;
+    mesh.index_count = indices.size();
+    return mesh;
+}
 
-            int i = id / per_row;
-            int j = id % per_row;
+/* Requires bound opengl context */
+void render_gpu_mesh(wf::texture_t tex, glm::mat4 mat, const gpu_mesh_t& mesh,
+    const float *control_points)
+{
+    gpu_program.use(tex.type);
+    gpu_program.set_active_texture(tex);
+    gpu_program.uniformMatrix4f("MVP", mat);
 
-            vert.push_back(i * tile_w + x);
-            vert.push_back(j * tile_h + y);
+    GLint loc = glGetUniformLocation(gpu_program.get_program_id(tex.type), "control");
+    GL_CALL(glUniform2fv(loc, WOBBLY_CONTROL_POINTS, control_points));
 
-            uv.push_back(1.0f * i / model->x_cells);
-            uv.push_back(1.0f - 1.0f * j / model->y_cells);
-        }
-    } else
-    {
-        for (auto i : idx)
-        {
-            vert.push_back(model->v[2 * i]);
-            vert.push_back(model->v[2 * i + 1]);
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo));
+    gpu_program.attrib_pointer("patchPosition", 2, 0, nullptr);
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo));
 
-            uv.push_back(model->uv[2 * i]);
-            uv.push_back(model->uv[2 * i + 1]);
-        }
-    }
+    GL_CALL(glEnable(GL_BLEND));
+    GL_CALL(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+
+    GL_CALL(glDrawElements(GL_TRIANGLES, mesh.index_count, GL_UNSIGNED_SHORT, nullptr));
+    GL_CALL(glDisable(GL_BLEND));
+
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    gpu_program.deactivate();
 }
 
 /* Requires bound opengl context */
@@ -155,6 +205,17 @@ namespace wobbly_settings
 wf::option_wrapper_t<double> friction{"wobbly/friction"};
 wf::option_wrapper_t<double> spring_k{"wobbly/spring_k"};
 wf::option_wrapper_t<int> resolution{"wobbly/grid_resolution"};
+wf::option_wrapper_t<bool> gpu_mesh{"wobbly/gpu_mesh"};
+
+/**
+ * @return Whether the model is rendered with the GPU mesh. Otherwise, its
+ *   vertices have to be computed on the CPU with wobbly_add_geometry().
+ */
+static bool uses_gpu_mesh(const wobbly_surface *model)
+{
+    return gpu_mesh &&
+           (std::max(model->x_cells, model->y_cells) <= wobbly_mesh::MAX_GPU_GRID_CELLS);
+}
 }
 
 extern "C"
@@ -265,7 +326,11 @@ class iwobbly_state_t
     virtual void translate_model(int dx, int dy)
     {
         wobbly_translate(model.get(), dx, dy);
-        wobbly_add_geometry(model.get());
+        if (!wobbly_settings::uses_gpu_mesh(model.get()))
+        {
+            wobbly_add_geometry(model.get());
+        }
+
         bounding_box.x += dx;
         bounding_box.y += dy;
         model->x += dx;
@@ -566,6 +631,15 @@ class wobbly_transformer_node_t : public wf::scene::floating_inner_node_t
 
         pre_hook = [=] () { update_model(); };
         view->get_output()->render->add_effect(&pre_hook, wf::OUTPUT_EFFECT_PRE);
+
+        // The CPU vertices are not kept up to date while the GPU mesh is used
+        gpu_mesh.set_callback([=] ()
+        {
+            if (!wobbly_settings::uses_gpu_mesh(model.get()))
+            {
+                wobbly_add_geometry(model.get());
+            }
+        });
         view->get_output()->connect(&on_workspace_changed);
 
         view->connect(&on_view_unmap);
@@ -621,6 +695,7 @@ class wobbly_transformer_node_t : public wf::scene::floating_inner_node_t
   private:
     wayfire_view view;
     wf::effect_hook_t pre_hook;
+    wf::option_wrapper_t<bool> gpu_mesh{"wobbly/gpu_mesh"};
 
     wf::signal::connection_t<wf::view_unmapped_signal> on_view_unmap = [=] (wf::view_unmapped_signal*)
     {
@@ -715,7 +790,11 @@ class wobbly_transformer_node_t : public wf::scene::floating_inner_node_t
 
         /* Update wobbly geometry */
         last_frame = now;
-        wobbly_add_geometry(model.get());
+        if (!wobbly_settings::uses_gpu_mesh(model.get()))
+        {
+            wobbly_add_geometry(model.get());
+        }
+
         wobbly_done_paint(model.get());
         view->damage();
 
@@ -885,11 +964,32 @@ class wobbly_render_instance_t :
     void render(const wf::render_target_t& target_fb,
         const wf::region_t& damage) override
     {
-        std::vector<float> vert, uv;
         auto subbox = self->get_children_bounding_box();
+        auto tex    = get_texture(target_fb.scale);
+        auto model  = self->model.get();
+
+        if (wobbly_settings::uses_gpu_mesh(model))
+        {
+            // Only the control points change between frames, the mesh itself
+            // stays on the GPU.
+            float control_points[2 * WOBBLY_CONTROL_POINTS];
+            wobbly_mesh::get_control_points(model, subbox, control_points);
+
+            OpenGL::render_begin(target_fb);
+            auto& mesh = wobbly_graphics::get_gpu_mesh(model->x_cells, model->y_cells);
+            for (auto& box : damage)
+            {
+                target_fb.logic_scissor(wlr_box_from_pixman_box(box));
+                wobbly_graphics::render_gpu_mesh(tex,
+                    target_fb.get_orthographic_projection(), mesh, control_points);
+            }
 
-        wobbly_graphics::prepare_geometry(self->model.get(), subbox, vert, uv);
-        auto tex = get_texture(target_fb.scale);
+            OpenGL::render_end();
+            return;
+        }
+
+        std::vector<float> vert, uv;
+        wobbly_mesh::prepare_geometry(model, subbox, vert, uv);
         OpenGL::render_begin(target_fb);
         for (auto& box : damage)
         {
@@ -50,6 +50,12 @@ void wobbly_move_notify(struct wobbly_surface *surface, int x, int y);
 void wobbly_prepare_paint(struct wobbly_surface *surface, int msSinceLastPaint);
 void wobbly_done_paint(struct wobbly_surface *surface);
 void wobbly_add_geometry(struct wobbly_surface *surface);
+
+/* The model is a bicubic bezier patch with 4x4 control points. Stores the
+ * control points (row-major, as x, y pairs, 32 floats in total) and returns 1
+ * if the surface is wobbling, otherwise returns 0. */
+#define WOBBLY_CONTROL_POINTS 16
+int  wobbly_get_control_points(struct wobbly_surface *surface, float *points);
 struct wobbly_rect wobbly_boundingbox(struct wobbly_surface *surface);
 
 void wobbly_force_geometry(struct wobbly_surface *surface,
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace wf
+{
+/**
+ * A handle to an animation registered with an animation_timeline_t.
+ */
+struct timeline_animation_id_t
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator ==(const timeline_animation_id_t& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator !=(const timeline_animation_id_t& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * A timeline which advances all animations of an output in a single pass.
+ *
+ * Each output has a timeline (see render_manager::get_animation_timeline()),
+ * which is ticked once per frame, before the OUTPUT_EFFECT_PRE hooks. The
+ * animations receive the time at which the frame is predicted to be
+ * presented, so that all of them show the same point in time and stay in
+ * step with the display instead of with the time their hook happened to run.
+ *
+ * Adding and removing animations take constant time. Animations may be added
+ * and removed while the timeline is ticking, including the animation whose
+ * callback is currently running. Animations added during a tick first run
+ * on the next tick.
+ */
+class animation_timeline_t
+{
+  public:
+    /**
+     * The callback of an animation.
+     *
+     * @param target_us The predicted presentation time of the frame, in
+     *   microseconds of CLOCK_MONOTONIC.
+     * @return Whether the animation is still running. Finished animations are
+     *   removed from the timeline.
+     */
+    using tick_callback_t = std::function<bool (int64_t target_us)>;
+
+    /** A clock returning the current time in microseconds. */
+    using clock_t = std::function<int64_t()>;
+
+    /**
+     * Create a new timeline. The clock is used only to measure the cost of
+     * ticks, it defaults to CLOCK_MONOTONIC.
+     */
+    animation_timeline_t(clock_t clock = nullptr);
+
+    animation_timeline_t(const animation_timeline_t&) = delete;
+    animation_timeline_t& operator =(const animation_timeline_t&) = delete;
+
+    /** Register an animation, which will run starting from the next tick. */
+    timeline_animation_id_t add(tick_callback_t callback);
+
+    /** Remove an animation. No-op if it has already finished. */
+    void remove(timeline_animation_id_t id);
+
+    /** @return Whether the animation is registered and has not finished. */
+    bool contains(timeline_animation_id_t id) const;
+
+    /** @return The number of running animations. */
+    size_t size() const;
+
+    /** Run all animations for a frame presented at @param target_us. */
+    void tick(int64_t target_us);
+
+    struct stats_t
+    {
+        /** Number of ticks with at least one animation. */
+        uint64_t ticks = 0;
+        /** Number of animation callbacks run. */
+        uint64_t animations_ticked = 0;
+        /** The cost of the last tick, and of all ticks together. */
+        int64_t last_tick_us  = 0;
+        int64_t total_tick_us = 0;
+        int64_t max_tick_us   = 0;
+    };
+
+    const stats_t& get_stats() const
+    {
+        return stats;
+    }
+
+    /**
+     * Predict when a frame started at @param now_us will be presented, from
+     * the time the last frame was presented and the refresh interval. Without
+     * a refresh interval, the frame is assumed to be presented immediately.
+     */
+    static int64_t predict_presentation(int64_t now_us, int64_t last_present_us,
+        int64_t refresh_us);
+
+  private:
+    struct slot_t
+    {
+        tick_callback_t callback;
+        uint32_t generation = 0;
+        /* Position in the list of running animations, or UINT32_MAX */
+        uint32_t position   = UINT32_MAX;
+        bool removed = false;
+    };
+
+    /* A deque, so that callbacks stay in place while they run, even if they
+     * add new animations */
+    std::deque<slot_t> slots;
+    std::vector<uint32_t> free_slots;
+    /* The slots of the running animations */
+    std::vector<uint32_t> running;
+    /* Slots removed during the current tick, released after it */
+    std::vector<uint32_t> removed_during_tick;
+    bool ticking = false;
+
+    clock_t clock;
+    stats_t stats;
+
+    void release(uint32_t slot);
+};
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <wayfire/config/config-manager.hpp>
+#include <map>
+#include <set>
+#include <string>
+
+namespace wf
+{
+/**
+ * The values of all options of a configuration, as strings, indexed by
+ * section and option name.
+ */
+using config_snapshot_t = std::map<std::string, std::map<std::string, std::string>>;
+
+/** Record the current values of all options in @param config. */
+config_snapshot_t take_config_snapshot(const wf::config::config_manager_t& config);
+
+/**
+ * The changes between two states of the configuration.
+ */
+struct config_diff_t
+{
+    /**
+     * Whether the diff is known. Config backends which do not compute a diff
+     * leave it false, and then everything is considered changed.
+     */
+    bool complete = false;
+
+    /** Full names (section/option) of options which were added, removed or
+     * whose value changed. */
+    std::set<std::string> changed_options;
+    /** Sections which were added, removed, or have a changed option. */
+    std::set<std::string> changed_sections;
+    std::set<std::string> added_sections;
+    std::set<std::string> removed_sections;
+
+    /** @return Whether nothing changed. */
+    bool empty() const
+    {
+        return complete && changed_sections.empty();
+    }
+
+    /** @return Whether the option with the given full name (section/option)
+     *   might have changed. */
+    bool option_changed(const std::string& name) const
+    {
+        return !complete || changed_options.count(name);
+    }
+
+    /** @return Whether anything in the given section might have changed. */
+    bool section_changed(const std::string& section) const
+    {
+        return !complete || changed_sections.count(section);
+    }
+
+    /**
+     * @return Whether anything might have changed in a section whose name
+     *   starts with @param prefix, for example "output:".
+     */
+    bool section_with_prefix_changed(const std::string& prefix) const
+    {
+        if (!complete)
+        {
+            return true;
+        }
+
+        auto it = changed_sections.lower_bound(prefix);
+        return it != changed_sections.end() && it->compare(0, prefix.size(), prefix) == 0;
+    }
+};
+
+/** Compute the changes needed to go from @param before to @param after. */
+config_diff_t compute_config_diff(const config_snapshot_t& before,
+    const config_snapshot_t& after);
+}
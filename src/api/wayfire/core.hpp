@@ -25,6 +25,7 @@ class view_interface_t;
 namespace scene
 {
 class root_node_t;
+class scene_profiler_t;
 }
 
 namespace touch
@@ -43,6 +44,53 @@ class output_layout_t;
 class input_device_t;
 class bindings_repository_t;
 class seat_t;
+class view_registry_t;
+class snapshot_pool_t;
+class memory_accounting_t;
+
+/** The time it took to load a single plugin. */
+struct plugin_load_time_t
+{
+    /** The path of the plugin, or the name of a built-in plugin. */
+    std::string name;
+    /** Time spent opening the plugin file and resolving its symbols. */
+    int64_t load_us;
+    /** Time spent creating the plugin instance. */
+    int64_t create_us;
+    /** Time spent in the plugin's init(). */
+    int64_t init_us;
+};
+
+/**
+ * Timestamps of the compositor startup, in microseconds of CLOCK_MONOTONIC,
+ * and the load times of the currently loaded plugins.
+ */
+struct startup_profile_t
+{
+    /** When core started to initialize. */
+    int64_t init_start_us = 0;
+    /** When the plugins started to load. */
+    int64_t plugins_start_us = 0;
+    /** When all plugins were initialized. */
+    int64_t plugins_done_us = 0;
+    /** When the startup was finished, right before the main loop starts. */
+    int64_t startup_finished_us = 0;
+
+    std::vector<plugin_load_time_t> plugins;
+};
+
+/**
+ * Counters of the pointer motion processing, see input/coalesce_pointer_motion.
+ */
+struct pointer_motion_stats_t
+{
+    /** Motion events received from the pointing devices. */
+    uint64_t motion_events = 0;
+    /** Lookups of the node under the cursor. */
+    uint64_t hit_tests = 0;
+    /** Batches of coalesced motion events which were processed. */
+    uint64_t flushes = 0;
+};
 
 /** Describes the state of the compositor */
 enum class compositor_state_t
@@ -101,6 +149,29 @@ class compositor_core_t : public wf::object_base_t, public signal::provider_t
     std::unique_ptr<wf::bindings_repository_t> bindings;
     std::unique_ptr<wf::seat_t> seat;
 
+    /**
+     * The registry of all views, with constant-time lookup by id and indices
+     * by app-id, output and role. See wayfire/view-registry.hpp.
+     */
+    std::unique_ptr<wf::view_registry_t> view_registry;
+
+    /**
+     * The memory held by the different parts of the compositor, see
+     * wayfire/memory-accounting.hpp.
+     */
+    std::unique_ptr<wf::memory_accounting_t> memory_accounting;
+
+    /**
+     * Per-node damage and render timings, for debugging. Disabled by default,
+     * see wayfire/scene-profiler.hpp.
+     */
+    std::unique_ptr<wf::scene::scene_profiler_t> scene_profiler;
+
+    /**
+     * The pool of buffers for view snapshots, see wayfire/snapshot-pool.hpp.
+     */
+    std::unique_ptr<wf::snapshot_pool_t> snapshot_pool;
+
     /**
      * Various protocols supported by wlroots
      */
@@ -294,6 +365,9 @@ class compositor_core_t : public wf::object_base_t, public signal::provider_t
      * This also sets some environment variables for the new process, including
      * correct WAYLAND_DISPLAY and DISPLAY.
      *
+     * The process is started with posix_spawn() and does not block the event
+     * loop. It is reaped by core when it exits.
+     *
      * @return The PID of the started client, or -1 on failure.
      */
     virtual pid_t run(std::string command) = 0;
@@ -310,6 +384,16 @@ class compositor_core_t : public wf::object_base_t, public signal::provider_t
      */
     virtual void shutdown() = 0;
 
+    /**
+     * @return Timing information about the startup of the compositor.
+     */
+    virtual startup_profile_t get_startup_profile() = 0;
+
+    /**
+     * @return Counters of the pointer motion processing since startup.
+     */
+    virtual pointer_motion_stats_t get_pointer_motion_stats() = 0;
+
     /**
      * Get the root node of Wayfire's scenegraph.
      */
@@ -68,6 +68,8 @@ enum class logging_category : size_t
     WLR     = 3,
     // Direct scanout
     SCANOUT = 4,
+    // Cached view lists, checked against the scenegraph on each query
+    VIEWS   = 5,
     TOTAL,
 };
 
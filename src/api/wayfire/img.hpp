@@ -2,6 +2,7 @@
 #define IMG_HPP_
 
 #include <wayfire/opengl.hpp>
+#include <functional>
 #include <string>
 
 namespace image_io
@@ -17,8 +18,34 @@ void write_to_file(std::string name, uint8_t *pixels, int w, int h,
 
 void write_to_file(std::string name, wf::framebuffer_t buffer);
 
+/* The result of an asynchronous capture, see write_to_file_async() */
+struct capture_result_t
+{
+    /* Whether the image was written successfully */
+    bool success = false;
+    /* Time the capture blocked the main thread, in microseconds */
+    int64_t main_thread_us = 0;
+    /* Time from the start of the capture until the file was written */
+    int64_t total_us = 0;
+};
+
+using capture_callback_t = std::function<void (const capture_result_t&)>;
+
+/* Save the contents of the framebuffer to a file without stalling the main
+ * thread. The pixels are read back into a pixel buffer object, copied out
+ * once the GPU has finished, and encoded on a worker thread.
+ *
+ * The framebuffer may be reused as soon as the function returns. on_done, if
+ * set, is called on the main thread once the file has been written. */
+void write_to_file_async(std::string name, wf::framebuffer_t buffer,
+    capture_callback_t on_done, std::string type = "png");
+
 /* Initializes all backends, called at startup */
 void init();
+
+/* Waits for the asynchronous captures which are being written, called at
+ * shutdown while the event loop and the renderer are still alive */
+void fini();
 }
 
 #endif /* end of include guard: IMG_HPP_ */
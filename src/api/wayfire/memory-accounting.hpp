@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <wayfire/util.hpp>
+
+namespace wf
+{
+/**
+ * Who holds a tracked allocation.
+ */
+struct memory_tag_t
+{
+    /** The plugin which owns the allocation, or "core". */
+    std::string owner = "core";
+    /** What the memory is used for, for example "blur buffer". */
+    std::string purpose;
+    /** The scenegraph node the allocation belongs to, if any. */
+    std::string node;
+
+    bool operator <(const memory_tag_t& other) const
+    {
+        return std::tie(owner, purpose, node) < std::tie(other.owner, other.purpose, other.node);
+    }
+};
+
+/** The kind of memory of an allocation, which also scopes its key. */
+enum class memory_kind_t
+{
+    /** GPU textures, the key is the GL texture name. */
+    GL_TEXTURE,
+    /** CPU memory, the key is usually the address of the allocation. */
+    CPU,
+};
+
+/**
+ * Keeps track of the memory held by the different parts of the compositor.
+ *
+ * Allocations are identified by their kind and a key, and tagged with the
+ * owner which allocated them. wf::framebuffer_t tracks its textures
+ * automatically, using the tag of the innermost memory_tag_scope_t which is
+ * active when it is allocated, and an untagged "core" tag otherwise.
+ *
+ * Owners can have soft budgets. When the live memory of an owner grows over
+ * its budget, memory_budget_exceeded_signal is emitted on core, so that
+ * caches can be dropped. Nothing is freed by the accounting itself.
+ *
+ * Allocations are usually tracked in the middle of rendering, so the signal
+ * is emitted only the next time the event loop is idle, when the handlers
+ * can safely free GL resources.
+ *
+ * The instance of the compositor is wf::get_core().memory_accounting.
+ */
+class memory_accounting_t
+{
+  public:
+    /**
+     * Start tracking an allocation, or update its size and tag if it is
+     * already tracked.
+     */
+    void track(memory_kind_t kind, uint64_t key, size_t bytes, const memory_tag_t& tag);
+
+    /** Same as track(), with the tag of the current memory_tag_scope_t. */
+    void track(memory_kind_t kind, uint64_t key, size_t bytes);
+
+    /** Stop tracking an allocation. No-op if it is not tracked. */
+    void untrack(memory_kind_t kind, uint64_t key);
+
+    /** @return The tag of the innermost active memory_tag_scope_t. */
+    const memory_tag_t& current_tag() const;
+
+    struct usage_t
+    {
+        size_t live_bytes = 0;
+        size_t peak_bytes = 0;
+        size_t allocations = 0;
+    };
+
+    /** @return The usage for each tag which was used so far. */
+    const std::map<memory_tag_t, usage_t>& get_usage_by_tag() const
+    {
+        return by_tag;
+    }
+
+    /** @return The usage for each owner. */
+    const std::map<std::string, usage_t>& get_usage_by_owner() const
+    {
+        return by_owner;
+    }
+
+    /** @return The usage of all owners together. */
+    const usage_t& get_total_usage() const
+    {
+        return total;
+    }
+
+    /**
+     * Set the soft budget of an owner, in bytes. A budget of 0 removes it.
+     * If the owner is already over the new budget, the signal is emitted.
+     */
+    void set_budget(const std::string& owner, size_t bytes);
+
+    /** @return The budgets of all owners which have one. */
+    const std::map<std::string, size_t>& get_budgets() const
+    {
+        return budgets;
+    }
+
+  private:
+    friend class memory_tag_scope_t;
+
+    struct allocation_t
+    {
+        memory_tag_t tag;
+        size_t bytes;
+    };
+
+    std::map<std::pair<memory_kind_t, uint64_t>, allocation_t> allocations;
+    std::map<memory_tag_t, usage_t> by_tag;
+    std::map<std::string, usage_t> by_owner;
+    usage_t total;
+
+    std::map<std::string, size_t> budgets;
+    /* Owners which are over their budget and were already reported. */
+    std::set<std::string> over_budget;
+    /* Owners which went over their budget since the last idle report. */
+    std::set<std::string> pending_reports;
+    wf::wl_idle_call idle_report;
+
+    std::vector<const memory_tag_t*> scopes;
+
+    void add(const memory_tag_t& tag, size_t bytes);
+    void remove(const memory_tag_t& tag, size_t bytes);
+    void check_budget(const std::string& owner);
+    void report_over_budget();
+};
+
+/**
+ * Tags the allocations done while the scope is active, which are not tagged
+ * explicitly, for example those of wf::framebuffer_t::allocate().
+ *
+ * The tag is not copied, so that scopes are cheap enough to be used on every
+ * frame. It must outlive the scope, usually it is a static constant.
+ */
+class memory_tag_scope_t
+{
+  public:
+    /** Tag the allocations tracked by the accounting of core. */
+    memory_tag_scope_t(const memory_tag_t& tag);
+    memory_tag_scope_t(memory_accounting_t& accounting, const memory_tag_t& tag);
+    ~memory_tag_scope_t();
+
+    memory_tag_scope_t(const memory_tag_scope_t&) = delete;
+    memory_tag_scope_t& operator =(const memory_tag_scope_t&) = delete;
+
+  private:
+    memory_accounting_t *accounting;
+};
+
+/**
+ * on: core
+ * when: The live memory of an owner grows over its soft budget. Emitted once
+ *   each time the budget is exceeded, from an idle callback after the
+ *   allocation, and only if the owner is still over its budget then.
+ */
+struct memory_budget_exceeded_signal
+{
+    std::string owner;
+    size_t live_bytes;
+    size_t budget;
+};
+}
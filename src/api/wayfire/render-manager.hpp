@@ -3,6 +3,7 @@
 #include <wayfire/output.hpp>
 #include <wayfire/object.hpp>
 #include <wayfire/region.hpp>
+#include <wayfire/animation-timeline.hpp>
 
 namespace wf
 {
@@ -102,6 +103,12 @@ class render_manager
      */
     void rem_effect(effect_hook_t *hook);
 
+    /**
+     * @return The animation timeline of the output. It is ticked at the start
+     * of each frame, before the OUTPUT_EFFECT_PRE hooks.
+     */
+    animation_timeline_t& get_animation_timeline();
+
     /**
      * Add a new post hook.
      *
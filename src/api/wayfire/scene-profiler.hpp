@@ -0,0 +1,116 @@
+#pragma once
+
+#include <wayfire/scene.hpp>
+#include <wayfire/scene-render.hpp>
+#include <wayfire/geometry.hpp>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+namespace wf
+{
+namespace scene
+{
+/**
+ * What the scene profiler recorded for a single node.
+ */
+struct node_profile_t
+{
+    /** The damage a node emitted before a render pass. */
+    struct damage_record_t
+    {
+        /** The number of the render pass the damage was emitted before. */
+        uint64_t pass;
+        wf::region_t region;
+    };
+
+    std::weak_ptr<node_t> node;
+    /** The damage of the last render passes, oldest first. */
+    std::deque<damage_record_t> damage;
+
+    /** The number of live render instances generated for the node. */
+    size_t render_instances = 0;
+
+    /**
+     * The CPU time spent in schedule_instructions() and render() of the
+     * render instances of the node, including their children.
+     */
+    uint64_t schedule_calls = 0;
+    int64_t schedule_ns     = 0;
+    uint64_t render_calls   = 0;
+    int64_t render_ns = 0;
+
+    wf::signal::connection_t<node_damage_signal> on_damage;
+};
+
+/**
+ * Collects per-node statistics about damage and rendering, for inspecting the
+ * scenegraph while debugging slow frames.
+ *
+ * The profiler is disabled by default and then costs nothing. When enabled:
+ * - it records the damage emitted by every node, for the last few render
+ *   passes of outputs.
+ * - render instances generated by generic inner nodes and output nodes for
+ *   their children are wrapped, so that the time spent scheduling and
+ *   rendering them is recorded. Views and transformers generate the instances
+ *   of their subtrees themselves, so nodes inside them have no timings.
+ *   Render instances are regenerated when the profiler is enabled or disabled.
+ *
+ * The profiler of the compositor is wf::get_core().scene_profiler.
+ */
+class scene_profiler_t
+{
+  public:
+    static constexpr size_t DEFAULT_HISTORY = 16;
+
+    scene_profiler_t();
+    ~scene_profiler_t();
+
+    void set_enabled(bool enabled);
+    bool is_enabled() const
+    {
+        return enabled;
+    }
+
+    /** Set the number of render passes for which damage is kept. */
+    void set_history(size_t passes);
+    size_t get_history() const
+    {
+        return history;
+    }
+
+    /** @return The number of output render passes since the profiler was enabled. */
+    uint64_t get_pass_count() const
+    {
+        return passes;
+    }
+
+    /** @return The profile of the node, or nullptr if none was recorded. */
+    const node_profile_t *get_profile(node_t *node) const;
+
+    /** Forget all recorded data, but keep profiling. */
+    void reset();
+
+    /**
+     * Wrap the render instances in @instances starting at index @from, which
+     * were generated for @node, so that their timings are recorded. No-op if
+     * the profiler is disabled.
+     */
+    void wrap_instances(node_t *node, std::vector<render_instance_uptr>& instances, size_t from);
+
+  private:
+    bool enabled   = false;
+    size_t history = DEFAULT_HISTORY;
+    uint64_t passes = 0;
+    std::unordered_map<node_t*, std::shared_ptr<node_profile_t>> profiles;
+
+    wf::signal::connection_t<render_pass_begin_signal> on_render_pass_begin;
+    wf::signal::connection_t<root_node_update_signal> on_root_update;
+
+    std::shared_ptr<node_profile_t> get_or_create(node_t *node);
+    void track_tree(node_t *root);
+    void record_damage(node_profile_t& profile, const wf::region_t& region);
+};
+}
+}
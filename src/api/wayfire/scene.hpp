@@ -383,6 +383,13 @@ class output_node_t final : public floating_inner_node_t
      */
     std::optional<wf::geometry_t> limit_region;
 
+    /**
+     * The damage clip region of an output, in the coordinate system of the
+     * output layout. If set, damage of the output's children outside of it is
+     * dropped, for example because another node shows the children instead.
+     */
+    std::optional<wf::geometry_t> damage_clip;
+
   private:
     wf::output_t *output;
 };
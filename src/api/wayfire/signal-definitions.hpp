@@ -4,6 +4,7 @@
 #include "wayfire/object.hpp"
 #include "wayfire/view.hpp"
 #include "wayfire/output.hpp"
+#include "wayfire/config-diff.hpp"
 
 /**
  * Documentation of signals emitted from core components.
@@ -141,10 +142,17 @@ struct post_input_event_signal
 
 /**
  * on: core
- * when: When the config file is reloaded
+ * when: When the config file is reloaded and some options changed. The values
+ *   of the options have already been updated when the signal is emitted.
  */
 struct reload_config_signal
-{};
+{
+    /**
+     * What changed since the last reload. Listeners can use it to rebuild
+     * only the state which depends on the changed options.
+     */
+    wf::config_diff_t diff;
+};
 
 /**
  * on: core
@@ -276,6 +284,21 @@ struct workspace_changed_signal
     wf::output_t *output;
 };
 
+/**
+ * on: output
+ * when: Whenever a sticky view on the output is damaged.
+ *
+ * Sticky views are shown at the same position on every workspace, so their
+ * damage is the same relative to each workspace. It is emitted once, in
+ * output-local coordinates, instead of once per workspace. Scene damage for
+ * sticky views covers only the current workspace, and workspace streams of
+ * the other workspaces apply this damage to the workspace they show.
+ */
+struct output_sticky_damage_signal
+{
+    wf::region_t region;
+};
+
 /**
  * on: output
  * when: Whenever a workspace change is requested by core or by a plugin.
@@ -330,6 +353,33 @@ struct workarea_changed_signal
     wf::geometry_t new_workarea;
 };
 
+/**
+ * on: output, core
+ * when: After the layer-shell surfaces of an output have been arranged.
+ *   Changes to layer-shell surfaces are collected and the output is arranged
+ *   once on the next idle.
+ */
+struct layer_shell_arranged_signal
+{
+    wf::output_t *output;
+
+    /** The number of changes which were coalesced into this arrangement. */
+    int changes;
+
+    /**
+     * Whether all surfaces were arranged and the reserved areas reflowed, or
+     * only the surfaces anchored to the edges which changed.
+     */
+    bool full;
+
+    /** The number of surfaces without an exclusive zone which were configured. */
+    int configured;
+
+    /** The workarea before and after the arrangement. */
+    wf::geometry_t old_workarea;
+    wf::geometry_t new_workarea;
+};
+
 /**
  * on: output
  * when: Whenever a fullscreen view is promoted on top of the other layers.
@@ -556,7 +606,7 @@ struct view_set_sticky_signal
 };
 
 /**
- * on: view
+ * on: view, core
  * when: After the view's title has changed.
  */
 struct view_title_changed_signal
@@ -565,7 +615,7 @@ struct view_title_changed_signal
 };
 
 /**
- * on: view
+ * on: view, core
  * when: After the view's app-id has changed.
  */
 struct view_app_id_changed_signal
@@ -597,6 +647,16 @@ struct view_geometry_changed_signal
     wf::geometry_t old_geometry;
 };
 
+/**
+ * on: view
+ * when: When the client has committed its surface in response to the
+ *   configure sent for a transaction. See wf::txn::view_state_instruction_t.
+ */
+struct view_txn_configured_signal
+{
+    wayfire_view view;
+};
+
 /**
  * on: output
  * when: Whenever the view's workspace changes. (Every plugin changing the
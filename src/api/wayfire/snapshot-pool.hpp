@@ -0,0 +1,133 @@
+#pragma once
+
+#include <wayfire/opengl.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace wf
+{
+/**
+ * A pool of framebuffers for snapshots of views, used by animations which
+ * show the old contents of a view, like crossfade or close animations.
+ *
+ * The sizes of the buffers are rounded up to multiples of BUCKET_SIZE, so
+ * that a buffer can be reused for views of slightly different sizes. Buffers
+ * which are given back to the pool are kept for reuse until the idle buffers
+ * take more memory than the budget. Then the least recently used ones are
+ * freed.
+ *
+ * The pool of the compositor is wf::get_core().snapshot_pool. It is usually
+ * used through wf::pooled_snapshot_t.
+ */
+class snapshot_pool_t
+{
+  public:
+    static constexpr int BUCKET_SIZE = 64;
+    static constexpr size_t DEFAULT_BUDGET = 64 << 20;
+
+    /** Creates and frees the buffers of the pool. */
+    struct allocator_t
+    {
+        std::function<wf::framebuffer_t(int width, int height)> allocate;
+        std::function<void (wf::framebuffer_t& buffer)> free;
+    };
+
+    /** Create a new pool. By default, buffers are allocated with OpenGL. */
+    snapshot_pool_t(allocator_t allocator = {});
+    ~snapshot_pool_t();
+
+    snapshot_pool_t(const snapshot_pool_t&) = delete;
+    snapshot_pool_t& operator =(const snapshot_pool_t&) = delete;
+
+    /**
+     * Get a buffer with at least the given size. Its viewport size is the
+     * size of the bucket, so only a part of it may be needed.
+     */
+    wf::framebuffer_t acquire(int width, int height);
+
+    /** Give back a buffer which was acquired from the pool. */
+    void release(wf::framebuffer_t buffer);
+
+    /** Set the maximal memory of idle buffers, in bytes. */
+    void set_budget(size_t bytes);
+
+    /** Free all idle buffers. */
+    void clear();
+
+    struct stats_t
+    {
+        /** Buffers which could be reused from the pool. */
+        uint64_t hits = 0;
+        /** Buffers which had to be allocated. */
+        uint64_t misses = 0;
+        /** Idle buffers which were freed because of the budget. */
+        uint64_t evictions = 0;
+        /** Memory of all buffers of the pool, in use or idle, in bytes. */
+        size_t allocated_bytes = 0;
+        /** Memory of the idle buffers, in bytes. */
+        size_t idle_bytes = 0;
+        size_t buffers_in_use = 0;
+    };
+
+    const stats_t& get_stats() const
+    {
+        return stats;
+    }
+
+  private:
+    struct idle_buffer_t
+    {
+        wf::framebuffer_t buffer;
+        uint64_t last_used;
+    };
+
+    allocator_t allocator;
+    std::vector<idle_buffer_t> idle;
+    size_t budget = DEFAULT_BUDGET;
+    uint64_t use_counter = 0;
+    stats_t stats;
+
+    void free_buffer(wf::framebuffer_t& buffer);
+    void evict_over_budget();
+};
+
+/**
+ * @return The texture of the part of the target's buffer covered by its
+ *   subbuffer, or of the whole buffer if it has no subbuffer.
+ */
+wf::texture_t get_subbuffer_texture(const wf::render_target_t& target);
+
+/**
+ * A buffer for a snapshot, taken from the compositor's snapshot pool and
+ * given back to it when destroyed.
+ */
+class pooled_snapshot_t
+{
+  public:
+    /** Take a buffer for contents with the given logical geometry and scale. */
+    pooled_snapshot_t(wf::geometry_t geometry, float scale);
+    ~pooled_snapshot_t();
+
+    pooled_snapshot_t(const pooled_snapshot_t&) = delete;
+    pooled_snapshot_t& operator =(const pooled_snapshot_t&) = delete;
+
+    /**
+     * The render target for the snapshot. It covers only the part of the
+     * buffer which is needed for the geometry.
+     */
+    const wf::render_target_t& get_target() const
+    {
+        return target;
+    }
+
+    /** @return The texture with the contents of the snapshot. */
+    wf::texture_t get_texture() const
+    {
+        return get_subbuffer_texture(target);
+    }
+
+  private:
+    wf::render_target_t target;
+};
+}
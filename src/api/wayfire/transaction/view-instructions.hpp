@@ -0,0 +1,77 @@
+#pragma once
+
+#include <wayfire/transaction/instruction.hpp>
+#include <wayfire/transaction/transaction.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include <wayfire/view.hpp>
+#include <optional>
+
+namespace wf
+{
+namespace txn
+{
+/**
+ * The parts of a view's state which can be changed with a transaction.
+ * Fields which are not set are left unchanged.
+ */
+struct view_state_t
+{
+    /** The new wm geometry of the view, in output-local coordinates. */
+    std::optional<wf::geometry_t> geometry;
+    /** The new tiled edges of the view. */
+    std::optional<uint32_t> tiled_edges;
+    /** The new fullscreen state of the view. */
+    std::optional<bool> fullscreen;
+};
+
+/**
+ * An instruction which changes the geometry, the tiled edges and the
+ * fullscreen state of a view at once.
+ *
+ * When the instruction is committed, the new size and states are sent to the
+ * client in a single configure, without changing the view in the compositor.
+ * The instruction becomes ready when the client has committed a surface for
+ * that configure. When the transaction is applied, the view is moved to its
+ * new position and its new states are set, together with all other views in
+ * the transaction. While the instruction waits for the client, the view is
+ * frozen: it is rendered from a snapshot taken at commit time, so that a client
+ * which responds early is not shown in an intermediate state. The rest of the
+ * output keeps updating.
+ *
+ * The instruction is cancelled if the view is unmapped or moved to another
+ * output before the transaction is applied.
+ */
+class view_state_instruction_t : public instruction_t
+{
+  public:
+    view_state_instruction_t(wayfire_view view, view_state_t state);
+    ~view_state_instruction_t();
+
+    /** Convenience function for creating the instruction. */
+    static instruction_uptr_t get(wayfire_view view, view_state_t state)
+    {
+        return std::make_unique<view_state_instruction_t>(view, state);
+    }
+
+    std::string get_object() override;
+    void set_pending() override;
+    void commit() override;
+    void apply() override;
+
+  private:
+    wayfire_view view;
+    view_state_t state;
+
+    bool has_ref = false;
+    bool frozen = false;
+    void freeze();
+    void unfreeze();
+    void send_ready();
+    void send_cancel();
+
+    wf::signal::connection_t<view_unmapped_signal> on_unmapped;
+    wf::signal::connection_t<view_set_output_signal> on_set_output;
+    wf::signal::connection_t<view_txn_configured_signal> on_configured;
+};
+}
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <wayfire/view.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wf
+{
+/**
+ * A reference to a view in the view registry.
+ *
+ * Handles are dense integers, so they are cheap to store and compare. Each
+ * handle also carries the generation of its slot, which changes whenever the
+ * slot is reused, so that a handle to a view which has been removed is never
+ * resolved to another view.
+ */
+struct view_handle_t
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator ==(const view_handle_t& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator !=(const view_handle_t& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * The properties of a view by which the registry indexes it.
+ */
+struct view_registry_keys_t
+{
+    uint32_t id;
+    std::string app_id;
+    wf::output_t *output;
+    view_role_t role;
+};
+
+/**
+ * The registry of all views known to core.
+ *
+ * Adding and removing views, and looking them up by handle or by id, take
+ * constant time. The list of all views keeps the order in which they were
+ * added. In addition, the views are indexed by app-id, output and role.
+ * Core keeps the indices up to date when these properties change.
+ *
+ * The registry does not own the views.
+ */
+class view_registry_t
+{
+  public:
+    /**
+     * Add a view, indexing it by the given properties, or by its current
+     * properties if none are given.
+     *
+     * @return The handle of the view.
+     */
+    view_handle_t add(wayfire_view view);
+    view_handle_t add(wayfire_view view, const view_registry_keys_t& keys);
+
+    /**
+     * Remove a view. Its handle becomes stale. No-op if the view is not
+     * registered.
+     */
+    void remove(wayfire_view view);
+    void remove(view_handle_t handle);
+
+    /**
+     * Update the indexed properties of a view, either from the given
+     * properties or from the current properties of the view.
+     */
+    void update(wayfire_view view);
+    void update(wayfire_view view, const view_registry_keys_t& keys);
+
+    /** @return The view with the given handle, or nullptr if it is stale. */
+    wayfire_view get(view_handle_t handle) const;
+
+    /** @return The handle of the view, or an invalid handle if the view is not registered. */
+    view_handle_t get_handle(wayfire_view view) const;
+
+    /** @return The view with the given id (see object_base_t::get_id()), or nullptr. */
+    wayfire_view find_by_id(uint32_t id) const;
+
+    /** @return The number of registered views. */
+    size_t size() const;
+
+    /**
+     * @return All registered views, in the order in which they were added.
+     *   The list is compacted here after removals, so this is linear only in
+     *   the first call after views were removed.
+     */
+    const std::vector<wayfire_view>& get_all() const;
+
+    /** @return All views with the given app-id, in the order in which they were added. */
+    std::vector<wayfire_view> get_by_app_id(const std::string& app_id) const;
+
+    /** @return All views on the given output, in the order in which they were added. */
+    std::vector<wayfire_view> get_by_output(wf::output_t *output) const;
+
+    /** @return All views with the given role, in the order in which they were added. */
+    std::vector<wayfire_view> get_by_role(view_role_t role) const;
+
+  private:
+    struct slot_t
+    {
+        wayfire_view view;
+        uint32_t generation = 0;
+        bool used = false;
+
+        view_registry_keys_t keys;
+
+        /* Positions of the slot in the dense lists, for O(1) removal. The
+         * position in the list of all views changes in compact_all(). */
+        mutable size_t pos_all;
+        size_t pos_app_id;
+        size_t pos_output;
+        size_t pos_role;
+    };
+
+    /* A list of slot indices per key. */
+    template<class Key>
+    using index_t = std::unordered_map<Key, std::vector<uint32_t>>;
+
+    std::vector<slot_t> slots;
+    std::vector<uint32_t> free_slots;
+
+    /* All views in the order they were added, and the slot of each element
+     * of that list. Removed views leave a hole (nullptr and UINT32_MAX), which
+     * is closed by compact_all(). */
+    mutable std::vector<wayfire_view> all;
+    mutable std::vector<uint32_t> all_slots;
+    mutable size_t all_holes = 0;
+
+    std::unordered_map<view_interface_t*, uint32_t> by_pointer;
+    std::unordered_map<uint32_t, uint32_t> by_id;
+    index_t<std::string> by_app_id;
+    index_t<wf::output_t*> by_output;
+    index_t<int> by_role;
+
+    void compact_all() const;
+    void index_slot(uint32_t slot);
+    void unindex_slot(uint32_t slot);
+
+    template<class Key>
+    void index_insert(index_t<Key>& index, const Key& key, uint32_t slot,
+        size_t slot_t::*pos);
+    template<class Key>
+    void index_erase(index_t<Key>& index, const Key& key, uint32_t slot,
+        size_t slot_t::*pos);
+    template<class Key>
+    std::vector<wayfire_view> index_get(const index_t<Key>& index,
+        const Key& key) const;
+};
+}
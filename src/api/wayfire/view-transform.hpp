@@ -8,6 +8,7 @@
 #include "wayfire/scene.hpp"
 #include <memory>
 #include <wayfire/opengl.hpp>
+#include <wayfire/memory-accounting.hpp>
 
 namespace wf
 {
@@ -58,6 +59,8 @@ class transformer_render_instance_t : public render_instance_t
     // should be repainted on the next frame to have a valid copy of the
     // children's current content.
     wf::region_t cached_damage;
+    // The tag of @inner_content in the memory accounting, set on first use.
+    wf::memory_tag_t memory_tag;
 
     /**
      * Get a texture which contains the contents of the children nodes.
@@ -102,6 +105,12 @@ class transformer_render_instance_t : public render_instance_t
         int target_width  = scale * bbox.width;
         int target_height = scale * bbox.height;
 
+        if (memory_tag.node.empty())
+        {
+            memory_tag = {"core", "transformer buffer", self->stringify()};
+        }
+
+        wf::memory_tag_scope_t memory_scope{memory_tag};
         OpenGL::render_begin();
         if (inner_content.allocate(target_width, target_height))
         {
@@ -274,7 +283,6 @@ class transform_manager_node_t : public wf::scene::floating_inner_node_t
         return "view-transform-root";
     }
 
-  private:
     struct added_transformer_t
     {
         wf::scene::floating_inner_ptr node;
@@ -282,6 +290,23 @@ class transform_manager_node_t : public wf::scene::floating_inner_node_t
         std::string name;
     };
 
+    /** @return The transformers, sorted by their z_order. */
+    const std::vector<added_transformer_t>& get_transformers() const
+    {
+        return transformers;
+    }
+
+    /**
+     * Transform a region from the coordinates of the view's surfaces, at the
+     * bottom of the transformer chain, to the coordinates of this node.
+     *
+     * 2D and 3D transformers map the region exactly. The effect of other
+     * transformers on a region is known only to their render instances, so
+     * they map any non-empty region to their whole bounding box.
+     */
+    wf::region_t transform_region(const wf::region_t& region);
+
+  private:
     std::vector<added_transformer_t> transformers;
     void _add_transformer(wf::scene::floating_inner_ptr transformer,
         int z_order, std::string name);
@@ -346,9 +346,21 @@ class view_interface_t : public wf::signal::provider_t, public wf::object_base_t
      * framebuffer. It is used to get an image of the view while it is mapped,
      * and continue displaying it afterwards. Additionally, return the captured
      * framebuffter
+     *
+     * The buffer is taken from the compositor's snapshot pool, so it is
+     * usually larger than the view. Only the part described by the returned
+     * target's subbuffer contains the snapshot, so do not sample the target's
+     * whole texture, use get_snapshot_texture() instead. The buffer is valid
+     * until the next snapshot of the view.
      */
     virtual const wf::render_target_t& take_snapshot();
 
+    /**
+     * @return The texture of the last snapshot of the view, covering exactly
+     *   the snapshot's geometry. See take_snapshot().
+     */
+    wf::texture_t get_snapshot_texture();
+
     /**
      * View lifetime is managed by reference counting. To take a reference,
      * use take_ref(). Note that one reference is automatically made when the
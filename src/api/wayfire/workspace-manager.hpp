@@ -113,6 +113,17 @@ class workspace_manager
     std::vector<wayfire_view> get_views_on_workspace(wf::point_t ws,
         uint32_t layer_mask, bool include_minimized = false);
 
+    /**
+     * Same as get_views_on_workspace(), but returns a reference to a list
+     * which is cached by the workspace manager instead of building a new one.
+     *
+     * The list is updated in place when the views on the output change, so
+     * callers which move, restack, add or remove views while iterating over
+     * it should iterate over a copy instead.
+     */
+    const std::vector<wayfire_view>& get_cached_views_on_workspace(wf::point_t ws,
+        uint32_t layer_mask, bool include_minimized = false);
+
     /**
      * Ensure that the view's wm_geometry is visible on the workspace ws. This
      * involves moving the view as appropriate.
@@ -162,6 +173,21 @@ class workspace_manager
     std::vector<wayfire_view> get_views_in_layer(uint32_t layers_mask,
         bool include_minimized = false);
 
+    /**
+     * Same as get_views_in_layer(), but returns a reference to a cached list.
+     * See get_cached_views_on_workspace() for the lifetime of the list.
+     */
+    const std::vector<wayfire_view>& get_cached_views_in_layer(uint32_t layers_mask,
+        bool include_minimized = false);
+
+    /**
+     * Get the version of the cached view lists. The version changes whenever
+     * any of the lists returned by get_cached_views_in_layer() or
+     * get_cached_views_on_workspace() may have changed, so plugins can use it
+     * to cache data derived from them.
+     */
+    uint64_t get_view_lists_version();
+
     /**
      * Get a list of minimized views, which are not shown in any other layer.
      */
@@ -3,6 +3,7 @@
 #include "wayfire/scene-render.hpp"
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-provider.hpp"
+#include "wayfire/signal-definitions.hpp"
 #include <wayfire/opengl.hpp>
 #include <wayfire/object.hpp>
 #include <wayfire/region.hpp>
@@ -47,6 +48,7 @@ class workspace_stream_t
     std::vector<scene::render_instance_uptr> instances;
     wf::region_t accumulated_damage;
     signal::connection_t<scene::root_node_update_signal> regen_instances;
+    signal::connection_t<output_sticky_damage_signal> on_sticky_damage;
 
     // not-null => is running
     wf::output_t *current_output = NULL;
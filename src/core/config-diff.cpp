@@ -0,0 +1,80 @@
+#include <wayfire/config-diff.hpp>
+
+wf::config_snapshot_t wf::take_config_snapshot(const wf::config::config_manager_t& config)
+{
+    config_snapshot_t snapshot;
+    for (auto& section : config.get_all_sections())
+    {
+        auto& options = snapshot[section->get_name()];
+        for (auto& option : section->get_registered_options())
+        {
+            options.emplace(option->get_name(), option->get_value_str());
+        }
+    }
+
+    return snapshot;
+}
+
+using option_map_t = std::map<std::string, std::string>;
+
+/** Add the options in @a which are not in @b or have another value there. */
+static void diff_options(const std::string& section, const option_map_t& a,
+    const option_map_t& b, wf::config_diff_t& diff)
+{
+    for (auto& [name, value] : a)
+    {
+        auto it = b.find(name);
+        if ((it == b.end()) || (it->second != value))
+        {
+            diff.changed_options.insert(section + "/" + name);
+            diff.changed_sections.insert(section);
+        }
+    }
+}
+
+wf::config_diff_t wf::compute_config_diff(const config_snapshot_t& before,
+    const config_snapshot_t& after)
+{
+    config_diff_t diff;
+    diff.complete = true;
+
+    static const option_map_t no_options;
+    for (auto& [section, options] : before)
+    {
+        auto it = after.find(section);
+        if (it == after.end())
+        {
+            diff.removed_sections.insert(section);
+            diff.changed_sections.insert(section);
+            diff_options(section, options, no_options, diff);
+        } else
+        {
+            diff_options(section, options, it->second, diff);
+        }
+    }
+
+    for (auto& [section, options] : after)
+    {
+        auto it = before.find(section);
+        if (it == before.end())
+        {
+            diff.added_sections.insert(section);
+            diff.changed_sections.insert(section);
+            diff_options(section, options, no_options, diff);
+        } else
+        {
+            // Only options which are new to the section, the others were
+            // compared above
+            for (auto& [name, value] : options)
+            {
+                if (!it->second.count(name))
+                {
+                    diff.changed_options.insert(section + "/" + name);
+                    diff.changed_sections.insert(section);
+                }
+            }
+        }
+    }
+
+    return diff;
+}
@@ -6,6 +6,8 @@
 #include "wayfire/scene-input.hpp"
 #include "wayfire/scene.hpp"
 #include "wayfire/util.hpp"
+#include "wayfire/option-wrapper.hpp"
+#include "wayfire/memory-accounting.hpp"
 #include <wayfire/nonstd/wlroots-full.hpp>
 
 #include <set>
@@ -34,6 +36,7 @@ class compositor_core_impl_t : public compositor_core_t
     std::unique_ptr<wf::input_manager_t> input;
     std::unique_ptr<input_method_relay> im_relay;
     std::unique_ptr<plugin_manager_t> plugin_mgr;
+    startup_profile_t startup_profile;
 
     /**
      * Initialize the compositor core.
@@ -96,8 +99,12 @@ class compositor_core_impl_t : public compositor_core_t
     wf::output_t *get_active_output() override;
     std::string get_xwayland_display() override;
     pid_t run(std::string command) override;
+    /** Reap the processes started with run() which have exited. */
+    void reap_spawned_children();
     void shutdown() override;
     compositor_state_t get_current_state() override;
+    startup_profile_t get_startup_profile() override;
+    pointer_motion_stats_t get_pointer_motion_stats() override;
     const std::shared_ptr<scene::root_node_t>& scene() final;
 
   protected:
@@ -111,12 +118,22 @@ class compositor_core_impl_t : public compositor_core_t
     wf::wl_listener_wrapper idle_inhibitor_created;
 
     wf::output_t *active_output = nullptr;
-    std::vector<std::unique_ptr<wf::view_interface_t>> views;
-    std::unordered_map<std::string, wayfire_view> id_to_view;
+    /* Owns the views, which are indexed by the view registry. */
+    std::unordered_map<wf::view_interface_t*, std::unique_ptr<wf::view_interface_t>> views;
 
     std::shared_ptr<scene::root_node_t> scene_root;
 
+    /** Processes started with run() which have not exited yet. */
+    std::set<pid_t> spawned_children;
+    wl_event_source *sigchld_source = nullptr;
+
     compositor_state_t state = compositor_state_t::UNKNOWN;
+    /** The budget of the snapshot pool, in MiB. */
+    wf::option_wrapper_t<int> snapshot_pool_budget;
+    void update_snapshot_pool_budget();
+    /** Free the idle snapshot buffers when core is over its memory budget. */
+    wf::signal::connection_t<memory_budget_exceeded_signal> on_memory_budget_exceeded;
+
     compositor_core_impl_t();
     virtual ~compositor_core_impl_t();
 };
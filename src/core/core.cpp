@@ -15,6 +15,12 @@
 #include "wayfire/view.hpp"
 #include <sys/wait.h>
 #include <unistd.h>
+#include <spawn.h>
+#include <signal.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
 #include <fcntl.h>
 #include <float.h>
 
@@ -22,6 +28,10 @@
 #include <wayfire/output.hpp>
 #include <wayfire/util/log.hpp>
 #include <wayfire/output-layout.hpp>
+#include <wayfire/view-registry.hpp>
+#include <wayfire/snapshot-pool.hpp>
+#include <wayfire/memory-accounting.hpp>
+#include <wayfire/scene-profiler.hpp>
 #include <wayfire/workspace-manager.hpp>
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/nonstd/wlroots-full.hpp>
@@ -169,10 +179,21 @@ struct wlr_idle_inhibitor_t : public wf::idle_inhibitor_t
     }
 };
 
+static int handle_sigchld(int, void *data)
+{
+    ((wf::compositor_core_impl_t*)data)->reap_spawned_children();
+    return 0;
+}
+
 void wf::compositor_core_impl_t::init()
 {
+    startup_profile.init_start_us = wf::get_current_time_usec();
     this->scene_root = std::make_shared<scene::root_node_t>();
 
+    snapshot_pool_budget.load_option("core/snapshot_pool_budget");
+    snapshot_pool_budget.set_callback([=] () { update_snapshot_pool_budget(); });
+    update_snapshot_pool_budget();
+
     wlr_renderer_init_wl_display(renderer, display);
 
     /* Order here is important:
@@ -305,17 +326,27 @@ void wf::compositor_core_impl_t::init()
 
     wf_shell = wayfire_shell_create(display);
     this->bindings = std::make_unique<bindings_repository_t>();
+    sigchld_source = wl_event_loop_add_signal(ev_loop, SIGCHLD, handle_sigchld, this);
     image_io::init();
     OpenGL::init();
     this->state = compositor_state_t::START_BACKEND;
 }
 
+void wf::compositor_core_impl_t::update_snapshot_pool_budget()
+{
+    snapshot_pool->set_budget((size_t)std::max(0, (int)snapshot_pool_budget) << 20);
+}
+
 void wf::compositor_core_impl_t::post_init()
 {
     core_backend_started_signal backend_started_ev;
     this->emit(&backend_started_ev);
     this->state = compositor_state_t::RUNNING;
-    plugin_mgr  = std::make_unique<wf::plugin_manager_t>();
+    startup_profile.plugins_start_us = wf::get_current_time_usec();
+    plugin_mgr = std::make_unique<wf::plugin_manager_t>();
+    startup_profile.plugins_done_us = wf::get_current_time_usec();
+    LOGI("Plugins loaded in ",
+        (startup_profile.plugins_done_us - startup_profile.plugins_start_us) / 1000, "ms");
 
     // Move pointer to the middle of the leftmost, topmost output
     wf::pointf_t p;
@@ -330,6 +361,7 @@ void wf::compositor_core_impl_t::post_init()
     // Start processing cursor events
     seat->priv->cursor->setup_listeners();
 
+    startup_profile.startup_finished_us = wf::get_current_time_usec();
     core_startup_finished_signal startup_ev;
     this->emit(&startup_ev);
 }
@@ -339,6 +371,7 @@ void wf::compositor_core_impl_t::shutdown()
     this->state = compositor_state_t::SHUTDOWN;
     core_shutdown_signal ev;
     this->emit(&ev);
+    image_io::fini();
     wl_display_terminate(wf::get_core().display);
 }
 
@@ -347,6 +380,22 @@ wf::compositor_state_t wf::compositor_core_impl_t::get_current_state()
     return this->state;
 }
 
+wf::startup_profile_t wf::compositor_core_impl_t::get_startup_profile()
+{
+    auto profile = startup_profile;
+    if (plugin_mgr)
+    {
+        profile.plugins = plugin_mgr->get_load_times();
+    }
+
+    return profile;
+}
+
+wf::pointer_motion_stats_t wf::compositor_core_impl_t::get_pointer_motion_stats()
+{
+    return seat->priv->lpointer->motion_stats;
+}
+
 wlr_seat*wf::compositor_core_impl_t::get_current_seat()
 {
     return seat->seat;
@@ -516,8 +565,8 @@ void wf::compositor_core_impl_t::add_view(
     std::unique_ptr<wf::view_interface_t> view)
 {
     auto v = view->self(); /* non-owning copy */
-    views.push_back(std::move(view));
-    id_to_view[std::to_string(v->get_id())] = v;
+    views[v.get()] = std::move(view);
+    view_registry->add(v);
 
     assert(active_output);
 
@@ -534,13 +583,8 @@ void wf::compositor_core_impl_t::add_view(
 
 std::vector<wayfire_view> wf::compositor_core_impl_t::get_all_views()
 {
-    std::vector<wayfire_view> result;
-    for (auto& view : this->views)
-    {
-        result.push_back({view});
-    }
-
-    return result;
+    // The registry keeps the order in which the views were added
+    return view_registry->get_all();
 }
 
 void wf::compositor_core_impl_t::focus_view(wayfire_view v)
@@ -570,81 +614,121 @@ void wf::compositor_core_impl_t::erase_view(wayfire_view v)
         v->set_output(nullptr);
     }
 
-    auto it = std::find_if(views.begin(), views.end(),
-        [&v] (const auto& view) { return view.get() == v.get(); });
-
     v->deinitialize();
 
-    id_to_view.erase(std::to_string(v->get_id()));
-    views.erase(it);
+    view_registry->remove(v);
+    views.erase(v.get());
 }
 
 wayfire_view wf::compositor_core_impl_t::find_view(const std::string& id)
 {
-    auto it = id_to_view.find(id);
-    if (it != id_to_view.end())
+    char *end;
+    errno = 0;
+    unsigned long numeric_id = std::strtoul(id.c_str(), &end, 10);
+    if (id.empty() || *end || errno || (numeric_id > UINT32_MAX))
     {
-        return it->second;
+        return nullptr;
     }
 
-    return nullptr;
+    return view_registry->find_by_id(numeric_id);
 }
 
-pid_t wf::compositor_core_impl_t::run(std::string command)
-{
-    static constexpr size_t READ_END  = 0;
-    static constexpr size_t WRITE_END = 1;
-    pid_t pid;
-    int pipe_fd[2];
-    pipe2(pipe_fd, O_CLOEXEC);
+extern char **environ;
 
-    /* The following is a "hack" for disowning the child processes,
-     * otherwise they will simply stay as zombie processes */
-    pid = fork();
-    if (!pid)
+void wf::compositor_core_impl_t::reap_spawned_children()
+{
+    for (auto it = spawned_children.begin(); it != spawned_children.end();)
     {
-        pid = fork();
-        if (!pid)
+        int status;
+        if (waitpid(*it, &status, WNOHANG) != 0)
         {
-            close(pipe_fd[READ_END]);
-            close(pipe_fd[WRITE_END]);
+            it = spawned_children.erase(it);
+        } else
+        {
+            ++it;
+        }
+    }
+}
 
-            setenv("_JAVA_AWT_WM_NONREPARENTING", "1", 1);
-            setenv("WAYLAND_DISPLAY", wayland_display.c_str(), 1);
+pid_t wf::compositor_core_impl_t::run(std::string command)
+{
+    /* posix_spawn() does not copy the compositor's address space like fork()
+     * does, and returns as soon as the child has exec'd, so spawning does not
+     * stall the event loop. The child stays our child and is reaped in the
+     * SIGCHLD handler, instead of double-forking and waiting for the
+     * intermediate process. */
+    std::vector<std::string> env_storage;
+    std::vector<char*> envp;
+    auto override_env = [&] (const std::string& name, const std::string& value)
+    {
+        env_storage.push_back(name + "=" + value);
+    };
+
+    override_env("_JAVA_AWT_WM_NONREPARENTING", "1");
+    override_env("WAYLAND_DISPLAY", wayland_display);
 #if WF_HAS_XWAYLAND
-            if (!xwayland_get_display().empty())
-            {
-                setenv("DISPLAY", xwayland_get_display().c_str(), 1);
-            }
+    if (!xwayland_get_display().empty())
+    {
+        override_env("DISPLAY", xwayland_get_display());
+    }
 
 #endif
-            int dev_null = open("/dev/null", O_WRONLY);
-            dup2(dev_null, 1);
-            dup2(dev_null, 2);
-            close(dev_null);
 
-            _exit(execl("/bin/sh", "/bin/sh", "-c", command.c_str(), NULL));
-        } else
-        {
-            close(pipe_fd[READ_END]);
-            write(pipe_fd[WRITE_END], (void*)(&pid), sizeof(pid));
-            close(pipe_fd[WRITE_END]);
-            _exit(0);
-        }
-    } else
+    for (auto& var : env_storage)
     {
-        close(pipe_fd[WRITE_END]);
+        envp.push_back(var.data());
+    }
 
-        int status;
-        waitpid(pid, &status, 0);
+    for (char **var = environ; *var; ++var)
+    {
+        std::string_view entry = *var;
+        bool overridden = std::any_of(env_storage.begin(), env_storage.end(),
+            [&] (const std::string& o)
+        {
+            auto name_len = o.find('=') + 1;
+            return entry.substr(0, name_len) == std::string_view(o).substr(0, name_len);
+        });
+
+        if (!overridden)
+        {
+            envp.push_back(*var);
+        }
+    }
 
-        pid_t child_pid;
-        read(pipe_fd[READ_END], &child_pid, sizeof(child_pid));
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, 1, 2);
+
+    // The event loop blocks SIGCHLD, the child should start with a clean state.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t mask, defaults;
+    sigemptyset(&mask);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGCHLD);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    const char *argv[] = {"/bin/sh", "-c", command.c_str(), NULL};
+    pid_t pid;
+    int r = posix_spawn(&pid, "/bin/sh", &actions, &attr, (char* const*)argv, envp.data());
 
-        close(pipe_fd[READ_END]);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
 
-        return child_pid;
+    if (r != 0)
+    {
+        LOGE("Failed to run command \"", command, "\": ", strerror(r));
+        return -1;
     }
+
+    spawned_children.insert(pid);
+    return pid;
 }
 
 std::string wf::compositor_core_impl_t::get_xwayland_display()
@@ -717,7 +801,21 @@ wf::compositor_core_t::~compositor_core_t()
 {}
 
 wf::compositor_core_impl_t::compositor_core_impl_t()
-{}
+{
+    view_registry = std::make_unique<wf::view_registry_t>();
+    memory_accounting = std::make_unique<wf::memory_accounting_t>();
+    snapshot_pool     = std::make_unique<wf::snapshot_pool_t>();
+    scene_profiler    = std::make_unique<wf::scene::scene_profiler_t>();
+
+    on_memory_budget_exceeded = [=] (memory_budget_exceeded_signal *ev)
+    {
+        if (ev->owner == "core")
+        {
+            snapshot_pool->clear();
+        }
+    };
+    this->connect(&on_memory_budget_exceeded);
+}
 wf::compositor_core_impl_t::~compositor_core_impl_t()
 {
     /* Unloading order is important. First we want to free any remaining views,
@@ -725,6 +823,10 @@ wf::compositor_core_impl_t::~compositor_core_impl_t()
     views.clear();
     input.reset();
     output_layout.reset();
+    if (sigchld_source)
+    {
+        wl_event_source_remove(sigchld_source);
+    }
 }
 
 wf::compositor_core_t& wf::compositor_core_t::get()
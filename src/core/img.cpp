@@ -14,16 +14,25 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <functional>
+#include <wayfire/core.hpp>
+#include <wayfire/util.hpp>
 
 #define TEXTURE_LOAD_ERROR 0
 
 namespace image_io
 {
 using Loader = std::function<bool (const char*, GLuint)>;
-using Writer = std::function<void (const char*name, uint8_t*pixels, unsigned long,
+using Writer = std::function<bool (const char*name, uint8_t*pixels, unsigned long,
     unsigned long, bool)>;
 namespace
 {
@@ -231,13 +240,13 @@ bool texture_from_png(const char *filename, GLuint target)
     return true;
 }
 
-void texture_to_png(const char *name, uint8_t *pixels, int w, int h, bool invert)
+bool texture_to_png(const char *name, uint8_t *pixels, int w, int h, bool invert)
 {
     png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr,
         nullptr, nullptr);
     if (!png)
     {
-        return;
+        return false;
     }
 
     png_infop infot = png_create_info_struct(png);
@@ -245,7 +254,7 @@ void texture_to_png(const char *name, uint8_t *pixels, int w, int h, bool invert
     {
         png_destroy_write_struct(&png, &infot);
 
-        return;
+        return false;
     }
 
     FILE *fp = fopen(name, "wb");
@@ -253,7 +262,7 @@ void texture_to_png(const char *name, uint8_t *pixels, int w, int h, bool invert
     {
         png_destroy_write_struct(&png, &infot);
 
-        return;
+        return false;
     }
 
     png_init_io(png, fp);
@@ -267,7 +276,7 @@ void texture_to_png(const char *name, uint8_t *pixels, int w, int h, bool invert
         fclose(fp);
         png_destroy_write_struct(&png, &infot);
 
-        return;
+        return false;
     }
 
     png_set_PLTE(png, infot, palette, PNG_MAX_PALETTE_LENGTH);
@@ -293,6 +302,8 @@ void texture_to_png(const char *name, uint8_t *pixels, int w, int h, bool invert
 
     fclose(fp);
     png_free(png, rows);
+
+    return true;
 }
 
 bool texture_from_jpeg(const char *FileName, GLuint target)
@@ -420,6 +431,252 @@ void write_to_file(std::string name, wf::framebuffer_t fb)
         fb.viewport_width, fb.viewport_height, "png", false);
 }
 
+namespace
+{
+int64_t get_time_us()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/* A capture started with write_to_file_async() */
+struct capture_t
+{
+    std::string name;
+    std::string type;
+    int width;
+    int height;
+
+    GLuint pbo   = 0;
+    GLsync fence = 0;
+    std::vector<uint8_t> pixels;
+
+    int64_t start_time;
+    capture_result_t result;
+    capture_callback_t on_done;
+};
+
+/* Captures go through three stages:
+ *
+ * 1. The readback into a pixel buffer object is issued on the main thread.
+ * 2. The fences of the pending readbacks are polled on the main thread, and
+ *    once the GPU is done, the pixels are copied out of the pixel buffer.
+ * 3. The image is encoded on the worker thread, which then wakes up the main
+ *    loop so that the completion callback runs on the main thread. */
+class capture_queue_t
+{
+  public:
+    capture_queue_t()
+    {
+        notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        notify_source = wl_event_loop_add_fd(wf::get_core().ev_loop, notify_fd,
+            WL_EVENT_READABLE, handle_notify, this);
+        worker = std::thread([=] () { run_worker(); });
+    }
+
+    /* Images which are already read back are still written, readbacks which
+     * are in flight are dropped. */
+    ~capture_queue_t()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        has_work.notify_one();
+        worker.join();
+
+        wl_event_source_remove(notify_source);
+        close(notify_fd);
+
+        OpenGL::render_begin();
+        for (auto& capture : readbacks)
+        {
+            GL_CALL(glDeleteBuffers(1, &capture->pbo));
+            glDeleteSync(capture->fence);
+        }
+
+        OpenGL::render_end();
+    }
+
+    void add(std::unique_ptr<capture_t> capture)
+    {
+        readbacks.push_back(std::move(capture));
+        if (!poll_timer.is_connected())
+        {
+            poll_timer.set_timeout(1, [=] ()
+            {
+                return poll_readbacks();
+            });
+        }
+    }
+
+  private:
+    std::vector<std::unique_ptr<capture_t>> readbacks;
+    wf::wl_timer poll_timer;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable has_work;
+    bool stopping = false;
+    std::deque<std::unique_ptr<capture_t>> to_encode;
+    std::deque<std::unique_ptr<capture_t>> encoded;
+
+    int notify_fd;
+    wl_event_source *notify_source;
+
+    /* Returns true while there are still readbacks in flight. */
+    bool poll_readbacks()
+    {
+        OpenGL::render_begin();
+        auto it = readbacks.begin();
+        while (it != readbacks.end())
+        {
+            auto& capture = *it;
+            GLenum status = glClientWaitSync(capture->fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+            {
+                ++it;
+                continue;
+            }
+
+            int64_t start = get_time_us();
+            size_t size   = 4ul * capture->width * capture->height;
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo));
+            void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size,
+                GL_MAP_READ_BIT);
+            if (data && (status != GL_WAIT_FAILED))
+            {
+                capture->pixels.assign((uint8_t*)data, (uint8_t*)data + size);
+                GL_CALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+            }
+
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+            GL_CALL(glDeleteBuffers(1, &capture->pbo));
+            glDeleteSync(capture->fence);
+            capture->result.main_thread_us += get_time_us() - start;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                to_encode.push_back(std::move(capture));
+            }
+
+            has_work.notify_one();
+            it = readbacks.erase(it);
+        }
+
+        OpenGL::render_end();
+        return !readbacks.empty();
+    }
+
+    void run_worker()
+    {
+        while (true)
+        {
+            std::unique_ptr<capture_t> capture;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                has_work.wait(lock, [=] () { return stopping || !to_encode.empty(); });
+                if (to_encode.empty())
+                {
+                    return;
+                }
+
+                capture = std::move(to_encode.front());
+                to_encode.pop_front();
+            }
+
+            auto it = writers.find(capture->type);
+            if (capture->pixels.empty())
+            {
+                LOGE("failed to read back pixels for ", capture->name);
+            } else if (it == writers.end())
+            {
+                LOGE("unsupported image_writer backend");
+            } else
+            {
+                capture->result.success = it->second(capture->name.c_str(),
+                    capture->pixels.data(), capture->width, capture->height, false);
+            }
+
+            capture->pixels = {};
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                encoded.push_back(std::move(capture));
+            }
+
+            uint64_t one = 1;
+            if (write(notify_fd, &one, sizeof(one)) < 0)
+            {
+                LOGE("failed to notify the main thread of a finished capture");
+            }
+        }
+    }
+
+    static int handle_notify(int fd, uint32_t mask, void *data)
+    {
+        uint64_t count;
+        if (read(fd, &count, sizeof(count)) < 0)
+        {
+            return 0;
+        }
+
+        auto self = (capture_queue_t*)data;
+        std::deque<std::unique_ptr<capture_t>> done;
+        {
+            std::lock_guard<std::mutex> lock(self->mutex);
+            std::swap(done, self->encoded);
+        }
+
+        for (auto& capture : done)
+        {
+            capture->result.total_us = get_time_us() - capture->start_time;
+            if (capture->on_done)
+            {
+                capture->on_done(capture->result);
+            }
+        }
+
+        return 0;
+    }
+};
+}
+
+/* Created on the first asynchronous capture, destroyed in fini() */
+static std::unique_ptr<capture_queue_t> capture_queue;
+
+void write_to_file_async(std::string name, wf::framebuffer_t fb,
+    capture_callback_t on_done, std::string type)
+{
+    if (!capture_queue)
+    {
+        capture_queue = std::make_unique<capture_queue_t>();
+    }
+
+    auto capture = std::make_unique<capture_t>();
+    capture->name   = name;
+    capture->type   = type;
+    capture->width  = fb.viewport_width;
+    capture->height = fb.viewport_height;
+    capture->on_done    = on_done;
+    capture->start_time = get_time_us();
+
+    OpenGL::render_begin();
+    GL_CALL(glGenBuffers(1, &capture->pbo));
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->pbo));
+    GL_CALL(glBufferData(GL_PIXEL_PACK_BUFFER,
+        4ul * capture->width * capture->height, nullptr, GL_STREAM_READ));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fb));
+    GL_CALL(glReadPixels(0, 0, capture->width, capture->height,
+        GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    capture->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    OpenGL::render_end();
+
+    capture->result.main_thread_us = get_time_us() - capture->start_time;
+    capture_queue->add(std::move(capture));
+}
+
 void init()
 {
     LOGD("init ImageIO");
@@ -429,4 +686,9 @@ void init()
     writers["png"] = Writer(texture_to_png);
 #endif
 }
+
+void fini()
+{
+    capture_queue.reset();
+}
 }
@@ -0,0 +1,142 @@
+#include <wayfire/memory-accounting.hpp>
+#include <wayfire/core.hpp>
+#include <algorithm>
+
+static void add_usage(wf::memory_accounting_t::usage_t& usage, size_t bytes)
+{
+    usage.live_bytes += bytes;
+    usage.peak_bytes  = std::max(usage.peak_bytes, usage.live_bytes);
+    ++usage.allocations;
+}
+
+static void remove_usage(wf::memory_accounting_t::usage_t& usage, size_t bytes)
+{
+    usage.live_bytes -= std::min(usage.live_bytes, bytes);
+    --usage.allocations;
+}
+
+void wf::memory_accounting_t::track(memory_kind_t kind, uint64_t key, size_t bytes,
+    const memory_tag_t& tag)
+{
+    auto [it, inserted] = allocations.try_emplace({kind, key}, allocation_t{tag, bytes});
+    if (!inserted)
+    {
+        // Resized or reused by someone else
+        remove(it->second.tag, it->second.bytes);
+        it->second = {tag, bytes};
+    }
+
+    add(tag, bytes);
+}
+
+void wf::memory_accounting_t::track(memory_kind_t kind, uint64_t key, size_t bytes)
+{
+    track(kind, key, bytes, current_tag());
+}
+
+void wf::memory_accounting_t::untrack(memory_kind_t kind, uint64_t key)
+{
+    auto it = allocations.find({kind, key});
+    if (it != allocations.end())
+    {
+        remove(it->second.tag, it->second.bytes);
+        allocations.erase(it);
+    }
+}
+
+const wf::memory_tag_t& wf::memory_accounting_t::current_tag() const
+{
+    static const memory_tag_t untagged;
+    return scopes.empty() ? untagged : *scopes.back();
+}
+
+void wf::memory_accounting_t::set_budget(const std::string& owner, size_t bytes)
+{
+    over_budget.erase(owner);
+    if (bytes == 0)
+    {
+        budgets.erase(owner);
+        return;
+    }
+
+    budgets[owner] = bytes;
+    check_budget(owner);
+}
+
+void wf::memory_accounting_t::add(const memory_tag_t& tag, size_t bytes)
+{
+    add_usage(by_tag[tag], bytes);
+    add_usage(by_owner[tag.owner], bytes);
+    add_usage(total, bytes);
+    check_budget(tag.owner);
+}
+
+void wf::memory_accounting_t::remove(const memory_tag_t& tag, size_t bytes)
+{
+    remove_usage(by_tag[tag], bytes);
+    auto& owner = by_owner[tag.owner];
+    remove_usage(owner, bytes);
+    remove_usage(total, bytes);
+
+    // Re-arm the signal once the owner is back within its budget
+    auto it = budgets.find(tag.owner);
+    if ((it != budgets.end()) && (owner.live_bytes <= it->second))
+    {
+        over_budget.erase(tag.owner);
+    }
+}
+
+void wf::memory_accounting_t::check_budget(const std::string& owner)
+{
+    auto it = budgets.find(owner);
+    if ((it == budgets.end()) || over_budget.count(owner))
+    {
+        return;
+    }
+
+    if (by_owner[owner].live_bytes > it->second)
+    {
+        over_budget.insert(owner);
+        pending_reports.insert(owner);
+        if (!idle_report.is_connected())
+        {
+            idle_report.run_once([=] () { report_over_budget(); });
+        }
+    }
+}
+
+void wf::memory_accounting_t::report_over_budget()
+{
+    auto owners = std::move(pending_reports);
+    pending_reports.clear();
+    for (auto& owner : owners)
+    {
+        // Back within the budget before we got to report it
+        auto it = budgets.find(owner);
+        if ((it == budgets.end()) || !over_budget.count(owner))
+        {
+            continue;
+        }
+
+        memory_budget_exceeded_signal ev;
+        ev.owner = owner;
+        ev.live_bytes = by_owner[owner].live_bytes;
+        ev.budget     = it->second;
+        wf::get_core().emit(&ev);
+    }
+}
+
+wf::memory_tag_scope_t::memory_tag_scope_t(const memory_tag_t& tag) :
+    memory_tag_scope_t(*wf::get_core().memory_accounting, tag)
+{}
+
+wf::memory_tag_scope_t::memory_tag_scope_t(memory_accounting_t& accounting, const memory_tag_t& tag)
+{
+    this->accounting = &accounting;
+    accounting.scopes.push_back(&tag);
+}
+
+wf::memory_tag_scope_t::~memory_tag_scope_t()
+{
+    accounting->scopes.pop_back();
+}
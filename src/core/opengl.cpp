@@ -4,6 +4,7 @@
 #include "wayfire/geometry.hpp"
 #include "wayfire/output.hpp"
 #include "core-impl.hpp"
+#include <wayfire/memory-accounting.hpp>
 #include "config.h"
 #include <wayfire/nonstd/wlroots-full.hpp>
 
@@ -359,6 +360,8 @@ bool wf::framebuffer_t::allocate(int width, int height)
             GL_CALL(glBindTexture(GL_TEXTURE_2D, tex));
             GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height,
                 0, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+            wf::get_core().memory_accounting->track(wf::memory_kind_t::GL_TEXTURE,
+                tex, (size_t)width * height * 4);
         }
     }
 
@@ -411,6 +414,7 @@ void wf::framebuffer_t::release()
     if ((tex != uint32_t(-1)) && ((fb != 0) || (tex != 0)))
     {
         GL_CALL(glDeleteTextures(1, &tex));
+        wf::get_core().memory_accounting->untrack(wf::memory_kind_t::GL_TEXTURE, tex);
     }
 
     reset();
@@ -5,6 +5,7 @@
 #include "wayfire/render-manager.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include "wayfire/util.hpp"
+#include "wayfire/view-registry.hpp"
 
 #include "../output/output-impl.hpp"
 #include "seat/cursor.hpp"
@@ -153,10 +154,9 @@ void transfer_views(wf::output_t *from, wf::output_t *to)
         // Also get a list of views which are on that output, but do not have
         // a layer. These are usually unmapped Xwayland views, which are not to
         // be killed, as they are needed for the "real" views.
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::get_core().view_registry->get_by_output(from))
         {
-            if ((view->get_output() == from) &&
-                (from->workspace->get_view_layer(view) == 0) &&
+            if ((from->workspace->get_view_layer(view) == 0) &&
                 (view->role != VIEW_ROLE_DESKTOP_ENVIRONMENT))
             {
                 unmapped_views.push_back(view);
@@ -189,13 +189,8 @@ void transfer_views(wf::output_t *from, wf::output_t *to)
 
     // Find all leftover views
     std::vector<wayfire_view> reffed;
-    for (auto& view : wf::get_core().get_all_views())
+    for (auto& view : wf::get_core().view_registry->get_by_output(from))
     {
-        if (view->get_output() != from)
-        {
-            continue;
-        }
-
         // Ensure that no view is destroyed before we're finished with it!
         // This is necessary in case we have for ex. a popup on a layer-shell
         // surface. We don't know in which order they will be closed/destroyed.
@@ -901,7 +896,10 @@ class output_layout_t::impl
 
     wf::signal::connection_t<wf::reload_config_signal> on_config_reload = [=] (wf::reload_config_signal *ev)
     {
-        reconfigure_from_config();
+        if (ev->diff.section_with_prefix_changed("output:"))
+        {
+            reconfigure_from_config();
+        }
     };
 
     wf::signal::connection_t<core_backend_started_signal> on_backend_started =
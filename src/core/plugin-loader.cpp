@@ -3,7 +3,11 @@
 #include <set>
 #include <memory>
 #include <filesystem>
+#include <atomic>
+#include <thread>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "plugin-loader.hpp"
 #include "wayfire/output-layout.hpp"
@@ -16,6 +20,7 @@
 wf::plugin_manager_t::plugin_manager_t()
 {
     this->plugins_opt.load_option("core/plugins");
+    this->load_threads_opt.load_option("core/plugin_load_threads");
 
     reload_dynamic_plugins();
     load_static_plugins();
@@ -80,63 +85,149 @@ void wf::plugin_manager_t::destroy_plugin(wf::loaded_plugin_t& p)
     }
 }
 
-std::pair<void*, void*> wf::get_new_instance_handle(const std::string& path)
+wf::plugin_file_t wf::open_plugin_file(const std::string& path)
 {
+    plugin_file_t file;
+    file.path = path;
+    int64_t start = wf::get_current_time_usec();
+
     // RTLD_GLOBAL is required for RTTI/dynamic_cast across plugins
     void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    file.load_us = wf::get_current_time_usec() - start;
     if (handle == NULL)
     {
-        LOGE("error loading plugin: ", dlerror());
-        return {nullptr, nullptr};
+        file.error = std::string("error loading plugin: ") + dlerror();
+        return file;
     }
 
     /* Check plugin version */
     auto version_func_ptr = dlsym(handle, "getWayfireVersion");
     if (version_func_ptr == NULL)
     {
-        LOGE(path, ": missing getWayfireVersion()", path.c_str());
+        file.error = path + ": missing getWayfireVersion()";
         dlclose(handle);
-        return {nullptr, nullptr};
+        return file;
     }
 
     auto version_func = union_cast<void*, wayfire_plugin_version_func>(version_func_ptr);
     int32_t plugin_abi_version = version_func();
 
-    if (version_func() != WAYFIRE_API_ABI_VERSION)
+    if (plugin_abi_version != WAYFIRE_API_ABI_VERSION)
     {
-        LOGE(path, ": API/ABI version mismatch: Wayfire is ",
-            WAYFIRE_API_ABI_VERSION, ",  plugin built with ", plugin_abi_version);
+        file.error = path + ": API/ABI version mismatch: Wayfire is " +
+            std::to_string(WAYFIRE_API_ABI_VERSION) + ",  plugin built with " +
+            std::to_string(plugin_abi_version);
         dlclose(handle);
-        return {nullptr, nullptr};
+        return file;
     }
 
     auto new_instance_func_ptr = dlsym(handle, "newInstance");
     if (new_instance_func_ptr == NULL)
     {
-        LOGE(path, ": missing newInstance(). ", dlerror());
+        file.error = path + ": missing newInstance(). " + dlerror();
         dlclose(handle);
+        return file;
+    }
+
+    file.handle = handle;
+    file.new_instance = new_instance_func_ptr;
+    file.load_us = wf::get_current_time_usec() - start;
+    return file;
+}
+
+std::pair<void*, void*> wf::get_new_instance_handle(const std::string& path)
+{
+    auto file = open_plugin_file(path);
+    if (!file.new_instance)
+    {
+        LOGE(file.error);
         return {nullptr, nullptr};
     }
 
     LOGD("Loaded plugin ", path.c_str());
+    return {file.handle, file.new_instance};
+}
+
+/** Read the whole file, so that dlopen() finds it in the page cache. */
+static void read_ahead(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    static constexpr size_t CHUNK = 64 * 1024;
+    std::unique_ptr<char[]> buffer(new char[CHUNK]);
+    while (read(fd, buffer.get(), CHUNK) > 0)
+    {}
 
-    return {handle, new_instance_func_ptr};
+    close(fd);
 }
 
-std::optional<wf::loaded_plugin_t> wf::plugin_manager_t::load_plugin_from_file(std::string path)
+std::vector<wf::plugin_file_t> wf::open_plugin_files(
+    const std::vector<std::string>& paths, int threads)
 {
-    auto [handle, new_instance_func_ptr] = wf::get_new_instance_handle(path);
-    if (new_instance_func_ptr)
+    /* dlopen() runs the static constructors of the plugins, which may use
+     * core (for ex. option wrappers at namespace scope), so the files are
+     * opened in order on the calling thread. The worker threads only read
+     * the files ahead, so that the disk reads overlap with dlopen(). */
+    std::atomic<size_t> next = 0;
+    auto worker = [&] ()
+    {
+        for (size_t i = next++; i < paths.size(); i = next++)
+        {
+            read_ahead(paths[i]);
+        }
+    };
+
+    threads = std::clamp(threads, 1, (int)std::max<size_t>(paths.size(), 1));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++)
     {
-        auto new_instance_func = union_cast<void*, wayfire_plugin_load_func>(new_instance_func_ptr);
+        pool.emplace_back(worker);
+    }
 
-        loaded_plugin_t lp;
-        lp.instance  = std::unique_ptr<wf::plugin_interface_t>(new_instance_func());
-        lp.so_handle = handle;
-        return lp;
+    std::vector<plugin_file_t> files;
+    for (auto& path : paths)
+    {
+        files.push_back(open_plugin_file(path));
     }
 
-    return {};
+    // Stop the workers early, the remaining files are already open
+    next = paths.size();
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+
+    return files;
+}
+
+wf::loaded_plugin_t wf::plugin_manager_t::load_plugin_from_file(const plugin_file_t& file)
+{
+    auto new_instance_func = union_cast<void*, wayfire_plugin_load_func>(file.new_instance);
+
+    loaded_plugin_t lp;
+    lp.load_time.name    = file.path;
+    lp.load_time.load_us = file.load_us;
+
+    int64_t start = wf::get_current_time_usec();
+    lp.instance  = std::unique_ptr<wf::plugin_interface_t>(new_instance_func());
+    lp.so_handle = file.handle;
+    lp.load_time.create_us = wf::get_current_time_usec() - start;
+    return lp;
+}
+
+std::vector<wf::plugin_load_time_t> wf::plugin_manager_t::get_load_times() const
+{
+    std::vector<plugin_load_time_t> result;
+    for (auto& [name, plugin] : loaded_plugins)
+    {
+        result.push_back(plugin.load_time);
+    }
+
+    return result;
 }
 
 void wf::plugin_manager_t::reload_dynamic_plugins()
@@ -194,38 +285,77 @@ void wf::plugin_manager_t::reload_dynamic_plugins()
         }
     }
 
-    /* load new plugins */
-    for (auto plugin : next_plugins)
+    /* Open the new plugin files while reading them ahead in parallel, then
+     * create and initialize the plugins in order. */
+    std::vector<std::string> new_plugins;
+    for (auto& plugin : next_plugins)
     {
-        if (loaded_plugins.count(plugin))
+        if (!loaded_plugins.count(plugin) &&
+            (std::find(new_plugins.begin(), new_plugins.end(), plugin) == new_plugins.end()))
         {
-            continue;
+            new_plugins.push_back(plugin);
         }
+    }
+
+    int threads = load_threads_opt;
+    if (threads <= 0)
+    {
+        threads = std::clamp((int)std::thread::hardware_concurrency(), 1, 8);
+    }
 
-        auto ptr = load_plugin_from_file(plugin);
-        if (ptr)
+    int64_t start = wf::get_current_time_usec();
+    auto files    = wf::open_plugin_files(new_plugins, threads);
+    int64_t opened = wf::get_current_time_usec();
+
+    for (auto& file : files)
+    {
+        if (!file.new_instance)
         {
-            ptr->instance->init();
-            loaded_plugins[plugin] = std::move(*ptr);
+            LOGE(file.error);
+            continue;
         }
+
+        auto lp = load_plugin_from_file(file);
+        int64_t init_start = wf::get_current_time_usec();
+        lp.instance->init();
+        lp.load_time.init_us = wf::get_current_time_usec() - init_start;
+
+        LOGD("Loaded plugin ", file.path, ": open ", lp.load_time.load_us, "us, create ",
+            lp.load_time.create_us, "us, init ", lp.load_time.init_us, "us");
+        loaded_plugins[file.path] = std::move(lp);
+    }
+
+    if (!new_plugins.empty())
+    {
+        LOGD("Loaded ", new_plugins.size(), " plugins with ", threads, " threads: open ",
+            (opened - start) / 1000, "ms, create and init ",
+            (wf::get_current_time_usec() - opened) / 1000, "ms");
     }
 }
 
 template<class T>
-static wf::loaded_plugin_t create_plugin()
+static wf::loaded_plugin_t create_plugin(std::string name)
 {
     wf::loaded_plugin_t lp;
+    lp.load_time.name    = name;
+    lp.load_time.load_us = 0;
+
+    int64_t start = wf::get_current_time_usec();
     lp.instance  = std::make_unique<T>();
     lp.so_handle = nullptr;
+    lp.load_time.create_us = wf::get_current_time_usec() - start;
+
+    start = wf::get_current_time_usec();
     lp.instance->init();
+    lp.load_time.init_us = wf::get_current_time_usec() - start;
     return lp;
 }
 
 void wf::plugin_manager_t::load_static_plugins()
 {
-    loaded_plugins["_exit"]  = create_plugin<wf::per_output_plugin_t<wayfire_exit>>();
-    loaded_plugins["_focus"] = create_plugin<wf::per_output_plugin_t<wayfire_focus>>();
-    loaded_plugins["_close"] = create_plugin<wf::per_output_plugin_t<wayfire_close>>();
+    loaded_plugins["_exit"]  = create_plugin<wf::per_output_plugin_t<wayfire_exit>>("_exit");
+    loaded_plugins["_focus"] = create_plugin<wf::per_output_plugin_t<wayfire_focus>>("_focus");
+    loaded_plugins["_close"] = create_plugin<wf::per_output_plugin_t<wayfire_close>>("_close");
 }
 
 std::vector<std::string> wf::get_plugin_paths()
@@ -3,6 +3,7 @@
 #include <vector>
 #include <unordered_map>
 #include "wayfire/plugin.hpp"
+#include "wayfire/core.hpp"
 #include "config.h"
 #include "wayfire/util.hpp"
 #include <wayfire/option-wrapper.hpp>
@@ -16,6 +17,25 @@ struct loaded_plugin_t
 
     // A handle returned by dlopen().
     void *so_handle;
+
+    // How long it took to load the plugin
+    plugin_load_time_t load_time;
+};
+
+/** The result of opening a plugin file, see open_plugin_files(). */
+struct plugin_file_t
+{
+    std::string path;
+
+    // The handle from dlopen() and the newInstance pointer, or nullptr
+    void *handle = nullptr;
+    void *new_instance = nullptr;
+
+    // The reason why the plugin could not be opened
+    std::string error;
+
+    // Time spent in dlopen() and dlsym()
+    int64_t load_us = 0;
 };
 
 struct plugin_manager_t
@@ -26,13 +46,17 @@ struct plugin_manager_t
     void reload_dynamic_plugins();
     wf::wl_idle_call idle_reload_plugins;
 
+    /** @return The load times of all loaded plugins. */
+    std::vector<plugin_load_time_t> get_load_times() const;
+
   private:
     wf::option_wrapper_t<std::string> plugins_opt;
+    wf::option_wrapper_t<int> load_threads_opt;
     std::unordered_map<std::string, loaded_plugin_t> loaded_plugins;
 
     void deinit_plugins(bool unloadable);
 
-    std::optional<loaded_plugin_t> load_plugin_from_file(std::string path);
+    loaded_plugin_t load_plugin_from_file(const plugin_file_t& file);
     void load_static_plugins();
     void destroy_plugin(loaded_plugin_t& plugin);
 };
@@ -60,6 +84,25 @@ B union_cast(A object)
  */
 std::pair<void*, void*> get_new_instance_handle(const std::string& path);
 
+/**
+ * Open a plugin file and check it for version errors, like
+ * get_new_instance_handle(), but without logging.
+ *
+ * This runs the static constructors of the plugin, so it must be called on
+ * the main thread.
+ */
+plugin_file_t open_plugin_file(const std::string& path);
+
+/**
+ * Open several plugin files in order with open_plugin_file(), while up to
+ * @param threads - 1 worker threads read the files ahead. The plugins are
+ * not instantiated.
+ *
+ * @return The opened files, in the same order as @param paths.
+ */
+std::vector<plugin_file_t> open_plugin_files(
+    const std::vector<std::string>& paths, int threads);
+
 /**
  * List the locations where wayfire's plugins are installed.
  * This function takes care of env variable WAYFIRE_PLUGIN_PATH,
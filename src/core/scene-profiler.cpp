@@ -0,0 +1,257 @@
+#include <wayfire/scene-profiler.hpp>
+#include <wayfire/core.hpp>
+#include <algorithm>
+#include <any>
+#include <chrono>
+
+namespace wf
+{
+namespace scene
+{
+namespace
+{
+static int64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/** The data of an instruction which was redirected to a profiled instance. */
+struct profiled_instruction_t
+{
+    render_instance_t *instance;
+    std::any data;
+};
+
+/**
+ * A render instance which forwards everything to the instance it wraps, and
+ * records the time spent in it and in the instructions it scheduled.
+ */
+class profiled_render_instance_t : public render_instance_t
+{
+    render_instance_uptr inner;
+    std::shared_ptr<node_profile_t> profile;
+    // The instance of the instruction rendered last. run_render_pass() sends
+    // presentation feedback right after rendering each instruction.
+    render_instance_t *last_rendered = nullptr;
+
+  public:
+    profiled_render_instance_t(render_instance_uptr inner, std::shared_ptr<node_profile_t> profile)
+    {
+        this->inner   = std::move(inner);
+        this->profile = std::move(profile);
+        ++this->profile->render_instances;
+    }
+
+    ~profiled_render_instance_t()
+    {
+        --profile->render_instances;
+    }
+
+    void schedule_instructions(std::vector<render_instruction_t>& instructions,
+        const wf::render_target_t& target, wf::region_t& damage) override
+    {
+        const size_t first = instructions.size();
+        auto start = std::chrono::steady_clock::now();
+        inner->schedule_instructions(instructions, target, damage);
+        profile->schedule_ns += elapsed_ns(start);
+        ++profile->schedule_calls;
+
+        // Route the new instructions through us, so that they can be timed
+        for (size_t i = first; i < instructions.size(); i++)
+        {
+            auto& instr = instructions[i];
+            instr.data     = profiled_instruction_t{instr.instance, std::move(instr.data)};
+            instr.instance = this;
+        }
+    }
+
+    void render(const wf::render_target_t& target, const wf::region_t& region,
+        const std::any& data) override
+    {
+        auto& instr = std::any_cast<const profiled_instruction_t&>(data);
+        last_rendered = instr.instance;
+
+        auto start = std::chrono::steady_clock::now();
+        instr.instance->render(target, region, instr.data);
+        profile->render_ns += elapsed_ns(start);
+        ++profile->render_calls;
+    }
+
+    void presentation_feedback(wf::output_t *output) override
+    {
+        if (last_rendered)
+        {
+            last_rendered->presentation_feedback(output);
+        }
+    }
+
+    direct_scanout try_scanout(wf::output_t *output) override
+    {
+        return inner->try_scanout(output);
+    }
+
+    void compute_visibility(wf::output_t *output, wf::region_t& visible) override
+    {
+        inner->compute_visibility(output, visible);
+    }
+};
+}
+
+scene_profiler_t::scene_profiler_t()
+{
+    on_render_pass_begin = [=] (render_pass_begin_signal*)
+    {
+        ++passes;
+        for (auto& [node, profile] : profiles)
+        {
+            while (!profile->damage.empty() && (profile->damage.front().pass + history < passes))
+            {
+                profile->damage.pop_front();
+            }
+        }
+    };
+
+    on_root_update = [=] (root_node_update_signal *ev)
+    {
+        if (ev->flags & update_flag::CHILDREN_LIST)
+        {
+            track_tree(wf::get_core().scene().get());
+        }
+    };
+}
+
+scene_profiler_t::~scene_profiler_t() = default;
+
+void scene_profiler_t::set_enabled(bool enabled)
+{
+    if (this->enabled == enabled)
+    {
+        return;
+    }
+
+    this->enabled = enabled;
+    auto& root = wf::get_core().scene();
+    if (enabled)
+    {
+        passes = 0;
+        wf::get_core().connect(&on_render_pass_begin);
+        root->connect(&on_root_update);
+        track_tree(root.get());
+    } else
+    {
+        on_render_pass_begin.disconnect();
+        on_root_update.disconnect();
+        profiles.clear();
+    }
+
+    // Regenerate the render instances, with or without profiling
+    scene::update(root, update_flag::CHILDREN_LIST);
+}
+
+void scene_profiler_t::set_history(size_t passes)
+{
+    this->history = std::max<size_t>(passes, 1);
+}
+
+const node_profile_t *scene_profiler_t::get_profile(node_t *node) const
+{
+    auto it = profiles.find(node);
+    if ((it == profiles.end()) || it->second->node.expired())
+    {
+        return nullptr;
+    }
+
+    return it->second.get();
+}
+
+void scene_profiler_t::reset()
+{
+    passes = 0;
+    for (auto& [node, profile] : profiles)
+    {
+        profile->damage.clear();
+        profile->schedule_calls = 0;
+        profile->schedule_ns    = 0;
+        profile->render_calls   = 0;
+        profile->render_ns = 0;
+    }
+}
+
+void scene_profiler_t::wrap_instances(node_t *node, std::vector<render_instance_uptr>& instances,
+    size_t from)
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    auto profile = get_or_create(node);
+    for (size_t i = from; i < instances.size(); i++)
+    {
+        instances[i] = std::make_unique<profiled_render_instance_t>(std::move(instances[i]), profile);
+    }
+}
+
+std::shared_ptr<node_profile_t> scene_profiler_t::get_or_create(node_t *node)
+{
+    auto& profile = profiles[node];
+    if (!profile || profile->node.expired())
+    {
+        // A new node, or a new node at the address of a destroyed one
+        profile = std::make_shared<node_profile_t>();
+        profile->node = node->weak_from_this();
+        profile->on_damage = [=, p = profile.get()] (node_damage_signal *ev)
+        {
+            record_damage(*p, ev->region);
+        };
+        node->connect(&profile->on_damage);
+    }
+
+    return profile;
+}
+
+void scene_profiler_t::track_tree(node_t *root)
+{
+    // Drop the profiles of destroyed nodes
+    for (auto it = profiles.begin(); it != profiles.end();)
+    {
+        if (it->second->node.expired())
+        {
+            it = profiles.erase(it);
+        } else
+        {
+            ++it;
+        }
+    }
+
+    std::vector<node_t*> stack = {root};
+    while (!stack.empty())
+    {
+        auto node = stack.back();
+        stack.pop_back();
+        get_or_create(node);
+        for (auto& ch : node->get_children())
+        {
+            stack.push_back(ch.get());
+        }
+    }
+}
+
+void scene_profiler_t::record_damage(node_profile_t& profile, const wf::region_t& region)
+{
+    if (profile.damage.empty() || (profile.damage.back().pass != passes))
+    {
+        profile.damage.push_back({passes, region});
+    } else
+    {
+        profile.damage.back().region |= region;
+    }
+
+    while (profile.damage.size() > history)
+    {
+        profile.damage.pop_front();
+    }
+}
+}
+}
@@ -16,6 +16,7 @@
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/util.hpp"
 #include <wayfire/core.hpp>
+#include <wayfire/scene-profiler.hpp>
 
 namespace wf
 {
@@ -236,11 +237,14 @@ void node_t::gen_render_instances(std::vector<render_instance_uptr> & instances,
         std::make_unique<default_render_instance_t>(this, push_damage));
 
     // Add children as a flat list to avoid multiple indirections
+    auto& profiler = wf::get_core().scene_profiler;
     for (auto& ch : this->children)
     {
         if (ch->is_enabled())
         {
+            const size_t first = instances.size();
             ch->gen_render_instances(instances, push_damage, output);
+            profiler->wrap_instances(ch.get(), instances, first);
         }
     }
 }
@@ -326,12 +330,15 @@ class output_render_instance_t : public default_render_instance_t
 
         // Children are stored as a sublist, because we need to translate every
         // time between global and output-local geometry.
+        auto& profiler = wf::get_core().scene_profiler;
         for (auto& child : self->get_children())
         {
             if (child->is_enabled())
             {
+                const size_t first = children.size();
                 child->gen_render_instances(children,
                     transform_damage(callback), shown_on);
+                profiler->wrap_instances(child.get(), children, first);
             }
         }
     }
@@ -340,7 +347,13 @@ class output_render_instance_t : public default_render_instance_t
     {
         return [=] (const wf::region_t& damage)
         {
-            child_damage(damage + wf::origin(output->get_layout_geometry()));
+            auto global = damage + wf::origin(output->get_layout_geometry());
+            if (self->damage_clip)
+            {
+                global &= *self->damage_clip;
+            }
+
+            child_damage(global);
         };
     }
 
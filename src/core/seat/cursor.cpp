@@ -23,9 +23,14 @@ wf::cursor_t::cursor_t(wf::seat_t *seat)
     wlr_cursor_warp(cursor, NULL, cursor->x, cursor->y);
     init_xcursor();
 
-    config_reloaded = [=] (auto)
+    config_reloaded = [=] (wf::reload_config_signal *ev)
     {
-        init_xcursor();
+        // Loading the theme is expensive, do it only if it changed
+        if (ev->diff.option_changed("input/cursor_theme") ||
+            ev->diff.option_changed("input/cursor_size"))
+        {
+            init_xcursor();
+        }
     };
 
     wf::get_core().connect(&config_reloaded);
@@ -43,6 +48,24 @@ void wf::cursor_t::add_new_device(wlr_input_device *dev)
     wlr_cursor_attach_input_device(cursor, dev);
 }
 
+/* Motion events may be coalesced by the pointer, all other pointer events
+ * have to see the effects of the motion before them. */
+template<class EventType>
+static bool flushes_motion(EventType*)
+{
+    return true;
+}
+
+static bool flushes_motion(wlr_pointer_motion_event*)
+{
+    return false;
+}
+
+static bool flushes_motion(wlr_pointer_motion_absolute_event*)
+{
+    return false;
+}
+
 void wf::cursor_t::setup_listeners()
 {
     auto& core = wf::get_core_impl();
@@ -60,6 +83,10 @@ void wf::cursor_t::setup_listeners()
     on_ ## evname.set_callback([&] (void *data) { \
         set_touchscreen_mode(false); \
         auto ev   = static_cast<wlr_pointer_ ## evname ## _event*>(data); \
+        if (flushes_motion(ev)) \
+        { \
+            seat->priv->lpointer->flush_pending_motion(); \
+        } \
         auto mode = emit_device_event_signal(ev); \
         seat->priv->lpointer->handle_pointer_ ## evname(ev, mode); \
         wlr_idle_notify_activity(core.protocols.idle, core.get_current_seat()); \
@@ -89,6 +116,7 @@ void wf::cursor_t::setup_listeners()
     on_tablet_ ## evname.set_callback([&] (void *data) { \
         set_touchscreen_mode(false); \
         auto ev = static_cast<wlr_tablet_tool_ ## evname ## _event*>(data); \
+        seat->priv->lpointer->flush_pending_motion(); \
         auto handling_mode = emit_device_event_signal(ev); \
         if (ev->tablet->data) { \
             auto tablet = \
@@ -3,28 +3,23 @@
 #include "wayfire/debug.hpp"
 #include <wayfire/output-layout.hpp>
 
-void wf::hotspot_instance_t::process_input_motion(wf::pointf_t gc)
-{
-    const auto& reset_hotspot = [&] ()
-    {
-        timer.disconnect();
-        this->armed = true;
-    };
+/* Output indices are kept for a few output geometries, usually one per output */
+static constexpr size_t MAX_OUTPUT_INDICES = 8;
 
-    auto target = wf::get_core().output_layout->get_output_coords_at(gc, gc);
-    if (target != last_output)
-    {
-        reset_hotspot();
-        last_output = target;
-        recalc_geometry();
-    }
+enum index_edge_t
+{
+    INDEX_TOP    = 0,
+    INDEX_BOTTOM = 1,
+    INDEX_LEFT   = 2,
+    INDEX_RIGHT  = 3,
+};
 
-    if (!(hotspot_geometry[0] & gc) && !(hotspot_geometry[1] & gc))
-    {
-        reset_hotspot();
-        return;
-    }
+static const uint32_t index_edges[4] = {
+    OUTPUT_EDGE_TOP, OUTPUT_EDGE_BOTTOM, OUTPUT_EDGE_LEFT, OUTPUT_EDGE_RIGHT,
+};
 
+void wf::hotspot_instance_t::enter()
+{
     if (!timer.is_connected() && this->armed)
     {
         this->armed = false;
@@ -36,15 +31,14 @@ void wf::hotspot_instance_t::process_input_motion(wf::pointf_t gc)
     }
 }
 
-wf::geometry_t wf::hotspot_instance_t::pin(wf::dimensions_t dim) noexcept
+void wf::hotspot_instance_t::leave()
 {
-    if (!last_output)
-    {
-        return {0, 0, 0, 0};
-    }
-
-    auto og = last_output->get_layout_geometry();
+    timer.disconnect();
+    this->armed = true;
+}
 
+wf::geometry_t wf::hotspot_instance_t::pin(wf::geometry_t og, wf::dimensions_t dim) const noexcept
+{
     wf::geometry_t result;
     result.width  = dim.width;
     result.height = dim.height;
@@ -75,14 +69,14 @@ wf::geometry_t wf::hotspot_instance_t::pin(wf::dimensions_t dim) noexcept
     return wf::clamp(result, og);
 }
 
-void wf::hotspot_instance_t::recalc_geometry() noexcept
+void wf::hotspot_instance_t::get_regions(wf::geometry_t og, wf::geometry_t regions[2]) const noexcept
 {
     uint32_t cnt_edges = __builtin_popcount(edges);
 
     if (cnt_edges == 2)
     {
-        hotspot_geometry[0] = pin({away, along});
-        hotspot_geometry[1] = pin({along, away});
+        regions[0] = pin(og, {away, along});
+        regions[1] = pin(og, {along, away});
     } else
     {
         wf::dimensions_t dim;
@@ -94,46 +88,231 @@ void wf::hotspot_instance_t::recalc_geometry() noexcept
             dim = {along, away};
         }
 
-        hotspot_geometry[0] = pin(dim);
-        hotspot_geometry[1] = hotspot_geometry[0];
+        regions[0] = pin(og, dim);
+        regions[1] = regions[0];
     }
 }
 
 wf::hotspot_instance_t::hotspot_instance_t(uint32_t edges, uint32_t along, uint32_t away, int32_t timeout,
     std::function<void(uint32_t)> callback)
 {
-    wf::get_core().connect(&on_motion_event);
-    wf::get_core().connect(&on_motion_event);
-    wf::get_core().connect(&on_touch_motion);
-
     this->edges = edges;
     this->along = along;
     this->away  = away;
     this->timeout_ms = timeout;
     this->callback   = callback;
+}
+
+void wf::hotspot_manager_t::output_index_t::add(hotspot_instance_t *hotspot)
+{
+    entry_t entry;
+    entry.hotspot = hotspot;
+    hotspot->get_regions(geometry, entry.regions);
 
-    recalc_geometry();
+    auto& a = entry.regions[0];
+    auto& b = entry.regions[1];
+    entry.bounds.x     = std::min(a.x, b.x);
+    entry.bounds.y     = std::min(a.y, b.y);
+    entry.bounds.width = std::max(a.x + a.width, b.x + b.width) - entry.bounds.x;
+    entry.bounds.height = std::max(a.y + a.height, b.y + b.height) - entry.bounds.y;
+
+    const auto& g = geometry;
+    const int reach[4] = {
+        entry.bounds.y + entry.bounds.height - g.y,
+        g.y + g.height - entry.bounds.y,
+        entry.bounds.x + entry.bounds.width - g.x,
+        g.x + g.width - entry.bounds.x,
+    };
+
+    bool attached = false;
+    for (int i = 0; i < 4; i++)
+    {
+        if (hotspot->get_edges() & index_edges[i])
+        {
+            edges[i].push_back(entry);
+            depth[i] = std::max(depth[i], reach[i]);
+            attached = true;
+        }
+    }
 
-    // callbacks
+    if (!attached)
+    {
+        other.push_back(entry);
+    }
+}
+
+void wf::hotspot_manager_t::output_index_t::finalize()
+{
+    for (int i = 0; i < 4; i++)
+    {
+        const bool horizontal = (i == INDEX_TOP) || (i == INDEX_BOTTOM);
+        std::sort(edges[i].begin(), edges[i].end(), [=] (const entry_t& a, const entry_t& b)
+        {
+            return horizontal ? (a.bounds.x < b.bounds.x) : (a.bounds.y < b.bounds.y);
+        });
+    }
+}
+
+bool wf::hotspot_manager_t::output_index_t::query(wf::pointf_t point,
+    std::vector<hotspot_instance_t*>& result) const
+{
+    const auto& g = geometry;
+    const bool in_band[4] = {
+        point.y < g.y + depth[INDEX_TOP],
+        point.y >= g.y + g.height - depth[INDEX_BOTTOM],
+        point.x < g.x + depth[INDEX_LEFT],
+        point.x >= g.x + g.width - depth[INDEX_RIGHT],
+    };
+
+    const auto& test = [&] (const entry_t& entry)
+    {
+        if (((entry.regions[0] & point) || (entry.regions[1] & point)) &&
+            (std::find(result.begin(), result.end(), entry.hotspot) == result.end()))
+        {
+            result.push_back(entry.hotspot);
+        }
+    };
+
+    bool tested = !other.empty();
+    for (int i = 0; i < 4; i++)
+    {
+        if (!in_band[i])
+        {
+            continue;
+        }
+
+        tested = true;
+        const bool horizontal = (i == INDEX_TOP) || (i == INDEX_BOTTOM);
+        const double along    = horizontal ? point.x : point.y;
+        for (const auto& entry : edges[i])
+        {
+            if ((horizontal ? entry.bounds.x : entry.bounds.y) > along)
+            {
+                break;
+            }
+
+            test(entry);
+        }
+    }
+
+    for (const auto& entry : other)
+    {
+        test(entry);
+    }
+
+    return tested;
+}
+
+wf::hotspot_manager_t::output_index_t& wf::hotspot_manager_t::get_index(wf::geometry_t geometry)
+{
+    for (auto& index : indices)
+    {
+        if (index.geometry == geometry)
+        {
+            index.last_used = ++use_counter;
+            return index;
+        }
+    }
+
+    if (indices.size() >= MAX_OUTPUT_INDICES)
+    {
+        auto oldest = std::min_element(indices.begin(), indices.end(), [] (auto& a, auto& b)
+        {
+            return a.last_used < b.last_used;
+        });
+        indices.erase(oldest);
+    }
+
+    output_index_t index{geometry};
+    for (auto& hotspot : hotspots)
+    {
+        index.add(hotspot.get());
+    }
+
+    index.finalize();
+    index.last_used = ++use_counter;
+    indices.push_back(std::move(index));
+    return indices.back();
+}
+
+void wf::hotspot_manager_t::process_motion(wf::output_t *output,
+    wf::geometry_t output_geometry, wf::pointf_t point)
+{
+    ++stats.events;
+    inside_scratch.clear();
+    if (output && !hotspots.empty())
+    {
+        stats.tested += get_index(output_geometry).query(point, inside_scratch);
+    }
+
+    const bool same_output = (output == active_output);
+    for (auto hotspot : active)
+    {
+        if (!same_output ||
+            (std::find(inside_scratch.begin(), inside_scratch.end(), hotspot) == inside_scratch.end()))
+        {
+            hotspot->leave();
+        }
+    }
+
+    for (auto hotspot : inside_scratch)
+    {
+        if (!same_output || (std::find(active.begin(), active.end(), hotspot) == active.end()))
+        {
+            hotspot->enter();
+            ++stats.entered;
+        }
+    }
+
+    std::swap(active, inside_scratch);
+    active_output = output;
+}
+
+void wf::hotspot_manager_t::process_global_motion(wf::pointf_t point)
+{
+    auto output = wf::get_core().output_layout->get_output_coords_at(point, point);
+    process_motion(output, output ? output->get_layout_geometry() : wf::geometry_t{0, 0, 0, 0}, point);
+}
+
+wf::hotspot_manager_t::hotspot_manager_t()
+{
     on_tablet_axis = [=] (wf::post_input_event_signal<wlr_tablet_tool_axis_event> *ev)
     {
-        process_input_motion(wf::get_core().get_cursor_position());
+        process_global_motion(wf::get_core().get_cursor_position());
     };
 
     on_motion_event = [=] (auto)
     {
-        process_input_motion(wf::get_core().get_cursor_position());
+        process_global_motion(wf::get_core().get_cursor_position());
     };
 
     on_touch_motion = [=] (auto)
     {
-        process_input_motion(wf::get_core().get_touch_position(0));
+        process_global_motion(wf::get_core().get_touch_position(0));
     };
+
+    wf::get_core().connect(&on_motion_event);
+    wf::get_core().connect(&on_tablet_axis);
+    wf::get_core().connect(&on_touch_motion);
 }
 
-void wf::hotspot_manager_t::update_hotspots(const container_t& activators)
+void wf::hotspot_manager_t::add_hotspot(std::unique_ptr<hotspot_instance_t> hotspot)
 {
+    hotspots.push_back(std::move(hotspot));
+    indices.clear();
+}
+
+void wf::hotspot_manager_t::clear()
+{
+    active.clear();
+    active_output = nullptr;
     hotspots.clear();
+    indices.clear();
+}
+
+void wf::hotspot_manager_t::update_hotspots(const container_t& activators)
+{
+    clear();
     for (const auto& opt : activators)
     {
         auto opt_hotspots = opt->activated_by->get_value().get_hotspots();
@@ -149,9 +328,8 @@ void wf::hotspot_manager_t::update_hotspots(const container_t& activators)
                 (*activator_cb)(data);
             };
 
-            auto instance = std::make_unique<hotspot_instance_t>(hs.get_edges(),
-                hs.get_size_along_edge(), hs.get_size_away_from_edge(), hs.get_timeout(), callback);
-            hotspots.push_back(std::move(instance));
+            add_hotspot(std::make_unique<hotspot_instance_t>(hs.get_edges(),
+                hs.get_size_along_edge(), hs.get_size_away_from_edge(), hs.get_timeout(), callback));
         }
     }
 }
@@ -33,11 +33,26 @@ class hotspot_instance_t
     hotspot_instance_t(uint32_t edges, uint32_t along, uint32_t away, int32_t timeout,
         std::function<void(uint32_t)> callback);
 
-  private:
-    /** The possible hotspot rectangles */
-    wf::geometry_t hotspot_geometry[2];
-    wf::output_t *last_output = nullptr;
+    /**
+     * Calculate the rectangles of the hotspot on an output with the given
+     * layout geometry. Hotspots in a corner have two rectangles, one along each
+     * edge, for the others both rectangles are the same.
+     */
+    void get_regions(wf::geometry_t output, wf::geometry_t regions[2]) const noexcept;
+
+    /** @return The edges of the output the hotspot is attached to. */
+    uint32_t get_edges() const
+    {
+        return edges;
+    }
 
+    /** The input entered the hotspot. Starts the activation timer. */
+    void enter();
+
+    /** The input left the hotspot. Cancels the activation and re-arms the hotspot. */
+    void leave();
+
+  private:
     /** Requested dimensions */
     int32_t along, away;
 
@@ -59,34 +74,110 @@ class hotspot_instance_t
     /** Callback to execute */
     std::function<void(uint32_t)> callback;
 
-    wf::signal::connection_t<wf::post_input_event_signal<wlr_tablet_tool_axis_event>> on_tablet_axis;
-    wf::signal::connection_t<wf::post_input_event_signal<wlr_pointer_motion_event>> on_motion_event;
-    wf::signal::connection_t<wf::post_input_event_signal<wlr_touch_motion_event>> on_touch_motion;
-
-    /** Update state based on input motion */
-    void process_input_motion(wf::pointf_t gc);
-
     /** Calculate a rectangle with size @dim inside @og at the correct edges. */
-    wf::geometry_t pin(wf::dimensions_t dim) noexcept;
-
-    /** Recalculate the hotspot geometries. */
-    void recalc_geometry() noexcept;
+    wf::geometry_t pin(wf::geometry_t og, wf::dimensions_t dim) const noexcept;
 };
 
 /**
- * Manages hotspot bindings on the given output.
+ * Manages all hotspot bindings.
  * A part of the bindings_repository_t.
+ *
+ * The hotspot manager resolves the output under the input once per motion
+ * event. For each output geometry, it indexes the hotspots by the edges they
+ * are attached to, so that motion away from the edges is rejected with a
+ * few comparisons. Hotspots are notified only when the input enters or
+ * leaves them.
  */
 class hotspot_manager_t
 {
   public:
-    hotspot_manager_t()
-    {}
+    hotspot_manager_t();
 
     using container_t = binding_container_t<activatorbinding_t, activator_callback>;
     void update_hotspots(const container_t& activators);
 
+    /** Add a single hotspot. */
+    void add_hotspot(std::unique_ptr<hotspot_instance_t> hotspot);
+
+    /** Remove all hotspots. */
+    void clear();
+
+    /**
+     * Process a motion event of the cursor or touch point.
+     *
+     * @param output The output the input is on, or nullptr.
+     * @param output_geometry The layout geometry of that output.
+     * @param point The input position, in output-layout coordinates.
+     */
+    void process_motion(wf::output_t *output, wf::geometry_t output_geometry, wf::pointf_t point);
+
+    struct stats_t
+    {
+        /** Number of processed motion events. */
+        uint64_t events = 0;
+        /** Number of events which needed to test hotspot rectangles. */
+        uint64_t tested = 0;
+        /** Number of times a hotspot was entered. */
+        uint64_t entered = 0;
+    };
+
+    stats_t stats;
+
   private:
     std::vector<std::unique_ptr<hotspot_instance_t>> hotspots;
+
+    /** The hotspots of a single output geometry. */
+    struct output_index_t
+    {
+        struct entry_t
+        {
+            wf::geometry_t regions[2];
+            /* The bounding box of both regions */
+            wf::geometry_t bounds;
+            hotspot_instance_t *hotspot;
+        };
+
+        explicit output_index_t(wf::geometry_t geometry) : geometry(geometry)
+        {}
+
+        wf::geometry_t geometry;
+
+        /**
+         * The hotspots attached to each edge (top, bottom, left, right), sorted
+         * by their start along the edge. Corner hotspots are in two lists.
+         */
+        std::vector<entry_t> edges[4];
+        /** How far the hotspots of each edge reach into the output. */
+        int depth[4] = {0, 0, 0, 0};
+        /** Hotspots not attached to any edge. */
+        std::vector<entry_t> other;
+
+        uint64_t last_used = 0;
+
+        void add(hotspot_instance_t *hotspot);
+        void finalize();
+
+        /**
+         * Find the hotspots which contain the point.
+         * @return Whether the point was close enough to any hotspot to be tested.
+         */
+        bool query(wf::pointf_t point, std::vector<hotspot_instance_t*>& result) const;
+    };
+
+    /** Indices for recently used output geometries. */
+    std::vector<output_index_t> indices;
+    uint64_t use_counter = 0;
+    output_index_t& get_index(wf::geometry_t geometry);
+
+    /** The hotspots which contain the input, and the output they are on. */
+    std::vector<hotspot_instance_t*> active;
+    wf::output_t *active_output = nullptr;
+    std::vector<hotspot_instance_t*> inside_scratch;
+
+    void process_global_motion(wf::pointf_t point);
+
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_tablet_tool_axis_event>> on_tablet_axis;
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_pointer_motion_event>> on_motion_event;
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_touch_motion_event>> on_touch_motion;
 };
 }
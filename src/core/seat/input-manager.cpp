@@ -153,8 +153,16 @@ wf::input_manager_t::input_manager_t()
     });
     input_device_created.connect(&wf::get_core().backend->events.new_input);
 
-    config_updated = [=] (auto)
+    config_updated = [=] (wf::reload_config_signal *ev)
     {
+        if (!ev->diff.section_changed("input") &&
+            !ev->diff.section_with_prefix_changed("input-device:"))
+        {
+            return;
+        }
+
+        // Keyboards hold their own references, changed ones look up their keymaps again
+        keymap_cache.clear();
         for (auto& dev : input_devices)
         {
             dev->update_options();
@@ -6,6 +6,7 @@
 #include <chrono>
 
 #include "seat-impl.hpp"
+#include "keymap-cache.hpp"
 #include "wayfire/plugin.hpp"
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/view.hpp"
@@ -37,6 +38,9 @@ class input_manager_t
      */
     uint32_t locked_mods = 0;
 
+    /** Compiled keymaps, shared by all keyboards */
+    keymap_cache_t keymap_cache;
+
     /**
      * Go through all input devices and map them to outputs as specified in the
      * config file or by hints in the wlroots backend.
@@ -25,10 +25,12 @@ void wf::keyboard_t::setup_listeners()
 
     on_key.set_callback([&] (void *data)
     {
-        auto ev   = static_cast<wlr_keyboard_key_event*>(data);
-        auto mode = emit_device_event_signal(ev);
-
+        auto ev = static_cast<wlr_keyboard_key_event*>(data);
         auto& seat = wf::get_core_impl().seat;
+        /* Bindings and focus changes have to see where the pointer is now */
+        seat->priv->lpointer->flush_pending_motion();
+
+        auto mode = emit_device_event_signal(ev);
         seat->priv->set_keyboard(this);
 
         if (!handle_keyboard_key(ev->keycode, ev->state) &&
@@ -126,33 +128,21 @@ void wf::keyboard_t::reload_input_options()
 
     this->dirty_options = false;
 
-    auto ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-
-    /* Copy memory to stack, so that .c_str() is valid */
-    std::string rules   = this->rules;
-    std::string model   = this->model;
-    std::string layout  = this->layout;
-    std::string variant = this->variant;
-    std::string options = this->options;
-
-    xkb_rule_names names;
-    names.rules   = rules.c_str();
-    names.model   = model.c_str();
-    names.layout  = layout.c_str();
-    names.variant = variant.c_str();
-    names.options = options.c_str();
-    auto keymap = xkb_map_new_from_names(ctx, &names,
-        XKB_KEYMAP_COMPILE_NO_FLAGS);
+    wf::keymap_names_t names;
+    names.rules   = this->rules;
+    names.model   = this->model;
+    names.layout  = this->layout;
+    names.variant = this->variant;
+    names.options = this->options;
 
+    auto& cache = wf::get_core_impl().input->keymap_cache;
+    auto keymap = cache.get_keymap(names);
     if (!keymap)
     {
-        LOGE("Could not create keymap with given configuration:",
-            " rules=\"", rules, "\" model=\"", model, "\" layout=\"", layout,
-            "\" variant=\"", variant, "\" options=\"", options, "\"");
+        LOGE("Could not create keymap with given configuration: ", names.to_string());
 
-        // reset to NULL
-        std::memset(&names, 0, sizeof(names));
-        keymap = xkb_map_new_from_names(ctx, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        // reset to the defaults
+        keymap = cache.get_keymap({});
     }
 
     xkb_mod_mask_t locked_mods = 0;
@@ -169,7 +159,6 @@ void wf::keyboard_t::reload_input_options()
 
     wlr_keyboard_set_keymap(handle, keymap);
     xkb_keymap_unref(keymap);
-    xkb_context_unref(ctx);
 
     wlr_keyboard_set_repeat_info(handle, repeat_rate, repeat_delay);
 
@@ -0,0 +1,267 @@
+#include "keymap-cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <wayfire/debug.hpp>
+#include <wayfire/util.hpp>
+#include <wayfire/util/log.hpp>
+
+/* Keyboards rarely use more than a few different configurations */
+static constexpr size_t MAX_CACHED_KEYMAPS = 8;
+static const std::string CACHE_FILE_MAGIC  = "wayfire-keymap-cache v1";
+
+std::string wf::keymap_names_t::to_string() const
+{
+    return "rules=\"" + rules + "\" model=\"" + model + "\" layout=\"" + layout +
+           "\" variant=\"" + variant + "\" options=\"" + options + "\"";
+}
+
+size_t wf::keymap_names_hash_t::operator ()(const keymap_names_t& names) const
+{
+    return std::hash<std::string>{}(names.to_string());
+}
+
+wf::keymap_cache_t::keymap_cache_t()
+{
+    context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+}
+
+wf::keymap_cache_t::~keymap_cache_t()
+{
+    clear();
+    xkb_context_unref(context);
+}
+
+void wf::keymap_cache_t::clear()
+{
+    for (auto& [names, entry] : keymaps)
+    {
+        xkb_keymap_unref(entry.keymap);
+    }
+
+    keymaps.clear();
+}
+
+xkb_keymap*wf::keymap_cache_t::get_keymap(const keymap_names_t& names)
+{
+    auto it = keymaps.find(names);
+    if (it != keymaps.end())
+    {
+        ++stats.hits;
+        it->second.last_used = ++use_counter;
+        return xkb_keymap_ref(it->second.keymap);
+    }
+
+    int64_t start = wf::get_current_time_usec();
+    auto keymap   = load_keymap(names);
+    int64_t elapsed = wf::get_current_time_usec() - start;
+    stats.load_us += elapsed;
+
+    if (!keymap)
+    {
+        return nullptr;
+    }
+
+    LOGD("Loaded keymap ", names.to_string(), " in ", elapsed, "us");
+    evict_unused();
+    keymaps[names] = entry_t{keymap, ++use_counter};
+    return xkb_keymap_ref(keymap);
+}
+
+xkb_keymap*wf::keymap_cache_t::load_keymap(const keymap_names_t& names)
+{
+    if (disk_cache_enabled)
+    {
+        if (auto keymap = read_from_disk(names))
+        {
+            ++stats.disk_hits;
+            return keymap;
+        }
+    }
+
+    xkb_rule_names rmlvo;
+    rmlvo.rules   = names.rules.c_str();
+    rmlvo.model   = names.model.c_str();
+    rmlvo.layout  = names.layout.c_str();
+    rmlvo.variant = names.variant.c_str();
+    rmlvo.options = names.options.c_str();
+
+    auto keymap = xkb_keymap_new_from_names(context, &rmlvo, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (!keymap)
+    {
+        return nullptr;
+    }
+
+    ++stats.compiled;
+    if (disk_cache_enabled)
+    {
+        write_to_disk(names, keymap);
+    }
+
+    return keymap;
+}
+
+void wf::keymap_cache_t::evict_unused()
+{
+    while (keymaps.size() >= MAX_CACHED_KEYMAPS)
+    {
+        auto oldest = std::min_element(keymaps.begin(), keymaps.end(),
+            [] (const auto& a, const auto& b)
+        {
+            return a.second.last_used < b.second.last_used;
+        });
+
+        xkb_keymap_unref(oldest->second.keymap);
+        keymaps.erase(oldest);
+    }
+}
+
+std::string wf::keymap_cache_t::get_cache_file(const keymap_names_t& names)
+{
+    std::string cache_dir = nonull(getenv("XDG_CACHE_HOME"));
+    if ((cache_dir == "nil") || cache_dir.empty())
+    {
+        cache_dir = std::string(nonull(getenv("HOME"))) + "/.cache";
+    }
+
+    char hash[32];
+    snprintf(hash, sizeof(hash), "%016zx", keymap_names_hash_t{} (names));
+    return cache_dir + "/wayfire/keymaps/" + hash + ".xkb";
+}
+
+/** @return The newest modification time of the files under @param dir. */
+static int64_t get_newest_mtime(const std::filesystem::path& dir)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    int64_t newest = 0;
+    for (auto it = fs::recursive_directory_iterator(dir, ec); !ec && (it != fs::end(it));
+         it.increment(ec))
+    {
+        struct stat st;
+        if (stat(it->path().c_str(), &st) == 0)
+        {
+            newest = std::max<int64_t>(newest, st.st_mtime);
+        }
+    }
+
+    return newest;
+}
+
+std::string wf::keymap_cache_t::get_data_stamp(const keymap_names_t& names)
+{
+    /* Empty names are replaced by libxkbcommon with these variables. */
+    std::string stamp;
+    for (auto var : {"XKB_DEFAULT_RULES", "XKB_DEFAULT_MODEL", "XKB_DEFAULT_LAYOUT",
+        "XKB_DEFAULT_VARIANT", "XKB_DEFAULT_OPTIONS"})
+    {
+        stamp += std::string(nonull(getenv(var))) + ";";
+    }
+
+    /* The rules file of the system data is shipped together with the rest of
+     * the xkb data, so it is updated whenever the data is. The include paths
+     * in the home directory (~/.config/xkb, ~/.xkb) are edited by hand, so
+     * every file in them is checked. */
+    const std::string home  = nonull(getenv("HOME"));
+    const std::string rules = names.rules.empty() ? "evdev" : names.rules;
+    bool found_rules = false;
+    for (unsigned int i = 0; i < xkb_context_num_include_paths(context); i++)
+    {
+        std::string include_path = xkb_context_include_path_get(context, i);
+        if (!home.empty() && (include_path.rfind(home + "/", 0) == 0))
+        {
+            stamp += include_path + ":" + std::to_string(get_newest_mtime(include_path)) + ";";
+            continue;
+        }
+
+        std::string path = include_path + "/rules/" + rules;
+        struct stat st;
+        if (!found_rules && (stat(path.c_str(), &st) == 0))
+        {
+            stamp += path + ":" + std::to_string(st.st_mtime) + ":" + std::to_string(st.st_size);
+            found_rules = true;
+        }
+    }
+
+    return found_rules ? stamp : "";
+}
+
+xkb_keymap*wf::keymap_cache_t::read_from_disk(const keymap_names_t& names)
+{
+    auto stamp = get_data_stamp(names);
+    if (stamp.empty())
+    {
+        return nullptr;
+    }
+
+    std::ifstream file(get_cache_file(names));
+    std::string magic, key, file_stamp;
+    if (!std::getline(file, magic) || !std::getline(file, key) ||
+        !std::getline(file, file_stamp))
+    {
+        return nullptr;
+    }
+
+    if ((magic != CACHE_FILE_MAGIC) || (key != names.to_string()) || (file_stamp != stamp))
+    {
+        return nullptr;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return xkb_keymap_new_from_string(context, contents.str().c_str(),
+        XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
+}
+
+void wf::keymap_cache_t::write_to_disk(const keymap_names_t& names, xkb_keymap *keymap)
+{
+    auto stamp = get_data_stamp(names);
+    if (stamp.empty())
+    {
+        return;
+    }
+
+    char *serialized = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    if (!serialized)
+    {
+        return;
+    }
+
+    std::filesystem::path path = get_cache_file(names);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    /* Write to a temporary file first, so that other instances never read a
+     * partially written keymap. */
+    auto tmp_path = path;
+    tmp_path += ".tmp" + std::to_string(getpid());
+    bool written;
+    {
+        std::ofstream file(tmp_path);
+        file << CACHE_FILE_MAGIC << "\n" << names.to_string() << "\n" << stamp << "\n" << serialized;
+        file.close();
+        written = !file.fail();
+    }
+
+    free(serialized);
+    if (!written)
+    {
+        LOGD("Failed to write keymap cache file ", tmp_path.string());
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec)
+    {
+        LOGD("Failed to write keymap cache file ", path.string(), ": ", ec.message());
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
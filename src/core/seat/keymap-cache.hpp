@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <xkbcommon/xkbcommon.h>
+#include <wayfire/option-wrapper.hpp>
+
+namespace wf
+{
+/**
+ * The rules, model, layout, variant and options from which a keymap is
+ * compiled.
+ */
+struct keymap_names_t
+{
+    std::string rules;
+    std::string model;
+    std::string layout;
+    std::string variant;
+    std::string options;
+
+    bool operator ==(const keymap_names_t& other) const
+    {
+        return rules == other.rules && model == other.model &&
+               layout == other.layout && variant == other.variant &&
+               options == other.options;
+    }
+
+    /** A single-line description, used for logging and in the disk cache. */
+    std::string to_string() const;
+};
+
+struct keymap_names_hash_t
+{
+    size_t operator ()(const keymap_names_t& names) const;
+};
+
+/**
+ * A cache of compiled xkb keymaps.
+ *
+ * Compiling a keymap takes tens of milliseconds, so keyboards with the same
+ * configuration share the same keymap, which is compiled only once. Keymaps
+ * are immutable once created, so sharing them is safe.
+ *
+ * Optionally (see input/xkb_keymap_cache), compiled keymaps are also stored
+ * in serialized form under $XDG_CACHE_HOME/wayfire/keymaps, so that they can
+ * be loaded without compiling them again at the next startup.
+ */
+class keymap_cache_t
+{
+  public:
+    keymap_cache_t();
+    ~keymap_cache_t();
+
+    keymap_cache_t(const keymap_cache_t&) = delete;
+    keymap_cache_t& operator =(const keymap_cache_t&) = delete;
+
+    /**
+     * Get the keymap for the given names, compiling it if it is not cached.
+     *
+     * @return A new reference to the keymap, or nullptr if it could not be
+     *   compiled. The caller has to unref the keymap.
+     */
+    xkb_keymap *get_keymap(const keymap_names_t& names);
+
+    /**
+     * Drop all keymaps from the memory cache. Done when the input options are
+     * reloaded, so that changes to the xkb files are picked up.
+     */
+    void clear();
+
+    struct stats_t
+    {
+        /** Lookups served from memory. */
+        int hits = 0;
+        /** Keymaps loaded from the disk cache. */
+        int disk_hits = 0;
+        /** Keymaps compiled from the names. */
+        int compiled   = 0;
+        /** Total time spent loading or compiling keymaps. */
+        int64_t load_us = 0;
+    };
+
+    stats_t stats;
+
+  private:
+    xkb_context *context;
+
+    struct entry_t
+    {
+        xkb_keymap *keymap;
+        uint64_t last_used;
+    };
+
+    std::unordered_map<keymap_names_t, entry_t, keymap_names_hash_t> keymaps;
+    uint64_t use_counter = 0;
+
+    wf::option_wrapper_t<bool> disk_cache_enabled{"input/xkb_keymap_cache"};
+
+    xkb_keymap *load_keymap(const keymap_names_t& names);
+    void evict_unused();
+
+    /** @return The path of the file for the given names in the disk cache. */
+    std::string get_cache_file(const keymap_names_t& names);
+
+    /**
+     * @return A string which changes whenever the xkb data files, the user's
+     *   xkb files or the XKB_DEFAULT_* variables change, so that stale keymaps
+     *   in the disk cache are not used. Empty if no xkb data was found.
+     */
+    std::string get_data_stamp(const keymap_names_t& names);
+
+    xkb_keymap *read_from_disk(const keymap_names_t& names);
+    void write_to_disk(const keymap_names_t& names, xkb_keymap *keymap);
+};
+}
@@ -11,6 +11,7 @@
 #include <wayfire/util/log.hpp>
 #include <wayfire/core.hpp>
 #include <wayfire/output-layout.hpp>
+#include <wayfire/output.hpp>
 
 wf::pointer_t::pointer_t(nonstd::observer_ptr<wf::input_manager_t> input,
     nonstd::observer_ptr<seat_t> seat)
@@ -81,6 +82,7 @@ void wf::pointer_t::update_cursor_position(int64_t time_msec, bool real_update)
     {
         const auto& scene = wf::get_core().scene();
         auto isec = scene->find_node_at(gc);
+        ++motion_stats.hit_tests;
         update_cursor_focus(isec ? isec->node->shared_from_this() : nullptr);
     }
 
@@ -199,6 +201,62 @@ void wf::pointer_t::grab_surface(wf::scene::node_ptr node)
     update_cursor_position(get_current_time(), false);
 }
 
+/* -------------------------- Motion coalescing ----------------------------- */
+
+/** @return The refresh interval of the output at the given point, in ms. */
+static uint32_t get_frame_interval_ms(wf::pointf_t point)
+{
+    auto wo = wf::get_core().output_layout->get_output_at(point.x, point.y);
+    if (!wo || (wo->handle->refresh <= 0))
+    {
+        return 16;
+    }
+
+    return std::max(1, 1'000'000 / wo->handle->refresh);
+}
+
+void wf::pointer_t::handle_cursor_moved(uint32_t time_msec)
+{
+    ++motion_stats.motion_events;
+    if (!coalesce_motion)
+    {
+        update_cursor_position(time_msec);
+        return;
+    }
+
+    /* The cursor itself has already moved, and the drag icon follows it
+     * immediately as well. Finding the node under the cursor and notifying it
+     * is postponed until the next frame. */
+    seat->priv->update_drag_icon();
+    motion_pending = true;
+    pending_motion_time = time_msec;
+    if (!flush_motion_timer.is_connected())
+    {
+        auto gc = seat->priv->cursor->get_cursor_position();
+        flush_motion_timer.set_timeout(get_frame_interval_ms(gc), [=] ()
+        {
+            flush_pending_motion();
+            return false;
+        });
+    }
+}
+
+void wf::pointer_t::flush_pending_motion()
+{
+    if (!motion_pending)
+    {
+        return;
+    }
+
+    motion_pending = false;
+    flush_motion_timer.disconnect();
+    ++motion_stats.flushes;
+
+    update_cursor_position(pending_motion_time);
+    /* The frames of the coalesced events were not sent */
+    wlr_seat_pointer_notify_frame(seat->seat);
+}
+
 /* ----------------------- Input event processing --------------------------- */
 void wf::pointer_t::handle_pointer_button(wlr_pointer_button_event *ev,
     input_event_processing_mode_t mode)
@@ -293,7 +351,7 @@ void wf::pointer_t::handle_pointer_motion(wlr_pointer_motion_event *ev,
 {
     /* XXX: maybe warp directly? */
     wlr_cursor_move(seat->priv->cursor->cursor, &ev->pointer->base, ev->delta_x, ev->delta_y);
-    update_cursor_position(ev->time_msec);
+    handle_cursor_moved(ev->time_msec);
 }
 
 void wf::pointer_t::handle_pointer_motion_absolute(
@@ -313,7 +371,7 @@ void wf::pointer_t::handle_pointer_motion_absolute(
 
     // TODO: indirection via wf_cursor
     wlr_cursor_warp_closest(seat->priv->cursor->cursor, NULL, cx, cy);
-    update_cursor_position(ev->time_msec);
+    handle_cursor_moved(ev->time_msec);
 }
 
 void wf::pointer_t::handle_pointer_axis(wlr_pointer_axis_event *ev,
@@ -410,5 +468,11 @@ void wf::pointer_t::handle_pointer_hold_end(wlr_pointer_hold_end_event *ev,
 
 void wf::pointer_t::handle_pointer_frame()
 {
+    if (motion_pending)
+    {
+        // Sent together with the coalesced motion
+        return;
+    }
+
     wlr_seat_pointer_notify_frame(seat->seat);
 }
@@ -7,6 +7,7 @@
 #include <wayfire/util.hpp>
 #include <wayfire/option-wrapper.hpp>
 #include "wayfire/scene-input.hpp"
+#include "wayfire/core.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include "wayfire/signal-provider.hpp"
 #include <wayfire/nonstd/wlroots-full.hpp>
@@ -84,6 +85,18 @@ class pointer_t
      */
     void update_cursor_position(int64_t time_msec, bool real_update = true);
 
+    /**
+     * Process the motion events which were coalesced since the last flush,
+     * see input/coalesce_pointer_motion. No-op if there are none.
+     *
+     * Called before every other pointer, keyboard, touch and tablet tool
+     * event, so that they see the focus of the latest cursor position.
+     */
+    void flush_pending_motion();
+
+    /** Counters of the motion processing */
+    pointer_motion_stats_t motion_stats;
+
     /**
      * Transfer focus and pressed buttons to the given grab.
      */
@@ -115,6 +128,22 @@ class pointer_t
     /** Number of currently-pressed mouse buttons */
     int count_pressed_buttons = 0;
 
+    wf::option_wrapper_t<bool> coalesce_motion{"input/coalesce_pointer_motion"};
+
+    /* Whether there are coalesced motion events which have not been
+     * processed yet, and the time of the last of them */
+    bool motion_pending = false;
+    uint32_t pending_motion_time = 0;
+    /* Flushes the coalesced motion once per frame of the output under the
+     * cursor */
+    wf::wl_timer flush_motion_timer;
+
+    /**
+     * Update the cursor focus and send motion after the cursor was moved by a
+     * device, either immediately or at the next flush.
+     */
+    void handle_cursor_moved(uint32_t time_msec);
+
     /** Check whether an implicit grab should start/end */
     void check_implicit_grab();
 
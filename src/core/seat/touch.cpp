@@ -5,6 +5,7 @@
 
 #include "touch.hpp"
 #include "cursor.hpp"
+#include "pointer.hpp"
 #include "input-manager.hpp"
 #include "../core-impl.hpp"
 #include "wayfire/core.hpp"
@@ -23,7 +24,8 @@ wf::touch_interface_t::touch_interface_t(wlr_cursor *cursor, wlr_seat *seat,
     // connect handlers
     on_down.set_callback([=] (void *data)
     {
-        auto ev   = static_cast<wlr_touch_down_event*>(data);
+        auto ev = static_cast<wlr_touch_down_event*>(data);
+        wf::get_core_impl().seat->priv->lpointer->flush_pending_motion();
         auto mode = emit_device_event_signal(ev);
 
         double lx, ly;
@@ -38,7 +40,8 @@ wf::touch_interface_t::touch_interface_t(wlr_cursor *cursor, wlr_seat *seat,
 
     on_up.set_callback([=] (void *data)
     {
-        auto ev   = static_cast<wlr_touch_up_event*>(data);
+        auto ev = static_cast<wlr_touch_up_event*>(data);
+        wf::get_core_impl().seat->priv->lpointer->flush_pending_motion();
         auto mode = emit_device_event_signal(ev);
         handle_touch_up(ev->touch_id, ev->time_msec, mode);
         wlr_idle_notify_activity(wf::get_core().protocols.idle,
@@ -48,7 +51,8 @@ wf::touch_interface_t::touch_interface_t(wlr_cursor *cursor, wlr_seat *seat,
 
     on_motion.set_callback([=] (void *data)
     {
-        auto ev   = static_cast<wlr_touch_motion_event*>(data);
+        auto ev = static_cast<wlr_touch_motion_event*>(data);
+        wf::get_core_impl().seat->priv->lpointer->flush_pending_motion();
         auto mode = emit_device_event_signal(ev);
 
         double lx, ly;
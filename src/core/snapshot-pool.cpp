@@ -0,0 +1,179 @@
+#include <wayfire/snapshot-pool.hpp>
+#include <wayfire/core.hpp>
+#include <wayfire/memory-accounting.hpp>
+#include <algorithm>
+#include <cmath>
+
+static size_t buffer_size(const wf::framebuffer_t& buffer)
+{
+    return (size_t)buffer.viewport_width * buffer.viewport_height * 4;
+}
+
+/** @return Smallest multiple of the bucket size which is >= x */
+static int round_to_bucket(int x)
+{
+    const int bucket = wf::snapshot_pool_t::BUCKET_SIZE;
+    return std::max(1, (x + bucket - 1) / bucket) * bucket;
+}
+
+wf::snapshot_pool_t::snapshot_pool_t(allocator_t allocator)
+{
+    if (!allocator.allocate)
+    {
+        allocator.allocate = [] (int width, int height)
+        {
+            static const wf::memory_tag_t snapshot_tag = {"core", "snapshot"};
+            wf::memory_tag_scope_t memory_scope{snapshot_tag};
+            wf::framebuffer_t buffer;
+            OpenGL::render_begin();
+            buffer.allocate(width, height);
+            OpenGL::render_end();
+            return buffer;
+        };
+    }
+
+    if (!allocator.free)
+    {
+        allocator.free = [] (wf::framebuffer_t& buffer)
+        {
+            if (wf::get_core().get_current_state() == compositor_state_t::SHUTDOWN)
+            {
+                // The renderer may already be gone
+                buffer.reset();
+                return;
+            }
+
+            OpenGL::render_begin();
+            buffer.release();
+            OpenGL::render_end();
+        };
+    }
+
+    this->allocator = std::move(allocator);
+}
+
+wf::snapshot_pool_t::~snapshot_pool_t()
+{
+    /* The pool of core is destroyed only at exit, when the renderer no longer
+     * exists, so the buffers are not freed explicitly. */
+}
+
+wf::framebuffer_t wf::snapshot_pool_t::acquire(int width, int height)
+{
+    width  = round_to_bucket(width);
+    height = round_to_bucket(height);
+    ++stats.buffers_in_use;
+
+    // Take the most recently used buffer of the bucket, it is the most
+    // likely to still be in the caches of the GPU.
+    auto best = idle.end();
+    for (auto it = idle.begin(); it != idle.end(); ++it)
+    {
+        if ((it->buffer.viewport_width == width) && (it->buffer.viewport_height == height) &&
+            ((best == idle.end()) || (it->last_used > best->last_used)))
+        {
+            best = it;
+        }
+    }
+
+    if (best != idle.end())
+    {
+        ++stats.hits;
+        auto buffer = best->buffer;
+        stats.idle_bytes -= buffer_size(buffer);
+        *best = idle.back();
+        idle.pop_back();
+        return buffer;
+    }
+
+    ++stats.misses;
+    auto buffer = allocator.allocate(width, height);
+    stats.allocated_bytes += buffer_size(buffer);
+    return buffer;
+}
+
+void wf::snapshot_pool_t::release(wf::framebuffer_t buffer)
+{
+    --stats.buffers_in_use;
+    stats.idle_bytes += buffer_size(buffer);
+    idle.push_back({buffer, ++use_counter});
+    evict_over_budget();
+}
+
+void wf::snapshot_pool_t::set_budget(size_t bytes)
+{
+    budget = bytes;
+    evict_over_budget();
+}
+
+void wf::snapshot_pool_t::clear()
+{
+    for (auto& entry : idle)
+    {
+        free_buffer(entry.buffer);
+    }
+
+    idle.clear();
+    stats.idle_bytes = 0;
+}
+
+void wf::snapshot_pool_t::free_buffer(wf::framebuffer_t& buffer)
+{
+    stats.allocated_bytes -= buffer_size(buffer);
+    allocator.free(buffer);
+}
+
+void wf::snapshot_pool_t::evict_over_budget()
+{
+    while (stats.idle_bytes > budget)
+    {
+        auto oldest = std::min_element(idle.begin(), idle.end(),
+            [] (const auto& a, const auto& b)
+        {
+            return a.last_used < b.last_used;
+        });
+
+        stats.idle_bytes -= buffer_size(oldest->buffer);
+        ++stats.evictions;
+        free_buffer(oldest->buffer);
+        *oldest = idle.back();
+        idle.pop_back();
+    }
+}
+
+wf::texture_t wf::get_subbuffer_texture(const wf::render_target_t& target)
+{
+    wf::texture_t texture{target.tex};
+    if (target.subbuffer && (target.viewport_width > 0) && (target.viewport_height > 0))
+    {
+        // The subbuffer has (0,0) at the top-left, while textures start at
+        // the bottom-left.
+        const auto& sub = target.subbuffer.value();
+        const float width  = target.viewport_width;
+        const float height = target.viewport_height;
+        texture.has_viewport    = true;
+        texture.viewport_box.x1 = sub.x / width;
+        texture.viewport_box.x2 = (sub.x + sub.width) / width;
+        texture.viewport_box.y1 = 1.0 - (sub.y + sub.height) / height;
+        texture.viewport_box.y2 = 1.0 - sub.y / height;
+    }
+
+    return texture;
+}
+
+wf::pooled_snapshot_t::pooled_snapshot_t(wf::geometry_t geometry, float scale)
+{
+    const int width  = std::max(1, (int)std::ceil(geometry.width * scale));
+    const int height = std::max(1, (int)std::ceil(geometry.height * scale));
+
+    wf::framebuffer_t& buffer = target;
+    buffer = wf::get_core().snapshot_pool->acquire(width, height);
+    target.geometry  = geometry;
+    target.scale     = scale;
+    target.subbuffer = wf::geometry_t{0, 0, width, height};
+}
+
+wf::pooled_snapshot_t::~pooled_snapshot_t()
+{
+    wf::get_core().snapshot_pool->release(target);
+}
@@ -0,0 +1,265 @@
+#include <wayfire/view-registry.hpp>
+#include <algorithm>
+
+static wf::view_registry_keys_t keys_of(wayfire_view view)
+{
+    return wf::view_registry_keys_t{
+        .id     = view->get_id(),
+        .app_id = view->get_app_id(),
+        .output = view->get_output(),
+        .role   = view->role,
+    };
+}
+
+template<class Key>
+void wf::view_registry_t::index_insert(index_t<Key>& index, const Key& key,
+    uint32_t slot, size_t slot_t::*pos)
+{
+    auto& list = index[key];
+    slots[slot].*pos = list.size();
+    list.push_back(slot);
+}
+
+template<class Key>
+void wf::view_registry_t::index_erase(index_t<Key>& index, const Key& key,
+    uint32_t slot, size_t slot_t::*pos)
+{
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        return;
+    }
+
+    auto& list = it->second;
+    const size_t at = slots[slot].*pos;
+    list[at] = list.back();
+    slots[list[at]].*pos = at;
+    list.pop_back();
+
+    if (list.empty())
+    {
+        index.erase(it);
+    }
+}
+
+template<class Key>
+std::vector<wayfire_view> wf::view_registry_t::index_get(
+    const index_t<Key>& index, const Key& key) const
+{
+    std::vector<wayfire_view> result;
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        // The index lists are reordered on removal, but the positions in the
+        // list of all views follow the order in which views were added.
+        auto sorted = it->second;
+        std::sort(sorted.begin(), sorted.end(), [&] (uint32_t a, uint32_t b)
+        {
+            return slots[a].pos_all < slots[b].pos_all;
+        });
+
+        result.reserve(sorted.size());
+        for (auto slot : sorted)
+        {
+            result.push_back(slots[slot].view);
+        }
+    }
+
+    return result;
+}
+
+wf::view_handle_t wf::view_registry_t::add(wayfire_view view)
+{
+    return add(view, keys_of(view));
+}
+
+wf::view_handle_t wf::view_registry_t::add(wayfire_view view,
+    const view_registry_keys_t& keys)
+{
+    auto existing = get_handle(view);
+    if (existing.index != UINT32_MAX)
+    {
+        update(view, keys);
+        return existing;
+    }
+
+    uint32_t index;
+    if (free_slots.empty())
+    {
+        index = slots.size();
+        slots.emplace_back();
+    } else
+    {
+        index = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    // Keep the holes from bounding the memory if get_all() is never called
+    if (all_holes > all.size() / 2)
+    {
+        compact_all();
+    }
+
+    auto& slot = slots[index];
+    slot.view = view;
+    slot.used = true;
+    slot.keys = keys;
+
+    slot.pos_all = all.size();
+    all.push_back(view);
+    all_slots.push_back(index);
+    by_pointer[view.get()] = index;
+    index_slot(index);
+
+    return view_handle_t{index, slot.generation};
+}
+
+void wf::view_registry_t::remove(wayfire_view view)
+{
+    remove(get_handle(view));
+}
+
+void wf::view_registry_t::remove(view_handle_t handle)
+{
+    if (!get(handle))
+    {
+        return;
+    }
+
+    auto& slot = slots[handle.index];
+    unindex_slot(handle.index);
+    by_pointer.erase(slot.view.get());
+
+    // Leave a hole in the list of all views, to keep its order
+    all[slot.pos_all] = nullptr;
+    all_slots[slot.pos_all] = UINT32_MAX;
+    ++all_holes;
+
+    slot.view = nullptr;
+    slot.used = false;
+    ++slot.generation;
+    free_slots.push_back(handle.index);
+}
+
+void wf::view_registry_t::update(wayfire_view view)
+{
+    update(view, keys_of(view));
+}
+
+void wf::view_registry_t::update(wayfire_view view,
+    const view_registry_keys_t& keys)
+{
+    auto handle = get_handle(view);
+    if (handle.index == UINT32_MAX)
+    {
+        return;
+    }
+
+    unindex_slot(handle.index);
+    slots[handle.index].keys = keys;
+    index_slot(handle.index);
+}
+
+wayfire_view wf::view_registry_t::get(view_handle_t handle) const
+{
+    if ((handle.index >= slots.size()) || !slots[handle.index].used ||
+        (slots[handle.index].generation != handle.generation))
+    {
+        return nullptr;
+    }
+
+    return slots[handle.index].view;
+}
+
+wf::view_handle_t wf::view_registry_t::get_handle(wayfire_view view) const
+{
+    auto it = by_pointer.find(view.get());
+    if (it == by_pointer.end())
+    {
+        return {};
+    }
+
+    return view_handle_t{it->second, slots[it->second].generation};
+}
+
+wayfire_view wf::view_registry_t::find_by_id(uint32_t id) const
+{
+    auto it = by_id.find(id);
+    if (it == by_id.end())
+    {
+        return nullptr;
+    }
+
+    return slots[it->second].view;
+}
+
+size_t wf::view_registry_t::size() const
+{
+    return all.size() - all_holes;
+}
+
+const std::vector<wayfire_view>& wf::view_registry_t::get_all() const
+{
+    if (all_holes > 0)
+    {
+        compact_all();
+    }
+
+    return all;
+}
+
+void wf::view_registry_t::compact_all() const
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < all.size(); i++)
+    {
+        if (all_slots[i] == UINT32_MAX)
+        {
+            continue;
+        }
+
+        all[kept] = std::move(all[i]);
+        all_slots[kept] = all_slots[i];
+        slots[all_slots[kept]].pos_all = kept;
+        ++kept;
+    }
+
+    all.resize(kept);
+    all_slots.resize(kept);
+    all_holes = 0;
+}
+
+std::vector<wayfire_view> wf::view_registry_t::get_by_app_id(
+    const std::string& app_id) const
+{
+    return index_get(by_app_id, app_id);
+}
+
+std::vector<wayfire_view> wf::view_registry_t::get_by_output(
+    wf::output_t *output) const
+{
+    return index_get(by_output, output);
+}
+
+std::vector<wayfire_view> wf::view_registry_t::get_by_role(view_role_t role) const
+{
+    return index_get(by_role, (int)role);
+}
+
+void wf::view_registry_t::index_slot(uint32_t index)
+{
+    auto& keys = slots[index].keys;
+    by_id[keys.id] = index;
+    index_insert(by_app_id, keys.app_id, index, &slot_t::pos_app_id);
+    index_insert(by_output, keys.output, index, &slot_t::pos_output);
+    index_insert(by_role, (int)keys.role, index, &slot_t::pos_role);
+}
+
+void wf::view_registry_t::unindex_slot(uint32_t index)
+{
+    auto& keys = slots[index].keys;
+    by_id.erase(keys.id);
+    index_erase(by_app_id, keys.app_id, index, &slot_t::pos_app_id);
+    index_erase(by_output, keys.output, index, &slot_t::pos_output);
+    index_erase(by_role, (int)keys.role, index, &slot_t::pos_role);
+}
@@ -3,6 +3,7 @@
 #include "wayfire/signal-definitions.hpp"
 #include <string>
 #include <wayfire/config/file.hpp>
+#include <wayfire/config-diff.hpp>
 #include <wayfire/config-backend.hpp>
 #include <wayfire/plugin.hpp>
 #include <wayfire/core.hpp>
@@ -12,10 +13,17 @@
 
 #define INOT_BUF_SIZE (sizeof(inotify_event) + NAME_MAX + 1)
 
+/* Editors often write the file several times when saving, so the reload waits
+ * until the file has not changed for this long. */
+#define RELOAD_DELAY_MS 50
+
 static std::string config_dir, config_file;
 wf::config::config_manager_t *cfg_manager;
 
 static int wd_cfg_file;
+static wl_event_source *reload_timer;
+/* The configuration after the last reload */
+static wf::config_snapshot_t last_config;
 
 static void readd_watch(int fd)
 {
@@ -23,10 +31,32 @@ static void readd_watch(int fd)
     wd_cfg_file = inotify_add_watch(fd, config_file.c_str(), IN_MODIFY);
 }
 
-static void reload_config(int fd)
+static void reload_config()
 {
     wf::config::load_configuration_options_from_file(*cfg_manager, config_file);
-    readd_watch(fd);
+}
+
+/* The watches are added again by handle_config_updated(), which starts the
+ * timer. */
+static int handle_reload_timeout(void*)
+{
+    LOGD("Reloading configuration file");
+    reload_config();
+
+    auto config = wf::take_config_snapshot(*cfg_manager);
+    wf::reload_config_signal ev;
+    ev.diff = wf::compute_config_diff(last_config, config);
+    last_config = std::move(config);
+    if (ev.diff.empty())
+    {
+        LOGD("No options changed");
+        return 0;
+    }
+
+    LOGD("Changed options: ", ev.diff.changed_options.size(),
+        " in ", ev.diff.changed_sections.size(), " sections");
+    wf::get_core().emit(&ev);
+    return 0;
 }
 
 static int handle_config_updated(int fd, uint32_t mask, void *data)
@@ -68,16 +98,11 @@ static int handle_config_updated(int fd, uint32_t mask, void *data)
             (event->wd == wd_cfg_file) || (cfg_file_basename == event->name);
     }
 
+    readd_watch(fd);
     if (should_reload)
     {
-        LOGD("Reloading configuration file");
-
-        reload_config(fd);
-        wf::reload_config_signal ev;
-        wf::get_core().emit(&ev);
-    } else
-    {
-        readd_watch(fd);
+        // Restart the timer, so that a burst of writes is reloaded once
+        wl_event_source_timer_update(reload_timer, RELOAD_DELAY_MS);
     }
 
     return 0;
@@ -103,10 +128,13 @@ class dynamic_ini_config_t : public wf::config_backend_t
             get_xml_dirs(), SYSCONFDIR "/wayfire/defaults.ini", config_file);
 
         int inotify_fd = inotify_init1(IN_CLOEXEC);
-        reload_config(inotify_fd);
+        reload_config();
+        readd_watch(inotify_fd);
+        last_config = wf::take_config_snapshot(config);
 
-        wl_event_loop_add_fd(wl_display_get_event_loop(display),
-            inotify_fd, WL_EVENT_READABLE, handle_config_updated, NULL);
+        auto loop = wl_display_get_event_loop(display);
+        wl_event_loop_add_fd(loop, inotify_fd, WL_EVENT_READABLE, handle_config_updated, NULL);
+        reload_timer = wl_event_loop_add_timer(loop, handle_reload_timeout, NULL);
     }
 
     std::string choose_cfg_file(const std::string& cmdline_cfg_file)
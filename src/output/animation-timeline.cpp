@@ -0,0 +1,137 @@
+#include <wayfire/animation-timeline.hpp>
+#include <wayfire/util.hpp>
+#include <algorithm>
+
+wf::animation_timeline_t::animation_timeline_t(clock_t clock)
+{
+    this->clock = clock ? clock : [] () { return wf::get_current_time_usec(); };
+}
+
+wf::timeline_animation_id_t wf::animation_timeline_t::add(tick_callback_t callback)
+{
+    uint32_t index;
+    if (free_slots.empty())
+    {
+        index = slots.size();
+        slots.emplace_back();
+    } else
+    {
+        index = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    auto& slot = slots[index];
+    slot.callback = std::move(callback);
+    slot.removed  = false;
+    slot.position = running.size();
+    running.push_back(index);
+
+    return timeline_animation_id_t{index, slot.generation};
+}
+
+bool wf::animation_timeline_t::contains(timeline_animation_id_t id) const
+{
+    return (id.index < slots.size()) && (slots[id.index].generation == id.generation) &&
+           (slots[id.index].position != UINT32_MAX) && !slots[id.index].removed;
+}
+
+void wf::animation_timeline_t::remove(timeline_animation_id_t id)
+{
+    if (!contains(id))
+    {
+        return;
+    }
+
+    if (ticking)
+    {
+        // The callback may be running right now, release it after the tick
+        slots[id.index].removed = true;
+        removed_during_tick.push_back(id.index);
+    } else
+    {
+        release(id.index);
+    }
+}
+
+void wf::animation_timeline_t::release(uint32_t index)
+{
+    auto& slot = slots[index];
+
+    // Swap-remove from the running list
+    const uint32_t moved = running.back();
+    running[slot.position] = moved;
+    slots[moved].position  = slot.position;
+    running.pop_back();
+
+    slot.callback = nullptr;
+    slot.position = UINT32_MAX;
+    slot.removed  = false;
+    ++slot.generation;
+    free_slots.push_back(index);
+}
+
+size_t wf::animation_timeline_t::size() const
+{
+    return running.size() - removed_during_tick.size();
+}
+
+void wf::animation_timeline_t::tick(int64_t target_us)
+{
+    if (running.empty())
+    {
+        return;
+    }
+
+    const int64_t start = clock();
+    ticking = true;
+
+    // Animations added during the tick are appended, and run next time
+    const size_t count = running.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint32_t index = running[i];
+        if (slots[index].removed)
+        {
+            continue;
+        }
+
+        ++stats.animations_ticked;
+        bool keep = slots[index].callback(target_us);
+        if (!keep && !slots[index].removed)
+        {
+            slots[index].removed = true;
+            removed_during_tick.push_back(index);
+        }
+    }
+
+    ticking = false;
+    for (auto index : removed_during_tick)
+    {
+        release(index);
+    }
+
+    removed_during_tick.clear();
+
+    stats.last_tick_us   = clock() - start;
+    stats.total_tick_us += stats.last_tick_us;
+    stats.max_tick_us    = std::max(stats.max_tick_us, stats.last_tick_us);
+    ++stats.ticks;
+}
+
+int64_t wf::animation_timeline_t::predict_presentation(int64_t now_us,
+    int64_t last_present_us, int64_t refresh_us)
+{
+    if ((refresh_us <= 0) || (last_present_us <= 0))
+    {
+        return now_us;
+    }
+
+    if (now_us < last_present_us)
+    {
+        return last_present_us + refresh_us;
+    }
+
+    // The first vblank after now
+    const int64_t elapsed_frames = (now_us - last_present_us) / refresh_us + 1;
+    return last_present_us + elapsed_frames * refresh_us;
+}
@@ -20,6 +20,7 @@
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/nonstd/safe-list.hpp>
 #include <wayfire/util/log.hpp>
+#include <wayfire/memory-accounting.hpp>
 #include <wayfire/nonstd/wlroots-full.hpp>
 
 namespace wf
@@ -311,6 +312,8 @@ struct effect_hook_manager_t
     }
 };
 
+static const wf::memory_tag_t postprocessing_tag = {"core", "postprocessing buffer"};
+
 /**
  * A class to manage and run postprocessing effects
  */
@@ -360,6 +363,7 @@ struct postprocessing_manager_t
         output_width  = width;
         output_height = height;
 
+        wf::memory_tag_scope_t memory_scope{postprocessing_tag};
         OpenGL::render_begin();
         post_buffers[default_out_buffer].allocate(width, height);
         OpenGL::render_end();
@@ -400,6 +404,7 @@ struct postprocessing_manager_t
                 (post == post_effects.back() ? default_framebuffer :
                     post_buffers[next_buffer_idx]);
 
+            wf::memory_tag_scope_t memory_scope{postprocessing_tag};
             OpenGL::render_begin();
             /* Make sure we have the correct resolution */
             next_buffer.allocate(output_width, output_height);
@@ -472,6 +477,7 @@ class depth_buffer_manager_t
         for (auto& buffer : buffers)
         {
             GL_CALL(glDeleteTextures(1, &buffer.tex));
+            wf::get_core().memory_accounting->untrack(wf::memory_kind_t::GL_TEXTURE, buffer.tex);
         }
 
         OpenGL::render_end();
@@ -507,12 +513,16 @@ class depth_buffer_manager_t
         if (buffer.tex != (GLuint) - 1)
         {
             GL_CALL(glDeleteTextures(1, &buffer.tex));
+            wf::get_core().memory_accounting->untrack(wf::memory_kind_t::GL_TEXTURE, buffer.tex);
         }
 
         GL_CALL(glGenTextures(1, &buffer.tex));
         GL_CALL(glBindTexture(GL_TEXTURE_2D, buffer.tex));
         GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
             width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL));
+        static const wf::memory_tag_t depth_buffer_tag = {"core", "depth buffer"};
+        wf::get_core().memory_accounting->track(wf::memory_kind_t::GL_TEXTURE, buffer.tex,
+            (size_t)width * height * 4, depth_buffer_tag);
         buffer.width  = width;
         buffer.height = height;
 
@@ -735,6 +745,12 @@ class wf::render_manager::impl
     std::unique_ptr<depth_buffer_manager_t> depth_buffer_manager;
     std::unique_ptr<repaint_delay_manager_t> delay_manager;
 
+    wf::animation_timeline_t animation_timeline;
+    /* The time of the last presented frame and the refresh interval, in us */
+    wf::wl_listener_wrapper on_present;
+    int64_t last_present_us = 0;
+    int64_t refresh_us = 0;
+
     wf::option_wrapper_t<wf::color_t> background_color_opt;
 
     impl(output_t *o) :
@@ -772,6 +788,18 @@ class wf::render_manager::impl
         });
         on_frame.connect(&output_damage->damage_manager->events.frame);
 
+        on_present.set_callback([&] (void *data)
+        {
+            auto ev = static_cast<wlr_output_event_present*>(data);
+            if (ev->presented && ev->when)
+            {
+                last_present_us = ev->when->tv_sec * 1'000'000ll + ev->when->tv_nsec / 1000;
+            }
+
+            refresh_us = ev->refresh / 1000;
+        });
+        on_present.connect(&output->handle->events.present);
+
         background_color_opt.load_option("core/background_color");
         background_color_opt.set_callback([=] ()
         {
@@ -913,7 +941,13 @@ class wf::render_manager::impl
      */
     void paint()
     {
-        /* Part 1: frame setup: query damage, etc. */
+        /* Part 1: frame setup: advance animations, query damage, etc. */
+        if (animation_timeline.size())
+        {
+            animation_timeline.tick(wf::animation_timeline_t::predict_presentation(
+                wf::get_current_time_usec(), last_present_us, refresh_us));
+        }
+
         effects->run_effects(OUTPUT_EFFECT_PRE);
         effects->run_effects(OUTPUT_EFFECT_DAMAGE);
 
@@ -1121,6 +1155,11 @@ void render_manager::rem_effect(effect_hook_t *hook)
     pimpl->effects->rem_effect(hook);
 }
 
+animation_timeline_t& render_manager::get_animation_timeline()
+{
+    return pimpl->animation_timeline;
+}
+
 void render_manager::add_post(post_hook_t *hook)
 {
     pimpl->postprocessing->add_post(hook);
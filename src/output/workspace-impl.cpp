@@ -6,11 +6,14 @@
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/opengl.hpp>
 #include <list>
+#include <map>
+#include <tuple>
 #include <algorithm>
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/util/log.hpp>
 
 #include <wayfire/scene-operations.hpp>
+#include <wayfire/transaction/view-instructions.hpp>
 
 #include "../view/view-impl.hpp"
 #include "output-impl.hpp"
@@ -415,24 +418,6 @@ class output_viewport_manager_t
         }
     }
 
-    std::vector<wayfire_view> get_views_on_workspace(wf::point_t vp,
-        uint32_t layers_mask, bool include_minimized)
-    {
-        /* get all views in the given layers */
-        std::vector<wayfire_view> views =
-            output->workspace->get_views_in_layer(layers_mask, include_minimized);
-
-        /* remove those which aren't visible on the workspace */
-        auto it = std::remove_if(views.begin(), views.end(), [&] (wayfire_view view)
-        {
-            return !view_visible_on(view, vp);
-        });
-
-        views.erase(it, views.end());
-
-        return views;
-    }
-
     wf::point_t get_current_workspace()
     {
         return {current_vx, current_vy};
@@ -646,6 +631,171 @@ class output_workarea_manager_t
     }
 };
 
+/**
+ * output_view_list_cache_t is a part of the workspace_manager module. It keeps
+ * the lists of views in the output's layers and on its workspaces, so that
+ * repeated queries do not have to walk the scenegraph each time.
+ *
+ * The lists are rebuilt lazily. Lists of views in layers become stale when the
+ * structure of the scenegraph changes or a view is (un)minimized. Lists of
+ * views on workspaces additionally become stale when a view on the output is
+ * moved or made sticky, or when the current workspace changes.
+ */
+class output_view_list_cache_t
+{
+    struct cached_list_t
+    {
+        uint64_t version = 0;
+        wf::point_t current_ws;
+        std::vector<wayfire_view> views;
+    };
+
+    wf::output_t *output;
+    output_layer_manager_t& layer_manager;
+    output_viewport_manager_t& viewport_manager;
+
+    /* Bumped when the views in the layers change */
+    uint64_t layers_version = 1;
+    /* Bumped when any of the lists may have changed */
+    uint64_t version = 1;
+
+    std::map<std::pair<uint32_t, bool>, cached_list_t> layer_lists;
+    std::map<std::tuple<int, int, uint32_t, bool>, cached_list_t> workspace_lists;
+
+    void invalidate_layers()
+    {
+        ++layers_version;
+        ++version;
+    }
+
+    void invalidate_workspaces()
+    {
+        ++version;
+    }
+
+    wf::signal::connection_t<wf::scene::root_node_update_signal> on_scene_update =
+        [=] (wf::scene::root_node_update_signal *ev)
+    {
+        using namespace wf::scene::update_flag;
+        if (ev->flags & (CHILDREN_LIST | ENABLED))
+        {
+            invalidate_layers();
+        }
+    };
+
+    wf::signal::connection_t<view_minimized_signal> on_view_minimized =
+        [=] (view_minimized_signal *ev) { invalidate_layers(); };
+
+    // If a plugin carries out the request, the view's minimized flag changes
+    // without a scenegraph update
+    wf::signal::connection_t<view_minimize_request_signal> on_minimize_request =
+        [=] (view_minimize_request_signal *ev) { invalidate_layers(); };
+
+    wf::signal::connection_t<view_geometry_changed_signal> on_view_geometry_changed =
+        [=] (view_geometry_changed_signal *ev) { invalidate_workspaces(); };
+
+    wf::signal::connection_t<view_set_sticky_signal> on_view_sticky =
+        [=] (view_set_sticky_signal *ev) { invalidate_workspaces(); };
+
+    wf::signal::connection_t<output_configuration_changed_signal> on_output_changed =
+        [=] (output_configuration_changed_signal *ev) { invalidate_workspaces(); };
+
+    /** In debug mode, compare a cached list with the result of a full walk. */
+    void verify(const char *what, std::vector<wayfire_view>& cached,
+        std::vector<wayfire_view> expected)
+    {
+        if (cached != expected)
+        {
+            LOGE("Cached list of ", what, " on output ", output->to_string(),
+                " is out of date (", cached.size(), " views instead of ",
+                expected.size(), ")");
+            cached = std::move(expected);
+        }
+    }
+
+    std::vector<wayfire_view> walk_workspace(wf::point_t ws, uint32_t layers_mask,
+        bool include_minimized)
+    {
+        auto views = layer_manager.get_views_in_layer(layers_mask, include_minimized);
+        auto it    = std::remove_if(views.begin(), views.end(), [&] (wayfire_view view)
+        {
+            return !viewport_manager.view_visible_on(view, ws);
+        });
+
+        views.erase(it, views.end());
+        return views;
+    }
+
+  public:
+    output_view_list_cache_t(wf::output_t *output,
+        output_layer_manager_t& layer_manager,
+        output_viewport_manager_t& viewport_manager) :
+        output(output), layer_manager(layer_manager),
+        viewport_manager(viewport_manager)
+    {
+        wf::get_core().scene()->connect(&on_scene_update);
+        output->connect(&on_view_minimized);
+        output->connect(&on_minimize_request);
+        output->connect(&on_view_geometry_changed);
+        output->connect(&on_view_sticky);
+        output->connect(&on_output_changed);
+    }
+
+    uint64_t get_version() const
+    {
+        return version;
+    }
+
+    const std::vector<wayfire_view>& get_views_in_layer(uint32_t layers_mask,
+        bool include_minimized)
+    {
+        auto& list = layer_lists[{layers_mask, include_minimized}];
+        if (list.version != layers_version)
+        {
+            list.views   = layer_manager.get_views_in_layer(layers_mask, include_minimized);
+            list.version = layers_version;
+        } else
+        {
+            if (wf::log::enabled_categories[(size_t)wf::log::logging_category::VIEWS])
+            {
+                verify("views in layers", list.views,
+                    layer_manager.get_views_in_layer(layers_mask, include_minimized));
+            }
+        }
+
+        return list.views;
+    }
+
+    const std::vector<wayfire_view>& get_views_on_workspace(wf::point_t ws,
+        uint32_t layers_mask, bool include_minimized)
+    {
+        auto current = viewport_manager.get_current_workspace();
+        auto& list   = workspace_lists[{ws.x, ws.y, layers_mask, include_minimized}];
+        if ((list.version != version) || (list.current_ws != current))
+        {
+            const auto& in_layers = get_views_in_layer(layers_mask, include_minimized);
+            list.views.clear();
+            std::copy_if(in_layers.begin(), in_layers.end(),
+                std::back_inserter(list.views), [&] (wayfire_view view)
+            {
+                return viewport_manager.view_visible_on(view, ws);
+            });
+
+            list.version    = version;
+            list.current_ws = current;
+        } else
+        {
+            if (wf::log::enabled_categories[(size_t)wf::log::logging_category::VIEWS])
+            {
+                verify("views on workspace", list.views,
+                    walk_workspace(ws, layers_mask, include_minimized));
+            }
+        }
+
+        return list.views;
+    }
+};
+
 class workspace_manager::impl
 {
     wf::output_t *output;
@@ -679,6 +829,8 @@ class workspace_manager::impl
             return;
         }
 
+        // Resize all views together, in a single transaction
+        auto tx = wf::txn::transaction_t::create();
         for (auto& view : layer_manager.get_views_in_layer(MIDDLE_LAYERS, false))
         {
             if (!view->is_mapped())
@@ -692,10 +844,17 @@ class workspace_manager::impl
             float pw = 1. * wm.width / old_w;
             float ph = 1. * wm.height / old_h;
 
-            view->set_geometry({
-                    int(px * new_size.width), int(py * new_size.height),
-                    int(pw * new_size.width), int(ph * new_size.height)
-                });
+            wf::txn::view_state_t state;
+            state.geometry = wf::geometry_t{
+                int(px * new_size.width), int(py * new_size.height),
+                int(pw * new_size.width), int(ph * new_size.height)
+            };
+            tx->add_instruction(wf::txn::view_state_instruction_t::get(view, state));
+        }
+
+        if (!tx->get_objects().empty())
+        {
+            wf::txn::transaction_manager_t::get().submit(std::move(tx));
         }
 
         output_geometry = output->get_relative_geometry();
@@ -724,11 +883,13 @@ class workspace_manager::impl
     output_layer_manager_t layer_manager;
     output_viewport_manager_t viewport_manager;
     output_workarea_manager_t workarea_manager;
+    output_view_list_cache_t view_lists;
 
     impl(output_t *o) :
         layer_manager(o),
         viewport_manager(o),
-        workarea_manager(o)
+        workarea_manager(o),
+        view_lists(o, layer_manager, viewport_manager)
     {
         output = o;
         output_geometry = output->get_relative_geometry();
@@ -820,19 +981,18 @@ class workspace_manager::impl
 
     void update_promoted_views()
     {
-        auto vp    = viewport_manager.get_current_workspace();
-        auto views = viewport_manager.get_views_on_workspace(
+        auto vp = viewport_manager.get_current_workspace();
+        const auto& views = view_lists.get_views_on_workspace(
             vp, LAYER_WORKSPACE, false);
 
         /* Do not consider unmapped views */
-        auto it = std::remove_if(views.begin(), views.end(),
+        auto it = std::find_if(views.begin(), views.end(),
             [] (wayfire_view view) -> bool
         {
-            return !view->is_mapped();
+            return view->is_mapped();
         });
-        views.erase(it, views.end());
 
-        if (!views.empty() && views.front()->fullscreen)
+        if ((it != views.end()) && (*it)->fullscreen)
         {
             allow_promotion();
         } else
@@ -915,7 +1075,14 @@ bool workspace_manager::view_visible_on(wayfire_view view, wf::point_t ws)
 std::vector<wayfire_view> workspace_manager::get_views_on_workspace(wf::point_t ws,
     uint32_t layer_mask, bool include_minimized)
 {
-    return pimpl->viewport_manager.get_views_on_workspace(
+    return pimpl->view_lists.get_views_on_workspace(
+        ws, layer_mask, include_minimized);
+}
+
+const std::vector<wayfire_view>& workspace_manager::get_cached_views_on_workspace(
+    wf::point_t ws, uint32_t layer_mask, bool include_minimized)
+{
+    return pimpl->view_lists.get_views_on_workspace(
         ws, layer_mask, include_minimized);
 }
 
@@ -949,7 +1116,24 @@ uint32_t workspace_manager::get_view_layer(wayfire_view view)
 std::vector<wayfire_view> workspace_manager::get_views_in_layer(
     uint32_t layers_mask, bool include_minimized)
 {
-    return pimpl->layer_manager.get_views_in_layer(layers_mask, include_minimized);
+    return pimpl->view_lists.get_views_in_layer(layers_mask, include_minimized);
+}
+
+const std::vector<wayfire_view>& workspace_manager::get_cached_views_in_layer(
+    uint32_t layers_mask, bool include_minimized)
+{
+    return pimpl->view_lists.get_views_in_layer(layers_mask, include_minimized);
+}
+
+std::vector<wayfire_view> workspace_manager::get_minimized_views()
+{
+    // With an empty layer mask, only the minimized views are included
+    return pimpl->view_lists.get_views_in_layer(0, true);
+}
+
+uint64_t workspace_manager::get_view_lists_version()
+{
+    return pimpl->view_lists.get_version();
 }
 
 workspace_implementation_t*workspace_manager::get_workspace_implementation()
@@ -7,7 +7,9 @@
 #include <wayfire/workspace-stream.hpp>
 #include <wayfire/output.hpp>
 #include <wayfire/render-manager.hpp>
+#include <wayfire/signal-definitions.hpp>
 #include <wayfire/workspace-manager.hpp>
+#include <wayfire/memory-accounting.hpp>
 
 namespace wf
 {
@@ -16,6 +18,18 @@ class workspace_stream_node_t::workspace_stream_instance_t : public scene::
 {
     workspace_stream_node_t *self;
     std::vector<scene::render_instance_uptr> instances;
+    scene::damage_callback push_damage;
+
+    // Sticky views are damaged only on the current workspace, so other
+    // workspaces need to pick up their damage separately.
+    wf::signal::connection_t<output_sticky_damage_signal> on_sticky_damage =
+        [=] (output_sticky_damage_signal *ev)
+    {
+        if (self->ws != self->output->workspace->get_current_workspace())
+        {
+            push_damage(ev->region);
+        }
+    };
 
     wf::point_t get_offset()
     {
@@ -32,6 +46,9 @@ class workspace_stream_node_t::workspace_stream_instance_t : public scene::
         scene::damage_callback push_damage)
     {
         this->self = self;
+        this->push_damage = push_damage;
+        self->output->connect(&on_sticky_damage);
+
         auto acc_damage = [this, push_damage] (wf::region_t damage)
         {
             damage += -get_offset();
@@ -188,7 +205,16 @@ void workspace_stream_t::start_for_workspace(wf::output_t *output,
         }
     };
 
+    this->on_sticky_damage = [=] (output_sticky_damage_signal *ev)
+    {
+        if (ws != current_output->workspace->get_current_workspace())
+        {
+            accumulated_damage |= ev->region + wf::origin(current_output->render->get_ws_box(ws));
+        }
+    };
+
     wf::get_core().scene()->connect(&regen_instances);
+    output->connect(&on_sticky_damage);
     this->update_instances();
 }
 
@@ -203,6 +229,8 @@ void workspace_stream_t::render_frame()
         return;
     }
 
+    static const wf::memory_tag_t stream_tag = {"core", "workspace stream"};
+    wf::memory_tag_scope_t memory_scope{stream_tag};
     OpenGL::render_begin();
     buffer.allocate(current_output->handle->width, current_output->handle->height);
     OpenGL::render_end();
@@ -236,5 +264,6 @@ void workspace_stream_t::stop()
     this->accumulated_damage.clear();
     this->instances.clear();
     regen_instances.disconnect();
+    on_sticky_damage.disconnect();
 }
 } // namespace wf
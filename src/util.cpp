@@ -21,6 +21,14 @@ int64_t wf::get_current_time()
     return wf::timespec_to_msec(ts);
 }
 
+int64_t wf::get_current_time_usec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1'000'000ll + ts.tv_nsec / 1000;
+}
+
 static void handle_idle_listener(void *data)
 {
     auto call = (wf::wl_idle_call*)(data);
@@ -125,6 +125,23 @@ bool wf::color_rect_view_t::is_mapped() const
     return _is_mapped;
 }
 
+/**
+ * Emit the geometry changed signal on the view, core and the view's output,
+ * like for other views, so that output-wide listeners (for ex. the workspace
+ * manager's view lists) are updated too.
+ */
+static void emit_geometry_changed(wf::view_interface_t *view,
+    wf::view_geometry_changed_signal& data)
+{
+    data.view = view->self();
+    view->emit(&data);
+    wf::get_core().emit(&data);
+    if (view->get_output())
+    {
+        view->get_output()->emit(&data);
+    }
+}
+
 void wf::color_rect_view_t::move(int x, int y)
 {
     damage();
@@ -135,7 +152,7 @@ void wf::color_rect_view_t::move(int x, int y)
     this->geometry.y = y;
 
     damage();
-    emit(&data);
+    emit_geometry_changed(this, data);
 }
 
 void wf::color_rect_view_t::resize(int w, int h)
@@ -148,7 +165,7 @@ void wf::color_rect_view_t::resize(int w, int h)
     this->geometry.height = h;
 
     damage();
-    emit(&data);
+    emit_geometry_changed(this, data);
 }
 
 wf::geometry_t wf::color_rect_view_t::get_output_geometry()
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <map>
 #include <cstring>
 #include <cstdlib>
 
@@ -48,6 +49,13 @@ class wayfire_layer_shell_view : public wf::wlr_view_t
 
     void configure(wf::geometry_t geometry);
 
+    /**
+     * The size sent in the last configure. Reset when the client changes its
+     * desired size, anchor or margin, so that it always gets a configure in
+     * response to such a change.
+     */
+    wf::dimensions_t last_configured_size = {-1, -1};
+
     void set_output(wf::output_t *output) override;
 
     /** Calculate the target layer for this layer surface */
@@ -79,6 +87,35 @@ wf::workspace_manager::anchored_edge anchor_to_edge(uint32_t edges)
     abort();
 }
 
+/** Bits of the dirty mask of an output, in addition to the anchor edges. */
+enum layer_dirty_bits_t : uint32_t
+{
+    /* Exclusive zones or layers changed, arrange everything and reflow. */
+    LAYER_DIRTY_RESERVED = (1 << 4),
+    LAYER_DIRTY_ALL_EDGES = both_vert | both_horiz,
+};
+
+/** The anchor edges whose surfaces may need to be moved after a view changes. */
+static uint32_t dirty_edges_for(uint32_t anchor)
+{
+    /* Centered surfaces depend on all edges of the workarea */
+    return anchor ? anchor : LAYER_DIRTY_ALL_EDGES;
+}
+
+/**
+ * Check whether the state of a layer surface changed in a way which affects
+ * its position or size, or the reserved area of the output.
+ */
+static bool layout_state_changed(const wlr_layer_surface_v1_state& a,
+    const wlr_layer_surface_v1_state& b)
+{
+    return a.anchor != b.anchor || a.exclusive_zone != b.exclusive_zone ||
+           a.desired_width != b.desired_width ||
+           a.desired_height != b.desired_height ||
+           a.margin.top != b.margin.top || a.margin.bottom != b.margin.bottom ||
+           a.margin.left != b.margin.left || a.margin.right != b.margin.right;
+}
+
 struct wf_layer_shell_manager
 {
   private:
@@ -88,15 +125,34 @@ struct wf_layer_shell_manager
         auto outputs = wf::get_core().output_layout->get_outputs();
         for (auto wo : outputs)
         {
-            arrange_layers(wo);
+            schedule_arrange(wo, LAYER_DIRTY_RESERVED);
         }
     };
 
+    wf::signal::connection_t<wf::output_pre_remove_signal> on_output_removed =
+        [=] (wf::output_pre_remove_signal *ev)
+    {
+        dirty_outputs.erase(ev->output);
+    };
+
     wf_layer_shell_manager()
     {
         wf::get_core().output_layout->connect(&on_output_layout_changed);
+        wf::get_core().output_layout->connect(&on_output_removed);
     }
 
+    struct dirty_state_t
+    {
+        /* Anchor edges and LAYER_DIRTY_RESERVED */
+        uint32_t mask = 0;
+        /* Number of changes coalesced into the next arrangement */
+        int changes   = 0;
+    };
+
+    /* Outputs whose layer surfaces have to be arranged on the next idle */
+    std::map<wf::output_t*, dirty_state_t> dirty_outputs;
+    wf::wl_idle_call idle_arrange;
+
   public:
     static wf_layer_shell_manager& get_instance()
     {
@@ -111,10 +167,62 @@ struct wf_layer_shell_manager
     static constexpr int COUNT_LAYERS = 4;
     layer_t layers[COUNT_LAYERS];
 
+    /**
+     * Arrange the layer surfaces of the output on the next idle. Changes to
+     * the same output until then are coalesced into a single arrangement.
+     *
+     * @param dirty The anchor edges whose surfaces need to be repositioned, or
+     *   LAYER_DIRTY_RESERVED if the reserved areas need to be recalculated.
+     */
+    void schedule_arrange(wf::output_t *output, uint32_t dirty)
+    {
+        if (!output)
+        {
+            return;
+        }
+
+        auto& state = dirty_outputs[output];
+        state.mask |= dirty;
+        ++state.changes;
+
+        if (!idle_arrange.is_connected())
+        {
+            idle_arrange.run_once([=] () { arrange_dirty_outputs(); });
+        }
+    }
+
+    void arrange_dirty_outputs()
+    {
+        auto pending = std::move(dirty_outputs);
+        dirty_outputs.clear();
+
+        for (auto& [output, state] : pending)
+        {
+            wf::layer_shell_arranged_signal data;
+            data.output  = output;
+            data.changes = state.changes;
+            data.old_workarea = output->workspace->get_workarea();
+
+            if (state.mask & LAYER_DIRTY_RESERVED)
+            {
+                data.full = true;
+                data.configured = arrange_layers(output);
+            } else
+            {
+                data.full = false;
+                data.configured = arrange_edges(output, state.mask);
+            }
+
+            data.new_workarea = output->workspace->get_workarea();
+            output->emit(&data);
+            wf::get_core().emit(&data);
+        }
+    }
+
     void handle_map(wayfire_layer_shell_view *view)
     {
         layers[view->lsurface->current.layer].push_back(view);
-        arrange_layers(view->get_output());
+        schedule_arrange(view->get_output(), LAYER_DIRTY_RESERVED);
     }
 
     void remove_view_from_layer(wayfire_layer_shell_view *view, uint32_t layer)
@@ -141,7 +249,22 @@ struct wf_layer_shell_manager
     {
         view->remove_anchored(false);
         remove_view_from_layer(view, view->lsurface->current.layer);
-        arrange_layers(view->get_output());
+        schedule_arrange(view->get_output(), LAYER_DIRTY_RESERVED);
+    }
+
+    /** Handle a commit which changed the position, size or exclusive zone. */
+    void handle_layout_change(wayfire_layer_shell_view *view,
+        const wlr_layer_surface_v1_state& old_state)
+    {
+        auto& state = view->lsurface->current;
+        if ((state.exclusive_zone > 0) || (old_state.exclusive_zone > 0))
+        {
+            schedule_arrange(view->get_output(), LAYER_DIRTY_RESERVED);
+        } else
+        {
+            schedule_arrange(view->get_output(),
+                dirty_edges_for(state.anchor) | dirty_edges_for(old_state.anchor));
+        }
     }
 
     layer_t filter_views(wf::output_t *output, int layer)
@@ -260,7 +383,8 @@ struct wf_layer_shell_manager
         v->configure(box);
     }
 
-    void arrange_layer(wf::output_t *output, int layer)
+    /** @return The number of views which were configured. */
+    int arrange_layer(wf::output_t *output, int layer)
     {
         auto views = filter_views(output, layer);
 
@@ -278,6 +402,7 @@ struct wf_layer_shell_manager
             }
         }
 
+        int configured = 0;
         auto usable_workarea = output->workspace->get_workarea();
         for (auto v : views)
         {
@@ -286,12 +411,41 @@ struct wf_layer_shell_manager
             if (v->lsurface->pending.exclusive_zone < 1)
             {
                 pin_view(v, usable_workarea);
+                ++configured;
             }
         }
+
+        return configured;
+    }
+
+    /**
+     * Reposition only the surfaces without an exclusive zone which are
+     * anchored to one of the dirty edges. The reserved areas, and therefore
+     * the workarea, stay the same.
+     *
+     * @return The number of views which were configured.
+     */
+    int arrange_edges(wf::output_t *output, uint32_t edges)
+    {
+        int configured = 0;
+        auto usable_workarea = output->workspace->get_workarea();
+        for (auto v : filter_views(output))
+        {
+            if ((v->lsurface->pending.exclusive_zone < 1) &&
+                (dirty_edges_for(v->lsurface->current.anchor) & edges))
+            {
+                pin_view(v, usable_workarea);
+                ++configured;
+            }
+        }
+
+        return configured;
     }
 
     void arrange_unmapped_view(wayfire_layer_shell_view *view)
     {
+        /* Unmapped surfaces get a configure for each commit */
+        view->last_configured_size = {-1, -1};
         if (view->lsurface->pending.exclusive_zone < 1)
         {
             return pin_view(view, view->get_output()->workspace->get_workarea());
@@ -301,15 +455,21 @@ struct wf_layer_shell_manager
         view->get_output()->workspace->reflow_reserved_areas();
     }
 
-    void arrange_layers(wf::output_t *output)
-    {
-        auto views = filter_views(output);
-
-        arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY);
-        arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_TOP);
-        arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM);
-        arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND);
+    /**
+     * Arrange all layer surfaces on the output and reflow its reserved areas.
+     *
+     * @return The number of views without an exclusive zone which were
+     *   configured.
+     */
+    int arrange_layers(wf::output_t *output)
+    {
+        int configured = 0;
+        configured += arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY);
+        configured += arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_TOP);
+        configured += arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_BOTTOM);
+        configured += arrange_layer(output, ZWLR_LAYER_SHELL_V1_LAYER_BACKGROUND);
         output->workspace->reflow_reserved_areas();
+        return configured;
     }
 };
 
@@ -432,6 +592,7 @@ void wayfire_layer_shell_view::map(wlr_surface *surface)
     priv->keyboard_focus_enabled = lsurface->current.keyboard_interactive;
     handle_app_id_changed(nonull(lsurface->namespace_t));
 
+    prev_state = lsurface->current;
     get_output()->workspace->add_view(self(), get_layer());
     wf::wlr_view_t::map(surface);
     wf_layer_shell_manager::get_instance().handle_map(this);
@@ -465,10 +626,12 @@ void wayfire_layer_shell_view::commit()
             get_output()->workspace->add_view(self(), get_layer());
             /* Will also trigger reflowing */
             wf_layer_shell_manager::get_instance().handle_move_layer(this);
-        } else
+        } else if (layout_state_changed(prev_state, *state))
         {
-            /* Reflow reserved areas and positions */
-            wf_layer_shell_manager::get_instance().arrange_layers(get_output());
+            /* Reflow reserved areas and positions on the next idle */
+            last_configured_size = {-1, -1};
+            wf_layer_shell_manager::get_instance().handle_layout_change(this,
+                prev_state);
         }
 
         if (prev_state.keyboard_interactive != state->keyboard_interactive)
@@ -539,7 +702,14 @@ void wayfire_layer_shell_view::configure(wf::geometry_t box)
     }
 
     wf::wlr_view_t::move(box.x, box.y);
-    wlr_layer_surface_v1_configure(lsurface, box.width, box.height);
+
+    /* Arranging an output configures many views which did not change, avoid
+     * sending them redundant configure events. */
+    if (wf::dimensions(box) != last_configured_size)
+    {
+        last_configured_size = wf::dimensions(box);
+        wlr_layer_surface_v1_configure(lsurface, box.width, box.height);
+    }
 }
 
 void wayfire_layer_shell_view::remove_anchored(bool reflow)
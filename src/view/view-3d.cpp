@@ -90,6 +90,28 @@ void transform_manager_node_t::_rem_transformer(
     wf::scene::update(parent->shared_from_this(), update_flag::CHILDREN_LIST);
 }
 
+static void transform_linear_damage(node_t *self, wf::region_t& damage);
+
+wf::region_t transform_manager_node_t::transform_region(const wf::region_t& region)
+{
+    // The transformers are sorted from the innermost to the outermost
+    wf::region_t result = region;
+    for (auto& tr : transformers)
+    {
+        auto node = tr.node.get();
+        if (dynamic_cast<view_2d_transformer_t*>(node) ||
+            dynamic_cast<view_3d_transformer_t*>(node))
+        {
+            transform_linear_damage(node, result);
+        } else if (!result.empty())
+        {
+            result = node->get_bounding_box();
+        }
+    }
+
+    return result;
+}
+
 view_2d_transformer_t::view_2d_transformer_t(wayfire_view view) :
     floating_inner_node_t(false)
 {
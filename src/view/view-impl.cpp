@@ -5,6 +5,7 @@
 #include "wayfire/decorator.hpp"
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-definitions.hpp"
+#include "wayfire/view-registry.hpp"
 #include "wayfire/workspace-manager.hpp"
 #include "wayfire/output-layout.hpp"
 #include <memory>
@@ -20,9 +21,11 @@ wf::wlr_view_t::wlr_view_t() : wf::view_interface_t()
 void wf::wlr_view_t::handle_app_id_changed(std::string new_app_id)
 {
     this->app_id = new_app_id;
+    wf::get_core().view_registry->update(self());
     view_app_id_changed_signal data;
     data.view = self();
     emit(&data);
+    wf::get_core().emit(&data);
 }
 
 std::string wf::wlr_view_t::get_app_id()
@@ -36,6 +39,7 @@ void wf::wlr_view_t::handle_title_changed(std::string new_title)
     view_title_changed_signal data;
     data.view = self();
     emit(&data);
+    wf::get_core().emit(&data);
 }
 
 std::string wf::wlr_view_t::get_title()
@@ -105,6 +109,21 @@ void wf::wlr_view_t::move(int x, int y)
     set_position(x, y, get_wm_geometry(), true);
 }
 
+bool wf::wlr_view_t::supports_txn_configure()
+{
+    return false;
+}
+
+bool wf::wlr_view_t::send_txn_configure(const txn::view_state_t& state)
+{
+    return false;
+}
+
+void wf::wlr_view_t::set_txn_position(wf::point_t position)
+{
+    set_position(position.x, position.y, get_wm_geometry(), true);
+}
+
 void wf::wlr_view_t::adjust_anchored_edge(wf::dimensions_t new_size)
 {
     if (priv->edges)
@@ -5,6 +5,7 @@
 #include <wayfire/nonstd/safe-list.hpp>
 #include <wayfire/view.hpp>
 #include <wayfire/opengl.hpp>
+#include <wayfire/snapshot-pool.hpp>
 
 #include "surface-impl.hpp"
 #include "view/wlr-surface-node.hpp"
@@ -14,6 +15,7 @@
 #include "wayfire/view-transform.hpp"
 #include <wayfire/nonstd/wlroots-full.hpp>
 #include <wayfire/compositor-view.hpp>
+#include <wayfire/transaction/view-instructions.hpp>
 
 struct wlr_seat;
 namespace wf
@@ -55,7 +57,14 @@ class view_interface_t::view_priv_impl
     int in_continuous_resize = 0;
     int visibility_counter   = 1;
 
+    /* The last snapshot of the view, see take_snapshot() */
     wf::render_target_t offscreen_buffer;
+    std::unique_ptr<wf::pooled_snapshot_t> snapshot;
+    /**
+     * While positive, the view is rendered from its snapshot instead of its
+     * surfaces. Used by view_state_instruction_t while waiting for the client.
+     */
+    int txn_freeze_counter = 0;
     wlr_box minimize_hint = {0, 0, 0, 0};
 
     scene::floating_inner_ptr root_node;
@@ -170,6 +179,28 @@ class wlr_view_t : public view_interface_t
 
     wlr_buffer *get_buffer();
 
+    /**
+     * @return Whether the view can send the state of a transaction to its
+     *   client with send_txn_configure().
+     */
+    virtual bool supports_txn_configure();
+
+    /**
+     * Send the size and states of a transaction to the client in a single
+     * configure, without changing the state of the view in the compositor.
+     *
+     * @return Whether the client has to commit a new surface state before the
+     *   transaction can be applied. In that case, view_txn_configured_signal
+     *   is emitted on the view when it does.
+     */
+    virtual bool send_txn_configure(const txn::view_state_t& state);
+
+    /**
+     * Move the view when applying a transaction. The client has already been
+     * configured with the new position, if needed.
+     */
+    void set_txn_position(wf::point_t position);
+
     std::unique_ptr<wlr_surface_controller_t> surface_controller;
 };
 
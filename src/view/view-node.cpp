@@ -268,11 +268,15 @@ class view_render_instance_t : public render_instance_t
 
         damage += offset;
 
-        auto bbox = view->get_surface_root_node()->get_bounding_box();
+        // Frozen views are drawn from their snapshot, see view_state_instruction_t
+        const bool use_snapshot = !view->is_mapped() ||
+            (view->priv->txn_freeze_counter > 0);
+        auto bbox = use_snapshot ? view->priv->offscreen_buffer.geometry :
+            view->get_surface_root_node()->get_bounding_box();
         wf::region_t our_damage = damage & bbox;
         if (!our_damage.empty())
         {
-            if (!view->is_mapped())
+            if (use_snapshot)
             {
                 instructions.push_back(render_instruction_t{
                             .instance = this,
@@ -305,7 +309,7 @@ class view_render_instance_t : public render_instance_t
         {
             target.logic_scissor(wlr_box_from_pixman_box(box));
             OpenGL::render_transformed_texture(
-                view->priv->offscreen_buffer.tex,
+                view->get_snapshot_texture(),
                 view->priv->offscreen_buffer.geometry,
                 target.get_orthographic_projection());
         }
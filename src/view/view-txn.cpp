@@ -0,0 +1,158 @@
+#include <wayfire/transaction/view-instructions.hpp>
+#include <wayfire/output.hpp>
+#include <wayfire/debug.hpp>
+
+#include "view-impl.hpp"
+
+wf::txn::view_state_instruction_t::view_state_instruction_t(
+    wayfire_view view, view_state_t state)
+{
+    this->view  = view;
+    this->state = state;
+
+    on_unmapped   = [=] (view_unmapped_signal*) { send_cancel(); };
+    on_set_output = [=] (view_set_output_signal*) { send_cancel(); };
+    on_configured = [=] (view_txn_configured_signal*) { send_ready(); };
+}
+
+wf::txn::view_state_instruction_t::~view_state_instruction_t()
+{
+    unfreeze();
+
+    // Disconnect before dropping the reference, which may destroy the view
+    on_unmapped.disconnect();
+    on_set_output.disconnect();
+    on_configured.disconnect();
+    if (has_ref)
+    {
+        view->unref();
+    }
+}
+
+std::string wf::txn::view_state_instruction_t::get_object()
+{
+    return std::to_string(view->get_id());
+}
+
+void wf::txn::view_state_instruction_t::set_pending()
+{
+    // Keep the view alive until the instruction is done
+    view->take_ref();
+    has_ref = true;
+    view->connect(&on_unmapped);
+    view->connect(&on_set_output);
+}
+
+void wf::txn::view_state_instruction_t::commit()
+{
+    auto wlr_view = dynamic_cast<wlr_view_t*>(view.get());
+    if (!wlr_view || !wlr_view->supports_txn_configure())
+    {
+        send_ready();
+        return;
+    }
+
+    view->connect(&on_configured);
+    if (!wlr_view->send_txn_configure(state))
+    {
+        on_configured.disconnect();
+        send_ready();
+        return;
+    }
+
+    LOGC(TXNV, "View ", view, ": waiting for the client to be configured");
+    freeze();
+}
+
+void wf::txn::view_state_instruction_t::apply()
+{
+    on_configured.disconnect();
+    on_set_output.disconnect();
+
+    auto wlr_view = dynamic_cast<wlr_view_t*>(view.get());
+    if (wlr_view && wlr_view->supports_txn_configure())
+    {
+        // The client already has the new state, update only the compositor side
+        if (state.tiled_edges.has_value())
+        {
+            view->view_interface_t::set_tiled(*state.tiled_edges);
+        }
+
+        if (state.fullscreen.has_value())
+        {
+            view->view_interface_t::set_fullscreen(*state.fullscreen);
+        }
+
+        if (state.geometry.has_value())
+        {
+            wlr_view->set_txn_position(wf::origin(*state.geometry));
+        }
+    } else
+    {
+        if (state.tiled_edges.has_value())
+        {
+            view->set_tiled(*state.tiled_edges);
+        }
+
+        if (state.fullscreen.has_value())
+        {
+            view->set_fullscreen(*state.fullscreen);
+        }
+
+        if (state.geometry.has_value())
+        {
+            view->set_geometry(*state.geometry);
+        }
+    }
+
+    unfreeze();
+}
+
+void wf::txn::view_state_instruction_t::freeze()
+{
+    if (frozen || !view->is_mapped() || !view->get_output())
+    {
+        return;
+    }
+
+    view->take_snapshot();
+    ++view->priv->txn_freeze_counter;
+    frozen = true;
+}
+
+void wf::txn::view_state_instruction_t::unfreeze()
+{
+    if (!frozen)
+    {
+        return;
+    }
+
+    frozen = false;
+    --view->priv->txn_freeze_counter;
+
+    // Damage the area of the snapshot too, in case the view has moved
+    view_damage_raw(view, view->priv->offscreen_buffer.geometry);
+    view->damage();
+}
+
+void wf::txn::view_state_instruction_t::send_ready()
+{
+    on_configured.disconnect();
+
+    instruction_ready_signal data;
+    data.instruction = {this};
+    this->emit(&data);
+}
+
+void wf::txn::view_state_instruction_t::send_cancel()
+{
+    LOGC(TXNV, "View ", view, ": cancelling instruction");
+    on_unmapped.disconnect();
+    on_configured.disconnect();
+    on_set_output.disconnect();
+    unfreeze();
+
+    instruction_cancel_signal data;
+    data.instruction = {this};
+    this->emit(&data);
+}
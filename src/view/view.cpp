@@ -9,6 +9,7 @@
 #include "wayfire/scene.hpp"
 #include "wayfire/view.hpp"
 #include "wayfire/view-transform.hpp"
+#include "wayfire/view-registry.hpp"
 #include "wayfire/workspace-manager.hpp"
 #include "wayfire/render-manager.hpp"
 #include "xdg-shell.hpp"
@@ -176,6 +177,7 @@ std::vector<wayfire_view> wf::view_interface_t::enumerate_views(
 void wf::view_interface_t::set_role(view_role_t new_role)
 {
     role = new_role;
+    wf::get_core().view_registry->update(self());
     damage();
 }
 
@@ -213,6 +215,7 @@ void wf::view_interface_t::set_output(wf::output_t *new_output)
     data.output = get_output();
 
     this->priv->output = new_output;
+    wf::get_core().view_registry->update(self());
     if ((new_output != data.output) && new_output)
     {
         view_attached_signal data;
@@ -751,17 +754,16 @@ const wf::render_target_t& wf::view_interface_t::take_snapshot()
         return priv->offscreen_buffer;
     }
 
-    wf::render_target_t& offscreen_buffer = priv->offscreen_buffer;
     auto root_node = get_surface_root_node();
     const wf::geometry_t bbox = root_node->get_bounding_box();
     float scale = get_output()->handle->scale;
 
-    OpenGL::render_begin();
-    offscreen_buffer.allocate(bbox.width * scale, bbox.height * scale);
-    OpenGL::render_end();
-
-    offscreen_buffer.geometry = root_node->get_bounding_box();
-    offscreen_buffer.scale    = scale;
+    // Give back the old buffer first, so that it can be reused if the size
+    // did not change much.
+    priv->snapshot.reset();
+    priv->snapshot = std::make_unique<wf::pooled_snapshot_t>(bbox, scale);
+    wf::render_target_t& offscreen_buffer = priv->offscreen_buffer;
+    offscreen_buffer = priv->snapshot->get_target();
 
     std::vector<scene::render_instance_uptr> instances;
     root_node->gen_render_instances(instances, [] (auto) {}, get_output());
@@ -776,6 +778,11 @@ const wf::render_target_t& wf::view_interface_t::take_snapshot()
     return offscreen_buffer;
 }
 
+wf::texture_t wf::view_interface_t::get_snapshot_texture()
+{
+    return wf::get_subbuffer_texture(priv->offscreen_buffer);
+}
+
 wf::view_interface_t::view_interface_t()
 {
     this->priv = std::make_unique<wf::view_interface_t::view_priv_impl>();
@@ -862,9 +869,9 @@ void wf::view_interface_t::deinitialize()
     set_decoration(nullptr);
     this->_clear_data();
 
-    OpenGL::render_begin();
-    this->priv->offscreen_buffer.release();
-    OpenGL::render_end();
+    // Give the snapshot buffer back to the pool
+    this->priv->snapshot.reset();
+    this->priv->offscreen_buffer.reset();
 }
 
 wf::view_interface_t::~view_interface_t()
@@ -883,25 +890,21 @@ void wf::view_damage_raw(wayfire_view view, const wlr_box& box)
 
     wf::scene::node_damage_signal data;
 
-    /* Sticky views are visible on all workspaces. */
+    /* Sticky views are visible on all workspaces. Damage them only on the
+     * current workspace, other workspaces are damaged lazily by the
+     * workspace streams which show them, see output_sticky_damage_signal. */
     if (view->sticky)
     {
-        auto wsize = output->workspace->get_workspace_grid_size();
-        auto cws   = output->workspace->get_current_workspace();
-
         /* Damage only the visible region of the shell view.
          * This prevents hidden panels from spilling damage onto other workspaces */
         wlr_box ws_box = output->get_relative_geometry();
-        wlr_box visible_damage = geometry_intersection(box, ws_box);
-        for (int i = 0; i < wsize.width; i++)
-        {
-            for (int j = 0; j < wsize.height; j++)
-            {
-                const int dx = (i - cws.x) * ws_box.width;
-                const int dy = (j - cws.y) * ws_box.height;
-                data.region |= visible_damage + wf::point_t{dx, dy};
-            }
-        }
+        data.region = geometry_intersection(box, ws_box);
+
+        /* Workspace streams apply the sticky damage directly, so it must
+         * already be transformed by the view's transformers */
+        wf::output_sticky_damage_signal sticky_data;
+        sticky_data.region = view->get_transformed_node()->transform_region(box) & ws_box;
+        output->emit(&sticky_data);
     } else
     {
         data.region |= box;
@@ -345,6 +345,16 @@ void wayfire_xdg_view::commit()
     {
         this->last_size_request = wf::dimensions(xdg_g);
     }
+
+    // Serials may wrap around, and the client may have acked a later configure
+    if (txn_configure_serial.has_value() &&
+        ((int32_t)(xdg_toplevel->base->current.configure_serial - *txn_configure_serial) >= 0))
+    {
+        txn_configure_serial.reset();
+        wf::view_txn_configured_signal data;
+        data.view = self();
+        emit(&data);
+    }
 }
 
 wf::point_t wayfire_xdg_view::get_window_offset()
@@ -423,6 +433,60 @@ void wayfire_xdg_view::resize(int w, int h)
     }
 }
 
+bool wayfire_xdg_view::supports_txn_configure()
+{
+    return true;
+}
+
+bool wayfire_xdg_view::send_txn_configure(const wf::txn::view_state_t& state)
+{
+    if (!xdg_toplevel || !is_mapped())
+    {
+        return false;
+    }
+
+    // All requests made in the same iteration of the event loop are sent to the
+    // client in the same configure, so they all have the same serial.
+    std::optional<uint32_t> serial;
+    if (state.tiled_edges.has_value() && (*state.tiled_edges != tiled_edges))
+    {
+        wlr_xdg_toplevel_set_tiled(xdg_toplevel, *state.tiled_edges);
+        serial = wlr_xdg_toplevel_set_maximized(xdg_toplevel,
+            (*state.tiled_edges == wf::TILED_EDGES_ALL));
+    }
+
+    if (state.fullscreen.has_value() && (*state.fullscreen != fullscreen))
+    {
+        serial = wlr_xdg_toplevel_set_fullscreen(xdg_toplevel, *state.fullscreen);
+    }
+
+    if (state.geometry.has_value())
+    {
+        int w = state.geometry->width;
+        int h = state.geometry->height;
+        if (priv->frame)
+        {
+            priv->frame->calculate_resize_size(w, h);
+        }
+
+        auto current_geometry = get_xdg_geometry(xdg_toplevel);
+        if (should_resize_client({w, h}, wf::dimensions(current_geometry)))
+        {
+            this->last_size_request = {w, h};
+            serial = wlr_xdg_toplevel_set_size(xdg_toplevel, w, h);
+        }
+    }
+
+    if (!serial.has_value())
+    {
+        return false;
+    }
+
+    last_configure_serial = *serial;
+    txn_configure_serial  = *serial;
+    return true;
+}
+
 void wayfire_xdg_view::request_native_size()
 {
     last_configure_serial =
@@ -3,6 +3,7 @@
 
 #include "view-impl.hpp"
 #include "wayfire/signal-definitions.hpp"
+#include <optional>
 
 /**
  * A class for xdg-shell popups
@@ -52,6 +53,10 @@ class wayfire_xdg_view : public wf::wlr_view_t
     wlr_xdg_toplevel *xdg_toplevel;
     uint32_t last_configure_serial = 0;
 
+    /* The serial of the configure sent for a transaction, if we are waiting
+     * for the client to commit it */
+    std::optional<uint32_t> txn_configure_serial;
+
   protected:
     void initialize() override final;
 
@@ -70,6 +75,9 @@ class wayfire_xdg_view : public wf::wlr_view_t
     void resize(int w, int h) final;
     void request_native_size() override final;
 
+    bool supports_txn_configure() final;
+    bool send_txn_configure(const wf::txn::view_state_t& state) final;
+
     void destroy() final;
     void close() final;
     void ping() final;
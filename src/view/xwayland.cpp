@@ -8,6 +8,7 @@
 #include "wayfire/workspace-manager.hpp"
 #include "wayfire/decorator.hpp"
 #include "wayfire/output-layout.hpp"
+#include <optional>
 #include "wayfire/signal-definitions.hpp"
 #include "../core/core-impl.hpp"
 #include "../core/seat/cursor.hpp"
@@ -434,7 +435,12 @@ class wayfire_xwayland_view_base : public wf::wlr_view_t
         resize(geometry.width, geometry.height);
     }
 
-    void send_configure(int width, int height)
+    /**
+     * Configure the X11 window with the given size, and at the given position
+     * of the surface in output-local coordinates or at its current position.
+     */
+    void send_configure(int width, int height,
+        std::optional<wf::point_t> position = {})
     {
         if (!xw)
         {
@@ -452,8 +458,8 @@ class wayfire_xwayland_view_base : public wf::wlr_view_t
 
         auto output_geometry = get_output_geometry();
 
-        int configure_x = output_geometry.x;
-        int configure_y = output_geometry.y;
+        int configure_x = position ? position->x : output_geometry.x;
+        int configure_y = position ? position->y : output_geometry.y;
 
         if (get_output())
         {
@@ -530,6 +536,10 @@ class wayfire_xwayland_view : public wayfire_xwayland_view_base
         on_request_maximize, on_request_minimize, on_request_activate,
         on_request_fullscreen, on_set_parent, on_set_hints;
 
+    /* The size of the view when it was configured for a transaction, if we
+     * are waiting for the client to resize */
+    std::optional<wf::dimensions_t> txn_size_before;
+
   public:
     wayfire_xwayland_view(wlr_xwayland_surface *xww) :
         wayfire_xwayland_view_base(xww)
@@ -700,6 +710,82 @@ class wayfire_xwayland_view : public wayfire_xwayland_view_base
         /* Avoid loops where the client wants to have a certain size but the
          * compositor keeps trying to resize it */
         last_size_request = wf::dimensions(geometry);
+
+        /* X11 has no configure acks, so consider the configure of a transaction
+         * handled when the client resizes, even if it picks another size than
+         * the requested one (for ex. because of its size hints) */
+        if (txn_size_before.has_value() &&
+            (wf::dimensions(geometry) != *txn_size_before))
+        {
+            txn_size_before.reset();
+            wf::view_txn_configured_signal data;
+            data.view = self();
+            emit(&data);
+        }
+    }
+
+    bool supports_txn_configure() override
+    {
+        return true;
+    }
+
+    bool send_txn_configure(const wf::txn::view_state_t& state) override
+    {
+        if (!xw || !is_mapped())
+        {
+            return false;
+        }
+
+        if (state.tiled_edges.has_value())
+        {
+            wlr_xwayland_surface_set_maximized(xw, !!*state.tiled_edges);
+        }
+
+        if (state.fullscreen.has_value())
+        {
+            wlr_xwayland_surface_set_fullscreen(xw, *state.fullscreen);
+        }
+
+        if (!state.geometry.has_value())
+        {
+            return false;
+        }
+
+        int w = state.geometry->width;
+        int h = state.geometry->height;
+        if (priv->frame)
+        {
+            priv->frame->calculate_resize_size(w, h);
+        }
+
+        /* Send the final position together with the size, so that the client
+         * is configured only once. */
+        auto obox = get_output_geometry();
+        auto wm   = get_wm_geometry();
+        wf::point_t position = {
+            state.geometry->x + obox.x - wm.x,
+            state.geometry->y + obox.y - wm.y,
+        };
+
+        const bool resize = should_resize_client({w, h}, wf::dimensions(obox));
+        if (resize)
+        {
+            this->last_size_request = {w, h};
+        }
+
+        send_configure(last_size_request.width, last_size_request.height,
+            position);
+
+        /* A configure with the current size does not make the client commit
+         * a new size, so there is nothing to wait for. This happens when the
+         * last size request is stale, for ex. after the client resized itself. */
+        if (!resize || (last_size_request == wf::dimensions(obox)))
+        {
+            return false;
+        }
+
+        txn_size_before = wf::dimensions(obox);
+        return true;
     }
 
     void set_moving(bool moving) override
@@ -0,0 +1,125 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/animation-timeline.hpp>
+#include <memory>
+
+/* Every reading of the fake clock advances it by 5us. */
+struct fake_clock_t
+{
+    int64_t now = 1000;
+    wf::animation_timeline_t::clock_t get()
+    {
+        return [=] () { return now += 5; };
+    }
+};
+
+TEST_CASE("Animations run until they finish")
+{
+    fake_clock_t clock;
+    wf::animation_timeline_t timeline{clock.get()};
+
+    int a_ticks = 0, b_ticks = 0;
+    int64_t last_target = 0;
+    auto a = timeline.add([&] (int64_t target)
+    {
+        last_target = target;
+        return ++a_ticks < 3;
+    });
+    auto b = timeline.add([&] (int64_t) { ++b_ticks; return true; });
+
+    REQUIRE(timeline.size() == 2);
+    REQUIRE(timeline.contains(a));
+    REQUIRE(timeline.contains(b));
+
+    for (int i = 0; i < 5; i++)
+    {
+        timeline.tick(16'000 * (i + 1));
+    }
+
+    REQUIRE(a_ticks == 3);
+    REQUIRE(b_ticks == 5);
+    REQUIRE(last_target == 48'000);
+    REQUIRE(!timeline.contains(a));
+    REQUIRE(timeline.contains(b));
+    REQUIRE(timeline.size() == 1);
+
+    timeline.remove(b);
+    timeline.remove(b);
+    REQUIRE(timeline.size() == 0);
+    timeline.tick(100'000);
+    REQUIRE(b_ticks == 5);
+
+    auto& stats = timeline.get_stats();
+    REQUIRE(stats.ticks == 5);
+    REQUIRE(stats.animations_ticked == 8);
+    REQUIRE(stats.last_tick_us == 5);
+    REQUIRE(stats.total_tick_us == 25);
+    REQUIRE(stats.max_tick_us == 5);
+}
+
+TEST_CASE("Stale ids do not remove reused slots")
+{
+    wf::animation_timeline_t timeline;
+    auto a = timeline.add([] (int64_t) { return true; });
+    timeline.remove(a);
+
+    auto b = timeline.add([] (int64_t) { return true; });
+    REQUIRE(b.index == a.index);
+    REQUIRE(b != a);
+
+    timeline.remove(a);
+    REQUIRE(timeline.contains(b));
+    REQUIRE(timeline.size() == 1);
+}
+
+TEST_CASE("Animations can be added and removed during a tick")
+{
+    wf::animation_timeline_t timeline;
+    std::vector<int> ticks(4, 0);
+    wf::timeline_animation_id_t ids[4];
+
+    /* The first animation removes itself and the second one, which therefore
+     * never runs, and adds a fourth one which runs from the next tick on. */
+    auto owner = std::make_shared<int>(0);
+    ids[0] = timeline.add([&, owner] (int64_t)
+    {
+        ++ticks[0];
+        timeline.remove(ids[0]);
+        timeline.remove(ids[1]);
+        // The callback is still alive while it runs
+        REQUIRE(owner.use_count() == 2);
+        ids[3] = timeline.add([&] (int64_t) { ++ticks[3]; return true; });
+        return true;
+    });
+    ids[1] = timeline.add([&] (int64_t) { ++ticks[1]; return true; });
+    ids[2] = timeline.add([&] (int64_t) { ++ticks[2]; return true; });
+    REQUIRE(owner.use_count() == 2);
+
+    timeline.tick(1);
+    REQUIRE((ticks == std::vector<int>{1, 0, 1, 0}));
+    REQUIRE(timeline.size() == 2);
+    REQUIRE(!timeline.contains(ids[0]));
+    REQUIRE(!timeline.contains(ids[1]));
+    REQUIRE(timeline.contains(ids[3]));
+
+    // The first callback was released after the tick
+    REQUIRE(owner.use_count() == 1);
+
+    timeline.tick(2);
+    REQUIRE((ticks == std::vector<int>{1, 0, 2, 1}));
+}
+
+TEST_CASE("Frames are predicted to be presented at the next vblank")
+{
+    using timeline_t = wf::animation_timeline_t;
+
+    // No information: assume immediate presentation
+    REQUIRE(timeline_t::predict_presentation(5000, 0, 16'667) == 5000);
+    REQUIRE(timeline_t::predict_presentation(5000, 1000, 0) == 5000);
+
+    REQUIRE(timeline_t::predict_presentation(10'000, 1000, 16'667) == 17'667);
+    REQUIRE(timeline_t::predict_presentation(17'667, 1000, 16'667) == 34'334);
+    REQUIRE(timeline_t::predict_presentation(100'000, 1000, 16'667) == 101'002);
+    REQUIRE(timeline_t::predict_presentation(500, 1000, 16'667) == 17'667);
+}
@@ -0,0 +1,122 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/config-diff.hpp>
+#include <wayfire/config/option.hpp>
+#include <wayfire/config/file.hpp>
+
+static std::shared_ptr<wf::config::section_t> make_section(const std::string& name,
+    int nr_options)
+{
+    auto section = std::make_shared<wf::config::section_t>(name);
+    for (int i = 0; i < nr_options; i++)
+    {
+        section->register_new_option(std::make_shared<wf::config::option_t<int>>(
+            "option" + std::to_string(i), i));
+    }
+
+    return section;
+}
+
+TEST_CASE("Unchanged configurations have an empty diff")
+{
+    wf::config::config_manager_t config;
+    config.merge_section(make_section("core", 5));
+    config.merge_section(make_section("output:eDP-1", 5));
+
+    auto before = wf::take_config_snapshot(config);
+    auto diff   = wf::compute_config_diff(before, wf::take_config_snapshot(config));
+    REQUIRE(diff.complete);
+    REQUIRE(diff.empty());
+    REQUIRE(!diff.section_changed("core"));
+    REQUIRE(!diff.option_changed("core/option1"));
+    REQUIRE(!diff.section_with_prefix_changed("output:"));
+}
+
+TEST_CASE("Changed options and sections are reported")
+{
+    wf::config::config_manager_t config;
+    config.merge_section(make_section("core", 5));
+    config.merge_section(make_section("input", 5));
+    auto before = wf::take_config_snapshot(config);
+
+    config.get_section("input")->get_option("option3")->set_value_str("42");
+    config.merge_section(make_section("output:HDMI-A-1", 2));
+    auto diff = wf::compute_config_diff(before, wf::take_config_snapshot(config));
+
+    REQUIRE(!diff.empty());
+    REQUIRE(diff.option_changed("input/option3"));
+    REQUIRE(!diff.option_changed("input/option2"));
+    REQUIRE(diff.section_changed("input"));
+    REQUIRE(!diff.section_changed("core"));
+    REQUIRE(diff.added_sections == std::set<std::string>{"output:HDMI-A-1"});
+    REQUIRE(diff.option_changed("output:HDMI-A-1/option0"));
+    REQUIRE(diff.section_with_prefix_changed("output:"));
+    REQUIRE(!diff.section_with_prefix_changed("input-device:"));
+
+    // The other direction: the section was removed
+    auto reverse = wf::compute_config_diff(wf::take_config_snapshot(config), before);
+    REQUIRE(reverse.removed_sections == std::set<std::string>{"output:HDMI-A-1"});
+    REQUIRE(reverse.option_changed("input/option3"));
+}
+
+TEST_CASE("Diffs from backends which do not compute them cover everything")
+{
+    wf::config_diff_t diff;
+    REQUIRE(!diff.empty());
+    REQUIRE(diff.option_changed("core/plugins"));
+    REQUIRE(diff.section_changed("command"));
+    REQUIRE(diff.section_with_prefix_changed("output:"));
+}
+
+/** An ini file for the sections created by make_section(), with @edited set to -1. */
+static std::string make_ini(int nr_sections, int nr_options, const std::string& edited)
+{
+    std::string ini;
+    for (int i = 0; i < nr_sections; i++)
+    {
+        std::string section = "section" + std::to_string(i);
+        ini += "[" + section + "]\n";
+        for (int j = 0; j < nr_options; j++)
+        {
+            std::string option = "option" + std::to_string(j);
+            ini += option + " = " +
+                (section + "/" + option == edited ? "-1" : std::to_string(j)) + "\n";
+        }
+    }
+
+    return ini;
+}
+
+TEST_CASE("Reloading a large configuration with a single edit")
+{
+    const int nr_sections = 200;
+    const int nr_options  = 50;
+    wf::config::config_manager_t config;
+    for (int i = 0; i < nr_sections; i++)
+    {
+        config.merge_section(make_section("section" + std::to_string(i), nr_options));
+    }
+
+    // The whole reload: parsing the file, taking the snapshot and the diff
+    wf::config::load_configuration_options_from_string(config,
+        make_ini(nr_sections, nr_options, ""), "test.ini");
+    auto last = wf::take_config_snapshot(config);
+    REQUIRE(wf::compute_config_diff(last, wf::take_config_snapshot(config)).empty());
+
+    for (int i = 0; i < 20; i++)
+    {
+        const std::string edited = "section" + std::to_string(i) + "/option7";
+        wf::config::load_configuration_options_from_string(config,
+            make_ini(nr_sections, nr_options, edited), "test.ini");
+        auto current = wf::take_config_snapshot(config);
+        auto diff    = wf::compute_config_diff(last, current);
+
+        // The previous edit is reverted, the new one is applied
+        REQUIRE(diff.changed_options.size() == (i == 0 ? 1 : 2));
+        REQUIRE(diff.option_changed(edited));
+        REQUIRE(diff.changed_sections.size() == diff.changed_options.size());
+        REQUIRE(config.get_option(edited)->get_value_str() == "-1");
+        last = std::move(current);
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * Times a synthetic stream of motion events from a 1000Hz mouse with a dozen
+ * hotspots: first in the middle of the output, then along its top edge. The
+ * hotspot manager is compared with testing the rectangles of every hotspot on
+ * each event, as each hotspot did on its own before.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include "../src/core/seat/hotspot-manager.hpp"
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/* The hotspot manager never dereferences outputs. */
+static wf::output_t *fake_output(int i)
+{
+    return (wf::output_t*)(uintptr_t)((i + 1) * 0x1000);
+}
+
+static const wf::geometry_t output_a = {0, 0, 1920, 1080};
+
+int main()
+{
+    constexpr int N = 200000;
+    constexpr int nr_hotspots = 12;
+    const uint32_t edges[] = {
+        OUTPUT_EDGE_TOP, OUTPUT_EDGE_BOTTOM, OUTPUT_EDGE_LEFT, OUTPUT_EDGE_RIGHT,
+        OUTPUT_EDGE_TOP | OUTPUT_EDGE_LEFT, OUTPUT_EDGE_TOP | OUTPUT_EDGE_RIGHT,
+        OUTPUT_EDGE_BOTTOM | OUTPUT_EDGE_LEFT, OUTPUT_EDGE_BOTTOM | OUTPUT_EDGE_RIGHT,
+    };
+
+    mock_loop::get().start(0);
+    int activations = 0;
+    wf::hotspot_manager_t manager;
+    std::vector<std::unique_ptr<wf::hotspot_instance_t>> per_hotspot;
+    for (int i = 0; i < nr_hotspots; i++)
+    {
+        auto callback = [&] (uint32_t) { ++activations; };
+        manager.add_hotspot(std::make_unique<wf::hotspot_instance_t>(
+            edges[i % 8], 100 + 10 * i, 10, 100, callback));
+        per_hotspot.push_back(std::make_unique<wf::hotspot_instance_t>(
+            edges[i % 8], 100 + 10 * i, 10, 100, callback));
+    }
+
+    std::vector<wf::pointf_t> middle, edge;
+    for (int i = 0; i < N; i++)
+    {
+        double t = i * 0.001;
+        middle.push_back({960 + 400 * std::cos(t), 540 + 300 * std::sin(t)});
+        edge.push_back({(double)(i % 1920), 2});
+    }
+
+    // Every hotspot computes and tests its own rectangles on each event.
+    size_t inside = 0;
+    auto test_each = [&] (const std::vector<wf::pointf_t>& stream)
+    {
+        for (auto& point : stream)
+        {
+            for (auto& hotspot : per_hotspot)
+            {
+                wf::geometry_t regions[2];
+                hotspot->get_regions(output_a, regions);
+                inside += (regions[0] & point) || (regions[1] & point);
+            }
+        }
+    };
+
+    std::printf("%d motion events, %d hotspots\n", N, nr_hotspots);
+    std::printf("%-10s %14s %16s\n", "stream", "manager-us", "per-hotspot-us");
+    for (auto& [name, stream] : {std::pair{"middle", &middle}, std::pair{"edge", &edge}})
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (auto& point : *stream)
+        {
+            manager.process_motion(fake_output(0), output_a, point);
+        }
+
+        double manager_us = elapsed_us(start);
+
+        start = std::chrono::steady_clock::now();
+        test_each(*stream);
+        std::printf("%-10s %14.1f %16.1f\n", name, manager_us, elapsed_us(start));
+    }
+
+    if ((manager.stats.events != 2 * N) || (manager.stats.tested != N) || (inside == 0))
+    {
+        std::fprintf(stderr, "unexpected hotspot statistics\n");
+        return 1;
+    }
+
+    manager.clear();
+    return 0;
+}
@@ -0,0 +1,167 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "../src/core/seat/hotspot-manager.hpp"
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+#include <cmath>
+
+/* The hotspot manager never dereferences outputs. */
+static wf::output_t *fake_output(int i)
+{
+    return (wf::output_t*)(uintptr_t)((i + 1) * 0x1000);
+}
+
+static const wf::geometry_t output_a = {0, 0, 1920, 1080};
+static const wf::geometry_t output_b = {1920, 0, 1280, 1024};
+
+struct hotspot_counter_t
+{
+    int activations = 0;
+    uint32_t last_edges = 0;
+
+    std::unique_ptr<wf::hotspot_instance_t> create(uint32_t edges, int along, int away, int timeout)
+    {
+        return std::make_unique<wf::hotspot_instance_t>(edges, along, away, timeout,
+            [=] (uint32_t edges)
+        {
+            ++activations;
+            last_edges = edges;
+        });
+    }
+};
+
+TEST_CASE("Hotspots activate once after the timeout")
+{
+    mock_loop::get().start(0);
+    wf::hotspot_manager_t manager;
+    hotspot_counter_t top;
+    manager.add_hotspot(top.create(OUTPUT_EDGE_TOP, 200, 10, 100));
+
+    auto motion = [&] (double x, double y)
+    {
+        manager.process_motion(fake_output(0), output_a, {x, y});
+    };
+
+    // Outside of the hotspot, and at the edge but outside of the centered region
+    motion(960, 500);
+    motion(100, 0);
+    mock_loop::get().move_forward(200);
+    REQUIRE(top.activations == 0);
+
+    // Entering and leaving before the timeout does not activate
+    motion(960, 5);
+    mock_loop::get().move_forward(50);
+    motion(960, 50);
+    mock_loop::get().move_forward(200);
+    REQUIRE(top.activations == 0);
+
+    // Staying inside activates exactly once, even with more motion
+    motion(960, 5);
+    mock_loop::get().move_forward(60);
+    motion(970, 2);
+    mock_loop::get().move_forward(60);
+    REQUIRE(top.activations == 1);
+    REQUIRE(top.last_edges == OUTPUT_EDGE_TOP);
+    motion(980, 3);
+    mock_loop::get().move_forward(200);
+    REQUIRE(top.activations == 1);
+
+    // Leaving re-arms the hotspot
+    motion(960, 500);
+    motion(960, 1);
+    mock_loop::get().move_forward(200);
+    REQUIRE(top.activations == 2);
+}
+
+TEST_CASE("Corner hotspots cover both edges")
+{
+    mock_loop::get().start(0);
+    wf::hotspot_manager_t manager;
+    hotspot_counter_t corner;
+    manager.add_hotspot(corner.create(OUTPUT_EDGE_BOTTOM | OUTPUT_EDGE_RIGHT, 100, 5, 10));
+
+    // Along the bottom edge
+    manager.process_motion(fake_output(0), output_a, {1850, 1078});
+    mock_loop::get().move_forward(20);
+    REQUIRE(corner.activations == 1);
+
+    // Moving along the right edge stays in the same hotspot
+    manager.process_motion(fake_output(0), output_a, {1918, 1000});
+    mock_loop::get().move_forward(20);
+    REQUIRE(corner.activations == 1);
+
+    manager.process_motion(fake_output(0), output_a, {1800, 1000});
+    manager.process_motion(fake_output(0), output_a, {1918, 1000});
+    mock_loop::get().move_forward(20);
+    REQUIRE(corner.activations == 2);
+}
+
+TEST_CASE("Hotspots follow the output under the input")
+{
+    mock_loop::get().start(0);
+    wf::hotspot_manager_t manager;
+    hotspot_counter_t left;
+    manager.add_hotspot(left.create(OUTPUT_EDGE_LEFT, 2000, 5, 10));
+
+    // The left edge of the second output
+    manager.process_motion(fake_output(1), output_b, {1921, 500});
+    mock_loop::get().move_forward(20);
+    REQUIRE(left.activations == 1);
+
+    // Switching outputs resets the hotspot
+    manager.process_motion(fake_output(0), output_a, {1, 500});
+    mock_loop::get().move_forward(20);
+    REQUIRE(left.activations == 2);
+
+    // No output: nothing is active
+    manager.process_motion(nullptr, {0, 0, 0, 0}, {-100, -100});
+    manager.process_motion(fake_output(0), output_a, {1, 500});
+    mock_loop::get().move_forward(20);
+    REQUIRE(left.activations == 3);
+
+    // Removing the hotspots cancels pending activations
+    manager.process_motion(fake_output(0), output_a, {500, 500});
+    manager.process_motion(fake_output(0), output_a, {1, 500});
+    manager.clear();
+    mock_loop::get().move_forward(20);
+    REQUIRE(left.activations == 3);
+}
+
+TEST_CASE("Motion away from the edges does not test hotspots")
+{
+    mock_loop::get().start(0);
+    wf::hotspot_manager_t manager;
+    std::vector<hotspot_counter_t> counters(12);
+    const uint32_t edges[] = {
+        OUTPUT_EDGE_TOP, OUTPUT_EDGE_BOTTOM, OUTPUT_EDGE_LEFT, OUTPUT_EDGE_RIGHT,
+        OUTPUT_EDGE_TOP | OUTPUT_EDGE_LEFT, OUTPUT_EDGE_TOP | OUTPUT_EDGE_RIGHT,
+        OUTPUT_EDGE_BOTTOM | OUTPUT_EDGE_LEFT, OUTPUT_EDGE_BOTTOM | OUTPUT_EDGE_RIGHT,
+    };
+
+    for (size_t i = 0; i < counters.size(); i++)
+    {
+        manager.add_hotspot(counters[i].create(edges[i % 8], 100 + 10 * i, 10, 100));
+    }
+
+    // A synthetic stream: a 1000Hz mouse moving in a circle in the middle of
+    // the output, then along the top edge.
+    const int N = 20000;
+    for (int i = 0; i < N; i++)
+    {
+        double t = i * 0.001;
+        manager.process_motion(fake_output(0), output_a,
+            {960 + 400 * std::cos(t), 540 + 300 * std::sin(t)});
+    }
+
+    REQUIRE(manager.stats.tested == 0);
+    REQUIRE(manager.stats.entered == 0);
+
+    for (int i = 0; i < N; i++)
+    {
+        manager.process_motion(fake_output(0), output_a, {(double)(i % 1920), 2});
+    }
+
+    REQUIRE(manager.stats.tested == N);
+    REQUIRE(manager.stats.entered > 0);
+}
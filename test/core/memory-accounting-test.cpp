@@ -0,0 +1,147 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/memory-accounting.hpp>
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+
+using wf::memory_kind_t;
+
+static const wf::memory_tag_t blur_tag   = {"blur", "blur buffer"};
+static const wf::memory_tag_t cache_tag  = {"blur", "background cache"};
+static const wf::memory_tag_t stream_tag  = {"core", "workspace stream"};
+
+TEST_CASE("Live and peak bytes are tracked per tag and per owner")
+{
+    wf::memory_accounting_t accounting;
+    accounting.track(memory_kind_t::GL_TEXTURE, 1, 100, blur_tag);
+    accounting.track(memory_kind_t::GL_TEXTURE, 2, 50, cache_tag);
+    accounting.track(memory_kind_t::GL_TEXTURE, 3, 400, stream_tag);
+
+    // The same key in another kind is another allocation
+    accounting.track(memory_kind_t::CPU, 1, 10, blur_tag);
+
+    auto& owners = accounting.get_usage_by_owner();
+    REQUIRE(owners.at("blur").live_bytes == 160);
+    REQUIRE(owners.at("blur").allocations == 3);
+    REQUIRE(owners.at("core").live_bytes == 400);
+    REQUIRE(accounting.get_usage_by_tag().at(blur_tag).live_bytes == 110);
+    REQUIRE(accounting.get_total_usage().live_bytes == 560);
+
+    // Resizing replaces the old size
+    accounting.track(memory_kind_t::GL_TEXTURE, 1, 300, blur_tag);
+    REQUIRE(accounting.get_usage_by_tag().at(blur_tag).live_bytes == 310);
+    REQUIRE(accounting.get_usage_by_tag().at(blur_tag).allocations == 2);
+
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 1);
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 1);
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 3);
+    REQUIRE(owners.at("blur").live_bytes == 60);
+    REQUIRE(owners.at("blur").peak_bytes == 360);
+    REQUIRE(owners.at("core").live_bytes == 0);
+    REQUIRE(owners.at("core").peak_bytes == 400);
+    REQUIRE(accounting.get_total_usage().peak_bytes == 760);
+}
+
+TEST_CASE("Scopes tag untagged allocations")
+{
+    wf::memory_accounting_t accounting;
+    accounting.track(memory_kind_t::GL_TEXTURE, 1, 10);
+    {
+        wf::memory_tag_scope_t outer{accounting, stream_tag};
+        accounting.track(memory_kind_t::GL_TEXTURE, 2, 20);
+        {
+            wf::memory_tag_scope_t inner{accounting, cache_tag};
+            accounting.track(memory_kind_t::GL_TEXTURE, 3, 30);
+        }
+
+        accounting.track(memory_kind_t::GL_TEXTURE, 4, 40);
+    }
+
+    auto& tags = accounting.get_usage_by_tag();
+    REQUIRE(tags.at(wf::memory_tag_t{}).live_bytes == 10);
+    REQUIRE(tags.at(stream_tag).live_bytes == 60);
+    REQUIRE(tags.at(cache_tag).live_bytes == 30);
+    REQUIRE(accounting.current_tag().owner == "core");
+    REQUIRE(accounting.current_tag().purpose.empty());
+}
+
+TEST_CASE("Exceeding a budget is signalled once until back within it")
+{
+    wf::memory_accounting_t accounting;
+    std::vector<wf::memory_budget_exceeded_signal> events;
+    wf::signal::connection_t<wf::memory_budget_exceeded_signal> on_exceeded =
+        [&] (wf::memory_budget_exceeded_signal *ev) { events.push_back(*ev); };
+    wf::get_core().connect(&on_exceeded);
+
+    accounting.set_budget("blur", 100);
+    accounting.track(memory_kind_t::GL_TEXTURE, 1, 80, blur_tag);
+    accounting.track(memory_kind_t::GL_TEXTURE, 2, 500, stream_tag);
+    REQUIRE(events.empty());
+
+    accounting.track(memory_kind_t::GL_TEXTURE, 3, 40, cache_tag);
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].owner == "blur");
+    REQUIRE(events[0].live_bytes == 120);
+    REQUIRE(events[0].budget == 100);
+
+    accounting.track(memory_kind_t::GL_TEXTURE, 4, 40, cache_tag);
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 1);
+
+    // Back within the budget, then over it again
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 3);
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 4);
+    accounting.track(memory_kind_t::GL_TEXTURE, 3, 40, cache_tag);
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 2);
+
+    // A lower budget is checked immediately, removing it stops the signals
+    accounting.set_budget("core", 100);
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[2].owner == "core");
+    accounting.set_budget("blur", 0);
+    accounting.track(memory_kind_t::GL_TEXTURE, 5, 1000, blur_tag);
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 3);
+    REQUIRE(accounting.get_budgets().size() == 1);
+}
+
+TEST_CASE("Crossing a budget inside a scope is signalled once idle")
+{
+    wf::memory_accounting_t accounting;
+    std::vector<wf::memory_budget_exceeded_signal> events;
+    wf::signal::connection_t<wf::memory_budget_exceeded_signal> on_exceeded =
+        [&] (wf::memory_budget_exceeded_signal *ev) { events.push_back(*ev); };
+    wf::get_core().connect(&on_exceeded);
+
+    accounting.set_budget("blur", 100);
+    {
+        // As in the middle of a render pass: nothing may run under the caller
+        wf::memory_tag_scope_t scope{accounting, cache_tag};
+        accounting.track(memory_kind_t::GL_TEXTURE, 1, 60);
+        accounting.track(memory_kind_t::GL_TEXTURE, 2, 60);
+        accounting.track(memory_kind_t::GL_TEXTURE, 3, 60);
+        REQUIRE(events.empty());
+    }
+
+    REQUIRE(events.empty());
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].owner == "blur");
+    REQUIRE(events[0].live_bytes == 180);
+
+    // Back within the budget before the loop is idle: nothing to report
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 3);
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 2);
+    {
+        wf::memory_tag_scope_t scope{accounting, cache_tag};
+        accounting.track(memory_kind_t::GL_TEXTURE, 2, 60);
+    }
+
+    accounting.untrack(memory_kind_t::GL_TEXTURE, 2);
+    mock_loop::get().dispatch_idle();
+    REQUIRE(events.size() == 1);
+}
@@ -0,0 +1,180 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/scene-profiler.hpp>
+#include <wayfire/scene-operations.hpp>
+#include "../mock-core.hpp"
+
+using namespace wf::scene;
+
+/** A leaf node whose render instance schedules one instruction and counts calls. */
+class counting_node_t : public node_t
+{
+  public:
+    int rendered  = 0;
+    int presented = 0;
+
+    counting_node_t() : node_t(false)
+    {}
+
+    std::string stringify() const override
+    {
+        return "counting";
+    }
+
+    class instance_t : public render_instance_t
+    {
+        counting_node_t *self;
+
+      public:
+        instance_t(counting_node_t *self) : self(self)
+        {}
+
+        void schedule_instructions(std::vector<render_instruction_t>& instructions,
+            const wf::render_target_t& target, wf::region_t& damage) override
+        {
+            instructions.push_back(render_instruction_t{
+                        .instance = this,
+                        .target   = target,
+                        .damage   = damage,
+                    });
+        }
+
+        void render(const wf::render_target_t&, const wf::region_t&) override
+        {
+            ++self->rendered;
+        }
+
+        void presentation_feedback(wf::output_t*) override
+        {
+            ++self->presented;
+        }
+    };
+
+    void gen_render_instances(std::vector<render_instance_uptr>& instances,
+        damage_callback, wf::output_t*) override
+    {
+        instances.push_back(std::make_unique<instance_t>(this));
+    }
+};
+
+static void render_frame(std::vector<render_instance_uptr>& instances)
+{
+    wf::region_t damage{wf::geometry_t{0, 0, 100, 100}};
+    std::vector<render_instruction_t> instructions;
+    for (auto& inst : instances)
+    {
+        inst->schedule_instructions(instructions, {}, damage);
+    }
+
+    for (auto& instr : instructions)
+    {
+        instr.instance->render(instr.target, instr.damage, instr.data);
+        instr.instance->presentation_feedback(nullptr);
+    }
+}
+
+static void begin_pass()
+{
+    wf::region_t damage;
+    render_pass_begin_signal ev{damage, wf::render_target_t{}};
+    wf::get_core().emit(&ev);
+}
+
+TEST_CASE("Render instances of nested children are wrapped and timed")
+{
+    auto& profiler = *wf::get_core().scene_profiler;
+    profiler.set_enabled(true);
+
+    auto leaf  = std::make_shared<counting_node_t>();
+    auto inner = std::make_shared<floating_inner_node_t>(false);
+    inner->set_children_list({leaf});
+    auto outer = std::make_shared<floating_inner_node_t>(false);
+    outer->set_children_list({inner});
+
+    {
+        std::vector<render_instance_uptr> instances;
+        outer->gen_render_instances(instances, [] (auto) {}, nullptr);
+
+        // The leaf's instance is wrapped by itself and again by the inner node
+        auto leaf_profile  = profiler.get_profile(leaf.get());
+        auto inner_profile = profiler.get_profile(inner.get());
+        REQUIRE(leaf_profile != nullptr);
+        REQUIRE(inner_profile != nullptr);
+        REQUIRE(leaf_profile->render_instances == 1);
+        REQUIRE(inner_profile->render_instances == 2);
+        REQUIRE(profiler.get_profile(outer.get()) == nullptr);
+
+        render_frame(instances);
+        render_frame(instances);
+
+        // Instructions are rendered and presented exactly once per frame
+        // through both wrappers.
+        REQUIRE(leaf->rendered == 2);
+        REQUIRE(leaf->presented == 2);
+        REQUIRE(leaf_profile->schedule_calls == 2);
+        REQUIRE(leaf_profile->render_calls == 2);
+        REQUIRE(inner_profile->schedule_calls == 4);
+        REQUIRE(inner_profile->render_calls == 2);
+        REQUIRE(inner_profile->render_ns >= leaf_profile->render_ns);
+    }
+
+    REQUIRE(profiler.get_profile(leaf.get())->render_instances == 0);
+    REQUIRE(profiler.get_profile(inner.get())->render_instances == 0);
+
+    // Disabled: nothing is wrapped or recorded
+    profiler.set_enabled(false);
+    REQUIRE(profiler.get_profile(leaf.get()) == nullptr);
+    std::vector<render_instance_uptr> instances;
+    outer->gen_render_instances(instances, [] (auto) {}, nullptr);
+    render_frame(instances);
+    REQUIRE(leaf->rendered == 3);
+    REQUIRE(profiler.get_profile(leaf.get()) == nullptr);
+}
+
+TEST_CASE("Damage is kept for the last render passes only")
+{
+    auto& profiler = *wf::get_core().scene_profiler;
+    profiler.set_enabled(true);
+    profiler.set_history(3);
+
+    // Nodes added to the scenegraph are tracked
+    auto node = std::make_shared<counting_node_t>();
+    add_front(wf::get_core().scene()->layers[(size_t)layer::WORKSPACE], node);
+    REQUIRE(profiler.get_profile(node.get()) != nullptr);
+
+    for (int i = 0; i < 6; i++)
+    {
+        damage_node(node, wf::geometry_t{i, 0, 1, 1});
+        damage_node(node, wf::geometry_t{i, 1, 1, 1});
+        begin_pass();
+    }
+
+    auto profile = profiler.get_profile(node.get());
+    REQUIRE(profiler.get_pass_count() == 6);
+    REQUIRE(profile->damage.size() == 3);
+    REQUIRE(profile->damage.front().pass == 3);
+    REQUIRE(profile->damage.back().pass == 5);
+    // Damage from the same pass is merged
+    REQUIRE(wlr_box_from_pixman_box(profile->damage.back().region.get_extents()) ==
+        wf::geometry_t{5, 0, 1, 2});
+
+    // Old damage is dropped even if the node is not damaged again
+    begin_pass();
+    begin_pass();
+    REQUIRE(profile->damage.size() == 1);
+    REQUIRE(profile->damage.front().pass == 5);
+
+    profiler.reset();
+    REQUIRE(profiler.get_pass_count() == 0);
+    REQUIRE(profile->damage.empty());
+
+    // Destroyed nodes have no profile
+    auto raw_node = node.get();
+    remove_child(node);
+    node.reset();
+    REQUIRE(profiler.get_profile(raw_node) == nullptr);
+
+    profiler.set_history(scene_profiler_t::DEFAULT_HISTORY);
+    profiler.set_enabled(false);
+}
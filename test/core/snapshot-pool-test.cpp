@@ -0,0 +1,129 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/snapshot-pool.hpp>
+
+/* Hands out fake GL names, so that no GL context is needed. */
+struct fake_allocator_t
+{
+    int allocated = 0;
+    int freed     = 0;
+
+    wf::snapshot_pool_t::allocator_t get()
+    {
+        wf::snapshot_pool_t::allocator_t allocator;
+        allocator.allocate = [=] (int width, int height)
+        {
+            ++allocated;
+            wf::framebuffer_t buffer;
+            buffer.tex = allocated;
+            buffer.fb  = allocated;
+            buffer.viewport_width  = width;
+            buffer.viewport_height = height;
+            return buffer;
+        };
+
+        allocator.free = [=] (wf::framebuffer_t& buffer)
+        {
+            ++freed;
+            buffer.reset();
+        };
+
+        return allocator;
+    }
+};
+
+TEST_CASE("Buffers are reused within a bucket")
+{
+    fake_allocator_t fake;
+    wf::snapshot_pool_t pool{fake.get()};
+
+    auto a = pool.acquire(100, 30);
+    REQUIRE(a.viewport_width == 128);
+    REQUIRE(a.viewport_height == 64);
+    REQUIRE(pool.get_stats().misses == 1);
+    REQUIRE(pool.get_stats().buffers_in_use == 1);
+    pool.release(a);
+    REQUIRE(pool.get_stats().buffers_in_use == 0);
+    REQUIRE(pool.get_stats().idle_bytes == 128 * 64 * 4);
+
+    // Slightly different size, same bucket
+    auto b = pool.acquire(120, 60);
+    REQUIRE(b.tex == a.tex);
+    REQUIRE(pool.get_stats().hits == 1);
+    REQUIRE(pool.get_stats().idle_bytes == 0);
+
+    // Another bucket
+    auto c = pool.acquire(130, 60);
+    REQUIRE(c.tex != a.tex);
+    REQUIRE(c.viewport_width == 192);
+    REQUIRE(pool.get_stats().misses == 2);
+    REQUIRE(pool.get_stats().allocated_bytes == (128 * 64 + 192 * 64) * 4);
+
+    pool.release(b);
+    pool.release(c);
+    pool.clear();
+    REQUIRE(fake.freed == 2);
+    REQUIRE(pool.get_stats().allocated_bytes == 0);
+    REQUIRE(pool.get_stats().idle_bytes == 0);
+}
+
+TEST_CASE("The most recently used buffer is reused")
+{
+    fake_allocator_t fake;
+    wf::snapshot_pool_t pool{fake.get()};
+
+    auto a = pool.acquire(64, 64);
+    auto b = pool.acquire(64, 64);
+    pool.release(a);
+    pool.release(b);
+
+    REQUIRE(pool.acquire(64, 64).tex == b.tex);
+}
+
+TEST_CASE("Idle buffers over the budget are evicted, oldest first")
+{
+    fake_allocator_t fake;
+    wf::snapshot_pool_t pool{fake.get()};
+    const size_t size = 64 * 64 * 4;
+    pool.set_budget(2 * size);
+
+    auto a = pool.acquire(64, 64);
+    auto b = pool.acquire(64, 64);
+    auto c = pool.acquire(64, 64);
+    pool.release(a);
+    pool.release(b);
+    REQUIRE(fake.freed == 0);
+
+    // Buffers in use do not count towards the budget
+    REQUIRE(pool.get_stats().allocated_bytes == 3 * size);
+
+    pool.release(c);
+    REQUIRE(fake.freed == 1);
+    REQUIRE(pool.get_stats().evictions == 1);
+    REQUIRE(pool.get_stats().idle_bytes == 2 * size);
+
+    // a was evicted, c is the newest
+    REQUIRE(pool.acquire(64, 64).tex == c.tex);
+    REQUIRE(pool.acquire(64, 64).tex == b.tex);
+    REQUIRE(pool.acquire(64, 64).tex != a.tex);
+
+    pool.set_budget(0);
+    REQUIRE(pool.get_stats().idle_bytes == 0);
+}
+
+TEST_CASE("Subbuffer textures cover only the used part")
+{
+    wf::render_target_t target;
+    target.viewport_width  = 128;
+    target.viewport_height = 64;
+    REQUIRE(!wf::get_subbuffer_texture(target).has_viewport);
+
+    target.subbuffer = wf::geometry_t{0, 0, 64, 48};
+    auto texture = wf::get_subbuffer_texture(target);
+    REQUIRE(texture.has_viewport);
+    REQUIRE(texture.viewport_box.x1 == doctest::Approx(0.0));
+    REQUIRE(texture.viewport_box.x2 == doctest::Approx(0.5));
+    REQUIRE(texture.viewport_box.y1 == doctest::Approx(0.25));
+    REQUIRE(texture.viewport_box.y2 == doctest::Approx(1.0));
+}
@@ -0,0 +1,100 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/view-transform.hpp>
+#include <wayfire/compositor-view.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include "../../src/view/view-impl.hpp"
+#include "../mock-core.hpp"
+#include "../mock-output.hpp"
+
+/** A transformer whose effect on regions is unknown, like wobbly. */
+class fake_transformer_t : public wf::scene::floating_inner_node_t
+{
+  public:
+    fake_transformer_t(wf::geometry_t bbox) : floating_inner_node_t(false), bbox(bbox)
+    {}
+
+    wf::geometry_t get_bounding_box() override
+    {
+        return bbox;
+    }
+
+  private:
+    wf::geometry_t bbox;
+};
+
+static wf::geometry_t extents(const wf::region_t& region)
+{
+    return wlr_box_from_pixman_box(region.get_extents());
+}
+
+TEST_CASE("Regions are unchanged without transformers")
+{
+    auto tmgr = std::make_shared<wf::scene::transform_manager_node_t>();
+    wf::region_t damage{wf::geometry_t{10, 20, 30, 40}};
+
+    auto result = tmgr->transform_region(damage);
+    REQUIRE(extents(result) == wf::geometry_t{10, 20, 30, 40});
+}
+
+TEST_CASE("Unknown transformers damage their whole bounding box")
+{
+    // Transformers with a higher z order wrap those with a lower one
+    auto tmgr  = std::make_shared<wf::scene::transform_manager_node_t>();
+    auto inner = std::make_shared<fake_transformer_t>(wf::geometry_t{0, 0, 200, 100});
+    auto outer = std::make_shared<fake_transformer_t>(wf::geometry_t{-50, -50, 300, 200});
+    tmgr->add_transformer(outer, 10, "outer");
+    tmgr->add_transformer(inner, 0, "inner");
+    REQUIRE(tmgr->get_children().front() == outer);
+
+    // A small damage ends up as the bbox of the outermost transformer
+    wf::region_t damage{wf::geometry_t{10, 10, 5, 5}};
+    REQUIRE(extents(tmgr->transform_region(damage)) == wf::geometry_t{-50, -50, 300, 200});
+
+    // No damage stays no damage
+    REQUIRE(tmgr->transform_region(wf::region_t{}).empty());
+
+    tmgr->rem_transformer<fake_transformer_t>("outer");
+    REQUIRE(extents(tmgr->transform_region(damage)) == wf::geometry_t{0, 0, 200, 100});
+
+    tmgr->rem_transformer<fake_transformer_t>("inner");
+    REQUIRE(extents(tmgr->transform_region(damage)) == wf::geometry_t{10, 10, 5, 5});
+}
+
+TEST_CASE("Damaging a sticky view does not depend on the workspace grid")
+{
+    // The output has no workspace manager at all, so the damage path cannot
+    // visit the workspaces of the grid.
+    mock_output_t output{{1920, 1080}};
+    wf::color_rect_view_t view;
+    view.priv->output = &output;
+    view.sticky = true;
+    view.set_geometry({100, 100, 50, 50});
+
+    std::vector<wf::region_t> sticky_damage;
+    wf::signal::connection_t<wf::output_sticky_damage_signal> on_sticky =
+        [&] (wf::output_sticky_damage_signal *ev) { sticky_damage.push_back(ev->region); };
+    output.connect(&on_sticky);
+
+    int node_damage = 0;
+    wf::signal::connection_t<wf::scene::node_damage_signal> on_damage =
+        [&] (wf::scene::node_damage_signal *ev)
+    {
+        ++node_damage;
+        REQUIRE(extents(ev->region) == wf::geometry_t{100, 100, 50, 50});
+    };
+    view.get_transformed_node()->connect(&on_damage);
+
+    view.damage();
+    REQUIRE(node_damage == 1);
+    REQUIRE(sticky_damage.size() == 1);
+    REQUIRE(extents(sticky_damage[0]) == wf::geometry_t{100, 100, 50, 50});
+
+    // Damage outside of the current workspace is clipped
+    wf::view_damage_raw({&view}, {1900, 0, 100, 100});
+    REQUIRE(sticky_damage.size() == 2);
+    REQUIRE(extents(sticky_damage[1]) == wf::geometry_t{1900, 0, 20, 100});
+
+    view.priv->output = nullptr;
+}
@@ -0,0 +1,112 @@
+/**
+ * Times the view registry with 5,000 synthetic views: adding them, looking
+ * them up by id and by handle, the secondary indices and removing them. The
+ * same lookups and removals are timed on a plain vector of views, as core
+ * kept them before the registry, for comparison.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include <wayfire/view-registry.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/* The registry never dereferences views when explicit keys are given. */
+static wayfire_view fake_view(int i)
+{
+    return wayfire_view((wf::view_interface_t*)(uintptr_t)((i + 1) * 16));
+}
+
+static wf::output_t *fake_output(int i)
+{
+    return (wf::output_t*)(uintptr_t)((i + 1) * 0x1000);
+}
+
+int main()
+{
+    constexpr int N = 5000;
+
+    std::printf("view registry, %d views\n", N);
+    std::printf("%-20s %14s %14s\n", "operation", "registry-us", "vector-us");
+
+    wf::view_registry_t registry;
+    std::vector<wf::view_handle_t> handles;
+    std::vector<std::pair<uint32_t, wayfire_view>> vector;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++)
+    {
+        handles.push_back(registry.add(fake_view(i),
+            {(uint32_t)i, "app-" + std::to_string(i % 50), fake_output(i % 4),
+                wf::VIEW_ROLE_TOPLEVEL}));
+    }
+
+    double registry_us = elapsed_us(start);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++)
+    {
+        vector.push_back({(uint32_t)i, fake_view(i)});
+    }
+
+    std::printf("%-20s %14.1f %14.1f\n", "add", registry_us, elapsed_us(start));
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++)
+    {
+        found += (registry.find_by_id(i) == fake_view(i));
+        found += (registry.get(handles[i]) == fake_view(i));
+    }
+
+    registry_us = elapsed_us(start);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++)
+    {
+        auto it = std::find_if(vector.begin(), vector.end(),
+            [&] (auto& entry) { return entry.first == (uint32_t)i; });
+        found += (it->second == fake_view(i));
+    }
+
+    std::printf("%-20s %14.1f %14.1f\n", "find by id", registry_us, elapsed_us(start));
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 50; i++)
+    {
+        found += registry.get_by_app_id("app-" + std::to_string(i)).size();
+        found += registry.get_by_output(fake_output(i % 4)).size();
+    }
+
+    std::printf("%-20s %14.1f %14s\n", "indexed queries", elapsed_us(start), "-");
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i += 2)
+    {
+        registry.remove(handles[i]);
+    }
+
+    found += registry.get_all().size();
+    registry_us = elapsed_us(start);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i += 2)
+    {
+        auto it = std::find(vector.begin(), vector.end(),
+            std::pair<uint32_t, wayfire_view>{(uint32_t)i, fake_view(i)});
+        vector.erase(it);
+    }
+
+    std::printf("%-20s %14.1f %14.1f\n", "remove half", registry_us, elapsed_us(start));
+
+    if ((registry.size() != N / 2) || (vector.size() != N / 2) || (found == 0))
+    {
+        std::fprintf(stderr, "unexpected registry contents\n");
+        return 1;
+    }
+
+    return 0;
+}
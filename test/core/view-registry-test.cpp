@@ -0,0 +1,163 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/view-registry.hpp>
+#include <algorithm>
+
+/* The registry never dereferences views when explicit keys are given. */
+static wayfire_view fake_view(int i)
+{
+    return wayfire_view((wf::view_interface_t*)(uintptr_t)((i + 1) * 16));
+}
+
+static wf::output_t *fake_output(int i)
+{
+    return (wf::output_t*)(uintptr_t)((i + 1) * 0x1000);
+}
+
+static wf::view_registry_keys_t keys(int id, std::string app_id, int output,
+    wf::view_role_t role = wf::VIEW_ROLE_TOPLEVEL)
+{
+    return {(uint32_t)id, app_id, fake_output(output), role};
+}
+
+TEST_CASE("Adding, finding and removing views")
+{
+    wf::view_registry_t registry;
+    auto a = registry.add(fake_view(0), keys(10, "term", 0));
+    auto b = registry.add(fake_view(1), keys(11, "term", 1));
+
+    REQUIRE(registry.size() == 2);
+    REQUIRE(registry.get(a) == fake_view(0));
+    REQUIRE(registry.get(b) == fake_view(1));
+    REQUIRE(registry.get_handle(fake_view(1)) == b);
+    REQUIRE(registry.find_by_id(10) == fake_view(0));
+    REQUIRE(registry.find_by_id(12) == nullptr);
+
+    // Adding a view twice keeps its handle
+    REQUIRE(registry.add(fake_view(0), keys(10, "term", 0)) == a);
+    REQUIRE(registry.size() == 2);
+
+    registry.remove(fake_view(0));
+    REQUIRE(registry.size() == 1);
+    REQUIRE(registry.get(a) == nullptr);
+    REQUIRE(registry.find_by_id(10) == nullptr);
+    REQUIRE(registry.get_all() == std::vector<wayfire_view>{fake_view(1)});
+
+    // The slot is reused, but the old handle stays stale
+    auto c = registry.add(fake_view(2), keys(12, "browser", 0));
+    REQUIRE(c.index == a.index);
+    REQUIRE(c != a);
+    REQUIRE(registry.get(a) == nullptr);
+    REQUIRE(registry.get(c) == fake_view(2));
+
+    // Removing a stale handle does nothing
+    registry.remove(a);
+    REQUIRE(registry.size() == 2);
+}
+
+TEST_CASE("Indices follow updates")
+{
+    wf::view_registry_t registry;
+    registry.add(fake_view(0), keys(1, "term", 0));
+    registry.add(fake_view(1), keys(2, "term", 1));
+    registry.add(fake_view(2), keys(3, "panel", 0, wf::VIEW_ROLE_DESKTOP_ENVIRONMENT));
+
+    auto sorted = [] (std::vector<wayfire_view> views)
+    {
+        std::sort(views.begin(), views.end());
+        return views;
+    };
+
+    REQUIRE(sorted(registry.get_by_app_id("term")) ==
+        sorted({fake_view(0), fake_view(1)}));
+    REQUIRE(sorted(registry.get_by_output(fake_output(0))) ==
+        sorted({fake_view(0), fake_view(2)}));
+    REQUIRE(registry.get_by_role(wf::VIEW_ROLE_DESKTOP_ENVIRONMENT) ==
+        std::vector<wayfire_view>{fake_view(2)});
+
+    registry.update(fake_view(0), keys(1, "editor", 1));
+    REQUIRE(registry.get_by_app_id("term") == std::vector<wayfire_view>{fake_view(1)});
+    REQUIRE(registry.get_by_app_id("editor") == std::vector<wayfire_view>{fake_view(0)});
+    REQUIRE(registry.get_by_output(fake_output(0)) == std::vector<wayfire_view>{fake_view(2)});
+    REQUIRE(sorted(registry.get_by_output(fake_output(1))) ==
+        sorted({fake_view(0), fake_view(1)}));
+
+    registry.remove(fake_view(1));
+    REQUIRE(registry.get_by_app_id("term").empty());
+    REQUIRE(registry.get_by_output(fake_output(1)) == std::vector<wayfire_view>{fake_view(0)});
+    REQUIRE(registry.get_by_role(wf::VIEW_ROLE_TOPLEVEL) ==
+        std::vector<wayfire_view>{fake_view(0)});
+}
+
+TEST_CASE("All views keep the order in which they were added")
+{
+    constexpr int N = 1000;
+
+    wf::view_registry_t registry;
+    std::vector<wf::view_handle_t> handles;
+    for (int i = 0; i < N; i++)
+    {
+        handles.push_back(registry.add(fake_view(i),
+            keys(i, "app-" + std::to_string(i % 50), i % 4)));
+    }
+
+    for (int i = 0; i < N; i++)
+    {
+        REQUIRE(registry.find_by_id(i) == fake_view(i));
+        REQUIRE(registry.get(handles[i]) == fake_view(i));
+    }
+
+    REQUIRE(registry.get_by_output(fake_output(2)).size() == N / 4);
+    REQUIRE(registry.get_by_app_id("app-7").size() == N / 50);
+
+    for (int i = 0; i < N; i += 2)
+    {
+        registry.remove(handles[i]);
+    }
+
+    // New views go after the existing ones, even when they reuse a slot
+    registry.add(fake_view(N), keys(N, "new", 0));
+    REQUIRE(registry.size() == N / 2 + 1);
+
+    std::vector<wayfire_view> expected;
+    for (int i = 1; i < N; i += 2)
+    {
+        expected.push_back(fake_view(i));
+    }
+
+    expected.push_back(fake_view(N));
+    REQUIRE(registry.get_all() == expected);
+
+    // Removals after compaction still find the right views
+    registry.remove(fake_view(1));
+    registry.remove(fake_view(N));
+    expected.erase(expected.begin());
+    expected.pop_back();
+    REQUIRE(registry.get_all() == expected);
+    REQUIRE(registry.find_by_id(3) == fake_view(3));
+}
+
+TEST_CASE("Indices keep the order in which views were added")
+{
+    wf::view_registry_t registry;
+    for (int i = 0; i < 8; i++)
+    {
+        registry.add(fake_view(i), keys(i, "term", 0));
+    }
+
+    // Removals and updates reorder the index lists internally
+    registry.remove(fake_view(1));
+    registry.remove(fake_view(4));
+    registry.update(fake_view(2), keys(2, "term", 1));
+    registry.update(fake_view(2), keys(2, "term", 0));
+    registry.add(fake_view(8), keys(8, "term", 0));
+
+    const std::vector<wayfire_view> expected = {
+        fake_view(0), fake_view(2), fake_view(3), fake_view(5),
+        fake_view(6), fake_view(7), fake_view(8),
+    };
+    REQUIRE(registry.get_by_output(fake_output(0)) == expected);
+    REQUIRE(registry.get_by_app_id("term") == expected);
+    REQUIRE(registry.get_by_role(wf::VIEW_ROLE_TOPLEVEL) == expected);
+}
@@ -0,0 +1,77 @@
+/**
+ * Compares the cost of a stipc/list_views round trip with 500 views in each
+ * IPC encoding. The compositor decodes the request and encodes the response,
+ * the client encodes the request and decodes the response. Building the JSON
+ * object of the response is the same for all encodings and is not included.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include "ipc-encoding.hpp"
+#include "view-list.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using wf::ipc::encoding_t;
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    constexpr int views = 500;
+    constexpr int iterations = 200;
+
+    const auto response = make_view_list(views);
+    const nlohmann::json request = {{"method", "stipc/list_views"}, {"data", nlohmann::json::object()}};
+
+    struct
+    {
+        const char *name;
+        encoding_t encoding;
+    } encodings[] = {
+        {"json", encoding_t::JSON},
+        {"cbor", encoding_t::CBOR},
+        {"msgpack", encoding_t::MSGPACK},
+    };
+
+    std::printf("list_views round trip, %d views, %d iterations\n", views, iterations);
+    std::printf("%-8s %10s %16s %14s %14s\n",
+        "encoding", "bytes", "compositor-us", "client-us", "round-trip-us");
+    for (auto& [name, encoding] : encodings)
+    {
+        double compositor = 0, client = 0;
+        size_t bytes = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto req   = wf::ipc::encode_message(request, encoding);
+            client += elapsed_us(start);
+
+            start = std::chrono::steady_clock::now();
+            auto decoded_req = wf::ipc::decode_message(req.data(), req.size(), encoding);
+            auto resp = wf::ipc::encode_message(response, encoding);
+            compositor += elapsed_us(start);
+
+            start = std::chrono::steady_clock::now();
+            auto decoded_resp = wf::ipc::decode_message(resp.data(), resp.size(), encoding);
+            client += elapsed_us(start);
+
+            if (decoded_req.is_discarded() || (decoded_resp.size() != (size_t)views))
+            {
+                std::fprintf(stderr, "%s: round trip failed\n", name);
+                return 1;
+            }
+
+            bytes = resp.size();
+        }
+
+        std::printf("%-8s %10zu %16.1f %14.1f %14.1f\n", name, bytes,
+            compositor / iterations, client / iterations, (compositor + client) / iterations);
+    }
+
+    return 0;
+}
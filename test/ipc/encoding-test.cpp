@@ -0,0 +1,40 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "ipc-encoding.hpp"
+#include "view-list.hpp"
+
+using wf::ipc::encoding_t;
+
+TEST_CASE("Messages survive a round trip in all encodings")
+{
+    auto views = make_view_list(500);
+    for (auto encoding : {encoding_t::JSON, encoding_t::CBOR, encoding_t::MSGPACK})
+    {
+        auto bytes   = wf::ipc::encode_message(views, encoding);
+        auto decoded = wf::ipc::decode_message(bytes.data(), bytes.size(), encoding);
+        REQUIRE_FALSE(decoded.is_discarded());
+        REQUIRE(decoded == views);
+    }
+}
+
+TEST_CASE("Binary encodings are more compact than JSON")
+{
+    auto views = make_view_list(500);
+    auto json  = wf::ipc::encode_message(views, encoding_t::JSON).size();
+    REQUIRE(wf::ipc::encode_message(views, encoding_t::CBOR).size() < json);
+    REQUIRE(wf::ipc::encode_message(views, encoding_t::MSGPACK).size() < json);
+}
+
+TEST_CASE("Invalid messages are discarded")
+{
+    const std::string garbage = "\xff\xff{\"method";
+    for (auto encoding : {encoding_t::JSON, encoding_t::CBOR, encoding_t::MSGPACK})
+    {
+        REQUIRE(wf::ipc::decode_message(garbage.data(), garbage.size(), encoding).is_discarded());
+    }
+
+    // A message in another encoding than the one negotiated
+    auto cbor = wf::ipc::encode_message({{"method", "stipc/list_views"}}, encoding_t::CBOR);
+    REQUIRE(wf::ipc::decode_message(cbor.data(), cbor.size(), encoding_t::JSON).is_discarded());
+}
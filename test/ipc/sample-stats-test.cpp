@@ -0,0 +1,43 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "sample-stats.hpp"
+
+TEST_CASE("Empty sample stats")
+{
+    wf::ipc::sample_stats_t stats;
+    REQUIRE_EQ(stats.get_count(), 0);
+    REQUIRE_EQ(stats.get_mean(), 0.0);
+    REQUIRE_EQ(stats.get_percentile(50), 0.0);
+}
+
+TEST_CASE("Sample stats summary")
+{
+    wf::ipc::sample_stats_t stats;
+    for (int i = 100; i >= 1; i--)
+    {
+        stats.add(i);
+    }
+
+    REQUIRE_EQ(stats.get_count(), 100);
+    REQUIRE_EQ(stats.get_min(), 1.0);
+    REQUIRE_EQ(stats.get_max(), 100.0);
+    REQUIRE_EQ(stats.get_mean(), doctest::Approx(50.5));
+    REQUIRE_EQ(stats.get_percentile(0), 1.0);
+    REQUIRE_EQ(stats.get_percentile(50), 50.0);
+    REQUIRE_EQ(stats.get_percentile(95), 95.0);
+    REQUIRE_EQ(stats.get_percentile(100), 100.0);
+
+    // Adding after a percentile query must keep the results correct
+    stats.add(0);
+    REQUIRE_EQ(stats.get_min(), 0.0);
+    REQUIRE_EQ(stats.get_percentile(0), 0.0);
+
+    auto json = stats.to_json();
+    REQUIRE_EQ(json["count"], 101);
+    REQUIRE_EQ(json["max"], 100.0);
+
+    stats.reset();
+    REQUIRE_EQ(stats.get_count(), 0);
+    REQUIRE_EQ(stats.get_percentile(99), 0.0);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+/**
+ * A response of stipc/list_views with the given number of views, with the
+ * same fields as the real one.
+ */
+inline nlohmann::json make_view_list(int count)
+{
+    auto geometry = [] (int x, int y, int w, int h)
+    {
+        return nlohmann::json{{"x", x}, {"y", y}, {"width", w}, {"height", h}};
+    };
+
+    auto response = nlohmann::json::array();
+    for (int i = 0; i < count; i++)
+    {
+        nlohmann::json v;
+        v["id"]     = i + 1;
+        v["title"]  = "Terminal " + std::to_string(i) + " - ~/src/project";
+        v["app-id"] = (i % 3) ? "org.gnome.Terminal" : "firefox";
+        v["geometry"] = geometry(20 * (i % 40), 15 * (i % 50), 800, 600);
+        v["base-geometry"] = geometry(20 * (i % 40) - 10, 15 * (i % 50) - 10, 820, 620);
+        v["state"] = {
+            {"tiled", (i % 7) ? 0 : 15},
+            {"fullscreen", (i % 50) == 0},
+            {"minimized", (i % 11) == 0},
+        };
+        v["layer"] = "workspace";
+        response.push_back(v);
+    }
+
+    return response;
+}
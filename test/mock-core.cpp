@@ -135,7 +135,10 @@ void mock_core_t::move_view_to_output(wayfire_view v,
 {}
 
 mock_core_t::mock_core_t()
-{}
+{
+    // An empty scenegraph, without outputs
+    this->scene_root = std::make_shared<wf::scene::root_node_t>();
+}
 mock_core_t::~mock_core_t() = default;
 
 wf::compositor_core_impl_t& wf::compositor_core_impl_t::get()
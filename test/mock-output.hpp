@@ -0,0 +1,92 @@
+#pragma once
+
+#include <wayfire/output.hpp>
+
+/**
+ * An output without a backing wlr_output, render manager or workspace
+ * manager. It only has a size and emits signals, which is enough for code
+ * which only needs the output's geometry or listens on it.
+ */
+class mock_output_t : public wf::output_t
+{
+  public:
+    mock_output_t(wf::dimensions_t size) : size(size)
+    {
+        this->handle = nullptr;
+    }
+
+    wf::dimensions_t get_screen_size() const override
+    {
+        return size;
+    }
+
+    std::shared_ptr<wf::scene::output_node_t> node_for_layer(wf::scene::layer) const override
+    {
+        return nullptr;
+    }
+
+    wf::scene::floating_inner_ptr get_wset() const override
+    {
+        return nullptr;
+    }
+
+    bool can_activate_plugin(wf::plugin_activation_data_t*, uint32_t) override
+    {
+        return false;
+    }
+
+    bool can_activate_plugin(uint32_t, uint32_t) override
+    {
+        return false;
+    }
+
+    bool activate_plugin(wf::plugin_activation_data_t*, uint32_t) override
+    {
+        return false;
+    }
+
+    bool deactivate_plugin(wf::plugin_activation_data_t*) override
+    {
+        return false;
+    }
+
+    void cancel_active_plugins() override
+    {}
+
+    bool is_plugin_active(std::string) const override
+    {
+        return false;
+    }
+
+    wayfire_view get_active_view() const override
+    {
+        return nullptr;
+    }
+
+    void focus_view(wayfire_view, bool) override
+    {}
+    void focus_node(wf::scene::node_ptr) override
+    {}
+
+    uint64_t get_last_focus_timestamp() const override
+    {
+        return 0;
+    }
+
+    void refocus() override
+    {}
+
+    void add_key(wf::option_sptr_t<wf::keybinding_t>, wf::key_callback*) override
+    {}
+    void add_axis(wf::option_sptr_t<wf::keybinding_t>, wf::axis_callback*) override
+    {}
+    void add_button(wf::option_sptr_t<wf::buttonbinding_t>, wf::button_callback*) override
+    {}
+    void add_activator(wf::option_sptr_t<wf::activatorbinding_t>, wf::activator_callback*) override
+    {}
+    void rem_binding(void*) override
+    {}
+
+  private:
+    wf::dimensions_t size;
+};
@@ -0,0 +1,89 @@
+/**
+ * Times the scale layout with N views: computing the grid when scale starts,
+ * and the layout after each keystroke of a title filter which matches fewer
+ * and fewer views. For the filter, the number of views which get a new slot,
+ * and therefore a new animation, is reported next to the number of views
+ * which remain.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include "scale-layout.hpp"
+#include <chrono>
+#include <cstdio>
+
+using item_t = wf::scale::layout_item_t<int>;
+static const wf::geometry_t workarea = {0, 0, 1920, 1080};
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/** A cascade of n views, in the order in which they are mapped. */
+static std::vector<item_t> create_views(int n)
+{
+    std::vector<item_t> items;
+    for (int i = 0; i < n; i++)
+    {
+        items.push_back({i, {(i * 37) % 1200, (i * 23) % 600, 640, 480}});
+    }
+
+    return items;
+}
+
+/** The number of views in @to which have a different slot in @from, or none. */
+static size_t count_changed(const wf::scale::layout_t<int>& from,
+    const wf::scale::layout_t<int>& to)
+{
+    size_t changed = 0;
+    for (auto& [key, slot] : to.slots)
+    {
+        auto it = from.slots.find(key);
+        changed += (it == from.slots.end()) || (it->second != slot);
+    }
+
+    return changed;
+}
+
+int main()
+{
+    std::printf("%-8s %12s %14s %14s %14s\n",
+        "views", "entry-us", "keystroke-us", "moved-views", "shown-views");
+    for (int n : {10, 50, 100, 200, 500})
+    {
+        auto views = create_views(n);
+
+        auto start  = std::chrono::steady_clock::now();
+        auto layout = wf::scale::compute_layout(views, workarea, 10);
+        double entry = elapsed_us(start);
+
+        // Each keystroke removes a view, until half of them are left.
+        const int keystrokes = n / 2;
+        double filter = 0;
+        size_t moved  = 0, shown = 0;
+        for (int i = 0; i < keystrokes; i++)
+        {
+            views.erase(views.begin() + (i * 7) % views.size());
+
+            start = std::chrono::steady_clock::now();
+            auto next = wf::scale::compute_layout(views, workarea, 10);
+            moved  += count_changed(layout, next);
+            filter += elapsed_us(start);
+
+            shown += views.size();
+            layout = std::move(next);
+        }
+
+        if (layout.slots.size() != views.size())
+        {
+            std::fprintf(stderr, "%d views: wrong number of slots\n", n);
+            return 1;
+        }
+
+        std::printf("%-8d %12.1f %14.1f %14.1f %14.1f\n", n, entry,
+            filter / keystrokes, (double)moved / keystrokes, (double)shown / keystrokes);
+    }
+
+    return 0;
+}
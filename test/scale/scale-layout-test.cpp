@@ -0,0 +1,113 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include "scale-layout.hpp"
+
+using item_t = wf::scale::layout_item_t<int>;
+static const wf::geometry_t workarea = {0, 0, 1920, 1080};
+
+/** A cascade of n views, in the order in which they are mapped. */
+static std::vector<item_t> create_views(int n)
+{
+    std::vector<item_t> items;
+    for (int i = 0; i < n; i++)
+    {
+        items.push_back({i, {(i * 37) % 1200, (i * 23) % 600, 640, 480}});
+    }
+
+    return items;
+}
+
+/** The number of views in @to which have a different slot in @from, or none. */
+static size_t count_changed(const wf::scale::layout_t<int>& from,
+    const wf::scale::layout_t<int>& to)
+{
+    size_t changed = 0;
+    for (auto& [key, slot] : to.slots)
+    {
+        auto it = from.slots.find(key);
+        changed += (it == from.slots.end()) || (it->second != slot);
+    }
+
+    return changed;
+}
+
+TEST_CASE("Views are arranged in a grid")
+{
+    auto layout = wf::scale::compute_layout(create_views(5), workarea, 10);
+    REQUIRE(layout.slots.size() == 5);
+    REQUIRE((layout.row_sizes == std::vector<int>{3, 2}));
+
+    // Rows are filled by vertical position, columns by horizontal position
+    for (auto& [key, slot] : layout.slots)
+    {
+        REQUIRE(slot.height == doctest::Approx((1080 - 3 * 10) / 2.0));
+        REQUIRE(slot.width == doctest::Approx((1920 - (layout.row_sizes[slot.row] + 1) * 10) /
+            (double)layout.row_sizes[slot.row]));
+        REQUIRE(slot.x == doctest::Approx(10 + (10 + slot.width) * slot.col));
+        REQUIRE(slot.y == doctest::Approx(10 + (10 + slot.height) * slot.row));
+    }
+
+    REQUIRE(layout.slots[0].row == 0);
+    REQUIRE(layout.slots[0].col == 0);
+    REQUIRE(layout.slots[4].row == 1);
+
+    // The result does not depend on the order of the views
+    auto views = create_views(5);
+    std::reverse(views.begin(), views.end());
+    auto reversed = wf::scale::compute_layout(views, workarea, 10);
+    REQUIRE(count_changed(layout, reversed) == 0);
+    REQUIRE(wf::scale::compute_layout<int>({}, workarea, 10).slots.empty());
+}
+
+TEST_CASE("Layout changes keep the slots of unaffected views")
+{
+    // 4 views -> 2 rows of 2
+    auto before = wf::scale::compute_layout(create_views(4), workarea, 10);
+
+    // Adding a fifth view changes the row sizes, so the new view and the
+    // views in the rows which grew get new slots
+    auto added = wf::scale::compute_layout(create_views(5), workarea, 10);
+    REQUIRE(before.slots.count(4) == 0);
+    REQUIRE(count_changed(before, added) > 1);
+    REQUIRE(count_changed(added, added) == 0);
+
+    // Filtering out the last view keeps the rows before it in place
+    auto views = create_views(16);
+    auto full  = wf::scale::compute_layout(views, workarea, 10);
+    views.erase(views.begin() + 15);
+    auto filtered = wf::scale::compute_layout(views, workarea, 10);
+    REQUIRE(count_changed(full, filtered) < filtered.slots.size());
+    REQUIRE(full.slots[0] == filtered.slots[0]);
+}
+
+TEST_CASE("Filtering many views")
+{
+    for (int n : {10, 50, 100, 200})
+    {
+        auto views  = create_views(n);
+        auto layout = wf::scale::compute_layout(views, workarea, 10);
+        REQUIRE(layout.slots.size() == (size_t)n);
+
+        // Each filter keystroke removes a view, like typing a title filter
+        // which matches fewer and fewer views. Every view keeps a slot, and
+        // the grid stays close to square.
+        for (int i = 0; i < n / 2; i++)
+        {
+            views.erase(views.begin() + (i * 7) % views.size());
+            layout = wf::scale::compute_layout(views, workarea, 10);
+            REQUIRE(layout.slots.size() == views.size());
+
+            int total = 0;
+            for (int row : layout.row_sizes)
+            {
+                total += row;
+                REQUIRE(row <= layout.row_sizes.front());
+            }
+
+            REQUIRE(total == (int)views.size());
+            REQUIRE((int)layout.row_sizes.size() == (int)std::sqrt(views.size() + 1));
+        }
+    }
+}
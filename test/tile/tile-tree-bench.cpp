@@ -0,0 +1,135 @@
+/**
+ * Times relayouts of wide and deep tile trees with hundreds of tiles, and
+ * counts the configures the views would receive. Each tree is relaid out
+ * after one tile changed, once with only that tile dirty and once with every
+ * tile dirty, as every change relaid out the whole tree before.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include "tree.hpp"
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+#include <chrono>
+#include <cstdio>
+
+using namespace wf::tile;
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/* Counts how often the tree resizes its leaves, i.e. how many configures
+ * views would have received. */
+static int configures = 0;
+
+struct bench_leaf_t : public tree_node_t
+{
+    void set_geometry(wf::geometry_t geometry) override
+    {
+        if (!needs_relayout(geometry))
+        {
+            return;
+        }
+
+        tree_node_t::set_geometry(geometry);
+        ++configures;
+    }
+
+    void set_gaps(const gap_size_t&) override
+    {}
+};
+
+static const wf::geometry_t screen = {0, 0, 3840, 2160};
+
+/* Build a balanced tree, with splits alternating in direction */
+static void build_tree(split_node_t *node, int depth, std::vector<tree_node_t*>& leaves)
+{
+    if (depth == 0)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            auto leaf = std::make_unique<bench_leaf_t>();
+            leaves.push_back(leaf.get());
+            node->add_child(std::move(leaf));
+        }
+
+        return;
+    }
+
+    auto direction = (node->get_split_direction() == SPLIT_VERTICAL) ?
+        SPLIT_HORIZONTAL : SPLIT_VERTICAL;
+    for (int i = 0; i < 2; i++)
+    {
+        auto child = std::make_unique<split_node_t>(direction);
+        auto child_ptr = child.get();
+        node->add_child(std::move(child));
+        build_tree(child_ptr, depth - 1, leaves);
+    }
+}
+
+/**
+ * Relayout @root after marking @dirty, and print the time and the number of
+ * configures, averaged over a number of iterations.
+ */
+static void relayout(const char *name, split_node_t& root,
+    const std::vector<tree_node_t*>& leaves, const std::vector<tree_node_t*>& dirty)
+{
+    constexpr int iterations = 100;
+
+    configures = 0;
+    double total = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        for (auto node : dirty)
+        {
+            node->mark_dirty();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        root.set_geometry(screen);
+        total += elapsed_us(start);
+    }
+
+    std::printf("%-24s %8zu %12.1f %12.1f\n", name, leaves.size(),
+        total / iterations, (double)configures / iterations);
+}
+
+int main()
+{
+    std::printf("%-24s %8s %12s %12s\n", "tree", "tiles", "relayout-us", "configures");
+
+    for (int n : {100, 300, 1000})
+    {
+        split_node_t root{SPLIT_VERTICAL};
+        root.set_geometry(screen);
+
+        std::vector<tree_node_t*> leaves;
+        for (int i = 0; i < n; i++)
+        {
+            auto leaf = std::make_unique<bench_leaf_t>();
+            leaves.push_back(leaf.get());
+            root.add_child(std::move(leaf));
+        }
+
+        root.set_geometry(screen);
+        relayout("wide, one dirty tile", root, leaves, {leaves[n / 2]});
+        relayout("wide, all dirty", root, leaves, leaves);
+    }
+
+    for (int depth : {5, 7, 9})
+    {
+        split_node_t root{SPLIT_VERTICAL};
+        root.set_geometry(screen);
+
+        std::vector<tree_node_t*> leaves;
+        build_tree(&root, depth, leaves);
+
+        root.set_geometry(screen);
+        relayout("deep, one dirty tile", root, leaves, {leaves[leaves.size() / 2]});
+        relayout("deep, all dirty", root, leaves, leaves);
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "tree.hpp"
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+
+using namespace wf::tile;
+
+/* Counts how often the tree resizes its leaves, i.e. how many configures
+ * views would have received. */
+static int configures = 0;
+
+struct test_leaf_t : public tree_node_t
+{
+    void set_geometry(wf::geometry_t geometry) override
+    {
+        if (!needs_relayout(geometry))
+        {
+            return;
+        }
+
+        tree_node_t::set_geometry(geometry);
+        ++configures;
+    }
+
+    void set_gaps(const gap_size_t&) override
+    {}
+};
+
+static const wf::geometry_t screen = {0, 0, 3840, 2160};
+
+static int count_configures(std::function<void()> action)
+{
+    configures = 0;
+    action();
+    return configures;
+}
+
+TEST_CASE("Only changed subtrees are relaid out in wide trees")
+{
+    const int N = 300;
+    split_node_t root{SPLIT_VERTICAL};
+    root.set_geometry(screen);
+
+    std::vector<tree_node_t*> leaves;
+    for (int i = 0; i < N; i++)
+    {
+        auto leaf = std::make_unique<test_leaf_t>();
+        leaves.push_back(leaf.get());
+        root.add_child(std::move(leaf));
+    }
+
+    REQUIRE(count_configures([&] { root.set_geometry(screen); }) == 0);
+
+    leaves[N / 2]->mark_dirty();
+    REQUIRE(count_configures([&] { root.set_geometry(screen); }) == 1);
+
+    // Changing the height resizes all children of a vertical split
+    auto smaller = screen;
+    smaller.height -= 100;
+    REQUIRE(count_configures([&] { root.set_geometry(smaller); }) == N);
+}
+
+/* Build a balanced tree, with splits alternating in direction */
+static void build_tree(split_node_t *node, int depth, std::vector<split_node_t*>& bottom)
+{
+    if (depth == 0)
+    {
+        node->add_child(std::make_unique<test_leaf_t>());
+        node->add_child(std::make_unique<test_leaf_t>());
+        bottom.push_back(node);
+        return;
+    }
+
+    auto direction = (node->get_split_direction() == SPLIT_VERTICAL) ?
+        SPLIT_HORIZONTAL : SPLIT_VERTICAL;
+    for (int i = 0; i < 2; i++)
+    {
+        auto child = std::make_unique<split_node_t>(direction);
+        auto child_ptr = child.get();
+        node->add_child(std::move(child));
+        build_tree(child_ptr, depth - 1, bottom);
+    }
+}
+
+TEST_CASE("Only changed subtrees are relaid out in deep trees")
+{
+    // 256 views, each split in a tree of depth 8
+    const int DEPTH = 7;
+    const int N     = 2 << DEPTH;
+    split_node_t root{SPLIT_VERTICAL};
+    root.set_geometry(screen);
+
+    std::vector<split_node_t*> bottom;
+    build_tree(&root, DEPTH, bottom);
+    REQUIRE(count_configures([&] { root.set_geometry(screen); }) == 0);
+
+    auto smaller = screen;
+    smaller.width -= 100;
+    REQUIRE(count_configures([&] { root.set_geometry(smaller); }) == N);
+
+    // Adding a view at the bottom only resizes its siblings
+    REQUIRE(count_configures([&]
+    {
+        bottom.back()->add_child(std::make_unique<test_leaf_t>());
+    }) == 3);
+
+    // A relayout with the same size does not touch the other views
+    bottom.front()->children.front()->mark_dirty();
+    REQUIRE(count_configures([&] { root.set_geometry(smaller); }) == 1);
+
+    // Nothing is dirty anymore
+    REQUIRE(count_configures([&] { root.set_geometry(smaller); }) == 0);
+}
@@ -0,0 +1,183 @@
+/**
+ * Times transactions of mock instructions for different objects, as a
+ * relayout of many views would submit them. For each transaction size, the
+ * time to submit and commit the transaction and to apply it once every
+ * instruction is ready is reported. The second table shows the cost of
+ * applying a transaction whose last instruction never becomes ready, when
+ * its timeout expires, for different timeouts.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include <wayfire/config/option-wrapper.hpp>
+#include <wayfire/transaction/instruction.hpp>
+#include <wayfire/transaction/transaction.hpp>
+#include <wayfire/debug.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include "../src/core/transaction/transaction-priv.hpp"
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+
+using namespace wf::txn;
+
+class bench_instruction_t : public instruction_t
+{
+  public:
+    bench_instruction_t(std::string object) : object(object)
+    {}
+
+    std::string object;
+    int committed = 0;
+    int applied   = 0;
+
+    std::string get_object() override
+    {
+        return object;
+    }
+
+    void commit() override
+    {
+        ++committed;
+    }
+
+    void apply() override
+    {
+        ++applied;
+    }
+
+    void send_ready()
+    {
+        instruction_ready_signal data;
+        data.instruction = {this};
+        this->emit(&data);
+    }
+};
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+static void setup_txn_timeout(int timeout)
+{
+    auto section = std::make_shared<wf::config::section_t>("core");
+    auto val     = std::make_shared<wf::config::option_t<int>>(
+        "transaction_timeout", timeout);
+    section->register_new_option(val);
+    mock_core().config.merge_section(section);
+}
+
+static transaction_manager_t& get_quiet_transaction_manager()
+{
+    auto& manager = get_fresh_transaction_manager();
+
+    // The manager enables debug logs for tests, which would dominate the timings.
+    wf::log::enabled_categories.set((size_t)wf::log::logging_category::TXN, 0);
+    wf::log::initialize_logging(std::cout, wf::log::LOG_LEVEL_ERROR,
+        wf::log::LOG_COLOR_MODE_OFF);
+    return manager;
+}
+
+/**
+ * Submit a transaction with @n instructions for different objects and commit
+ * it. All but the last instruction become ready.
+ *
+ * @return The time to submit and commit the transaction, in microseconds.
+ */
+static double submit_large(int n, std::vector<bench_instruction_t*>& instructions)
+{
+    auto& manager = get_quiet_transaction_manager();
+    auto tx = transaction_t::create();
+    for (int i = 0; i < n; i++)
+    {
+        auto instr = new bench_instruction_t(std::to_string(i));
+        instructions.push_back(instr);
+        tx->add_instruction(instruction_uptr_t(instr));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    manager.submit(std::move(tx));
+    mock_loop::get().dispatch_idle();
+    double committed = elapsed_us(start);
+
+    for (int i = 0; i < n - 1; i++)
+    {
+        instructions[i]->send_ready();
+    }
+
+    return committed;
+}
+
+static bool all_applied(const std::vector<bench_instruction_t*>& instructions)
+{
+    for (auto i : instructions)
+    {
+        if (i->applied != 1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    const int sizes[] = {10, 100, 1000, 10000};
+
+    setup_txn_timeout(100);
+    std::printf("transaction size\n");
+    std::printf("%-14s %14s %14s\n", "instructions", "commit-us", "apply-us");
+    for (int n : sizes)
+    {
+        std::vector<bench_instruction_t*> instructions;
+        double commit = submit_large(n, instructions);
+
+        auto start = std::chrono::steady_clock::now();
+        instructions.back()->send_ready();
+        double apply = elapsed_us(start);
+        if (!all_applied(instructions))
+        {
+            std::fprintf(stderr, "%d instructions: not applied when ready\n", n);
+            return 1;
+        }
+
+        mock_loop::get().dispatch_idle();
+        std::printf("%-14d %14.1f %14.1f\n", n, commit, apply);
+    }
+
+    std::printf("\ntimeout with one late instruction\n");
+    std::printf("%-14s %14s %14s\n", "instructions", "timeout-ms", "apply-us");
+    for (int timeout : {50, 100, 200, 400})
+    {
+        setup_txn_timeout(timeout);
+        for (int n : sizes)
+        {
+            std::vector<bench_instruction_t*> instructions;
+            submit_large(n, instructions);
+
+            mock_loop::get().move_forward(timeout - 1);
+            if (instructions.front()->applied != 0)
+            {
+                std::fprintf(stderr, "%d instructions: applied before the timeout\n", n);
+                return 1;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            mock_loop::get().move_forward(1);
+            double apply = elapsed_us(start);
+            if (!all_applied(instructions))
+            {
+                std::fprintf(stderr, "%d instructions: not applied on timeout\n", n);
+                return 1;
+            }
+
+            mock_loop::get().dispatch_idle();
+            std::printf("%-14d %14d %14.1f\n", n, timeout, apply);
+        }
+    }
+
+    return 0;
+}
@@ -350,3 +350,62 @@ TEST_CASE("Commit and then apply transaction")
         }
     }
 }
+
+TEST_CASE("Large transactions")
+{
+    setup_txn_timeout(100);
+
+    // Submit a transaction with n instructions for different objects, and
+    // make all but the last instruction ready.
+    const auto& submit_large = [&] (int n, std::vector<mock_instruction_t*>& instructions)
+    {
+        auto& manager = get_fresh_transaction_manager();
+        auto tx = transaction_t::create();
+        for (int i = 0; i < n; i++)
+        {
+            auto instr = new mock_instruction_t(std::to_string(i));
+            instructions.push_back(instr);
+            tx->add_instruction(instruction_uptr_t(instr));
+        }
+
+        manager.submit(std::move(tx));
+        mock_loop::get().dispatch_idle();
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            REQUIRE(instructions[i]->committed == 1);
+            instructions[i]->send_ready();
+        }
+    };
+
+    for (int n : {10, 100, 1000})
+    {
+        // All instructions become ready
+        std::vector<mock_instruction_t*> instructions;
+        submit_large(n, instructions);
+        REQUIRE(instructions.front()->applied == 0);
+
+        instructions.back()->send_ready();
+        for (auto i : instructions)
+        {
+            REQUIRE(i->applied == 1);
+        }
+
+        mock_loop::get().dispatch_idle();
+
+        // The last instruction never becomes ready. Everything is applied at
+        // once when the timeout expires.
+        instructions.clear();
+        submit_large(n, instructions);
+        mock_loop::get().move_forward(99);
+        REQUIRE(instructions.front()->applied == 0);
+
+        mock_loop::get().move_forward(1);
+        for (auto i : instructions)
+        {
+            REQUIRE(i->applied == 1);
+        }
+
+        mock_loop::get().dispatch_idle();
+    }
+}
@@ -0,0 +1,125 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/compositor-view.hpp>
+#include <wayfire/transaction/view-instructions.hpp>
+#include "../src/core/transaction/transaction-priv.hpp"
+#include "mock-instruction.hpp"
+#include "../mock-core.hpp"
+#include "../mock.hpp"
+
+using namespace wf::txn;
+
+static void unmap(wf::color_rect_view_t& view)
+{
+    wf::view_unmapped_signal data;
+    data.view = {&view};
+    view.emit(&data);
+}
+
+TEST_CASE("View state is applied together with the transaction")
+{
+    setup_txn_timeout(100);
+    auto& manager = get_fresh_transaction_manager();
+
+    wf::color_rect_view_t view;
+    view.set_geometry({0, 0, 10, 10});
+
+    auto other = new mock_instruction_t("other");
+    auto tx    = transaction_t::create();
+    tx->add_instruction(instruction_uptr_t(other));
+
+    view_state_t state;
+    state.geometry    = {100, 200, 300, 400};
+    state.tiled_edges = wf::TILED_EDGES_ALL;
+    state.fullscreen  = true;
+    tx->add_instruction(view_state_instruction_t::get({&view}, state));
+
+    manager.submit(std::move(tx));
+    mock_loop::get().dispatch_idle();
+    REQUIRE(other->committed == 1);
+
+    // The view is not configured by a client, so it is ready immediately, but
+    // it still waits for the rest of the transaction.
+    REQUIRE(view.get_wm_geometry() == wf::geometry_t{0, 0, 10, 10});
+    REQUIRE(view.tiled_edges == 0);
+    REQUIRE(view.fullscreen == false);
+
+    other->send_ready();
+    REQUIRE(other->applied == 1);
+    REQUIRE(view.get_wm_geometry() == wf::geometry_t{100, 200, 300, 400});
+    REQUIRE(view.tiled_edges == wf::TILED_EDGES_ALL);
+    REQUIRE(view.fullscreen == true);
+
+    mock_loop::get().dispatch_idle();
+}
+
+TEST_CASE("Only the given parts of the view state are changed")
+{
+    setup_txn_timeout(100);
+    auto& manager = get_fresh_transaction_manager();
+
+    wf::color_rect_view_t view;
+    view.set_geometry({0, 0, 10, 10});
+    view.set_tiled(WLR_EDGE_LEFT);
+
+    auto tx = transaction_t::create();
+    view_state_t state;
+    state.fullscreen = true;
+    tx->add_instruction(view_state_instruction_t::get({&view}, state));
+
+    manager.submit(std::move(tx));
+    mock_loop::get().dispatch_idle();
+
+    REQUIRE(view.get_wm_geometry() == wf::geometry_t{0, 0, 10, 10});
+    REQUIRE(view.tiled_edges == WLR_EDGE_LEFT);
+    REQUIRE(view.fullscreen == true);
+
+    mock_loop::get().dispatch_idle();
+}
+
+TEST_CASE("Unmapping the view cancels the transaction")
+{
+    setup_txn_timeout(100);
+    auto& manager = get_fresh_transaction_manager();
+
+    wf::color_rect_view_t view;
+    view.set_geometry({0, 0, 10, 10});
+
+    auto other = new mock_instruction_t("other");
+    auto tx    = transaction_t::create();
+    tx->add_instruction(instruction_uptr_t(other));
+
+    view_state_t state;
+    state.geometry = {100, 200, 300, 400};
+    tx->add_instruction(view_state_instruction_t::get({&view}, state));
+
+    int cnt_ready = 0;
+    int cnt_done  = 0;
+    wf::signal::connection_t<transaction_ready_signal> on_ready = [&] (transaction_ready_signal*)
+    {
+        ++cnt_ready;
+    };
+    wf::signal::connection_t<transaction_done_signal> on_done = [&] (transaction_done_signal*)
+    {
+        ++cnt_done;
+    };
+    manager.connect(&on_ready);
+    manager.connect(&on_done);
+
+    manager.submit(std::move(tx));
+    mock_loop::get().dispatch_idle();
+    REQUIRE(other->committed == 1);
+
+    unmap(view);
+    REQUIRE(cnt_done == 1);
+    REQUIRE(cnt_ready == 0);
+    REQUIRE(other->applied == 0);
+    REQUIRE(view.get_wm_geometry() == wf::geometry_t{0, 0, 10, 10});
+
+    // The transaction is cancelled only once
+    unmap(view);
+    REQUIRE(cnt_done == 1);
+
+    mock_loop::get().dispatch_idle();
+}
@@ -0,0 +1,132 @@
+/**
+ * Compares the per-frame cost of the CPU mesh and the GPU-resident mesh of
+ * the wobbly plugin for a number of wobbling windows, at several grid
+ * resolutions. Only the mesh generation on the CPU and the amount of data
+ * uploaded per frame are measured, the spring model is stepped outside of
+ * the timed part because both paths share it.
+ *
+ * Run with `meson test --benchmark`.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "wobbly-mesh.hpp"
+
+extern "C"
+{
+double wobbly_settings_get_friction()
+{
+    return 3.0;
+}
+
+double wobbly_settings_get_spring_k()
+{
+    return 8.0;
+}
+}
+
+static double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/** Create a model which is wobbling after being grabbed and moved. */
+static wobbly_surface *create_wobbling_model(int resolution, int offset)
+{
+    auto model = (wobbly_surface*)calloc(1, sizeof(wobbly_surface));
+    model->x     = 100 + offset;
+    model->y     = 100 + offset;
+    model->width = 800;
+    model->height  = 600;
+    model->x_cells = resolution;
+    model->y_cells = resolution;
+    if (!wobbly_init(model))
+    {
+        free(model);
+        return nullptr;
+    }
+
+    wobbly_grab_notify(model, 150 + offset, 150 + offset);
+    wobbly_move_notify(model, 400 + offset, 300 + offset);
+    return model;
+}
+
+static void destroy_model(wobbly_surface *model)
+{
+    free(model->uv);
+    wobbly_fini(model);
+    free(model);
+}
+
+int main()
+{
+    constexpr int windows = 50;
+    constexpr int frames  = 200;
+    const int resolutions[] = {6, 16, 32, 64};
+
+    std::printf("wobbly mesh, %d windows, %d frames\n", windows, frames);
+    std::printf("%-10s %14s %14s %14s %14s\n",
+        "resolution", "cpu-us", "gpu-us", "cpu-bytes", "gpu-bytes");
+    for (int resolution : resolutions)
+    {
+        std::vector<wobbly_surface*> models;
+        for (int i = 0; i < windows; i++)
+        {
+            auto model = create_wobbling_model(resolution, i);
+            if (!model)
+            {
+                std::fprintf(stderr, "failed to create the wobbly model\n");
+                return 1;
+            }
+
+            models.push_back(model);
+        }
+
+        // The static mesh of the GPU path is built once per resolution.
+        std::vector<float> params;
+        std::vector<uint16_t> indices;
+        auto start = std::chrono::steady_clock::now();
+        wobbly_mesh::build_grid_mesh(resolution, resolution, params, indices);
+        double gpu = elapsed_us(start);
+
+        double cpu = 0;
+        size_t cpu_bytes = 0, gpu_bytes = 0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            for (auto model : models)
+            {
+                // Keep dragging the windows, so that they never come to rest.
+                wobbly_move_notify(model, 400 + frame % 50, 300 + frame % 50);
+                wobbly_prepare_paint(model, 16);
+
+                start = std::chrono::steady_clock::now();
+                std::vector<float> vert, uv;
+                wobbly_add_geometry(model);
+                wobbly_mesh::prepare_geometry(model, {0, 0, 0, 0}, vert, uv);
+                cpu += elapsed_us(start);
+                cpu_bytes += (vert.size() + uv.size()) * sizeof(float);
+
+                start = std::chrono::steady_clock::now();
+                float control[2 * WOBBLY_CONTROL_POINTS];
+                wobbly_mesh::get_control_points(model, {0, 0, 0, 0}, control);
+                gpu += elapsed_us(start);
+                gpu_bytes += sizeof(control);
+
+                wobbly_done_paint(model);
+            }
+        }
+
+        std::printf("%-10d %14.2f %14.2f %14zu %14zu\n", resolution,
+            cpu / frames, gpu / frames, cpu_bytes / frames, gpu_bytes / frames);
+
+        for (auto model : models)
+        {
+            destroy_model(model);
+        }
+    }
+
+    return 0;
+}
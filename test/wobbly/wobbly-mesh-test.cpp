@@ -0,0 +1,134 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include "wobbly-mesh.hpp"
+
+extern "C"
+{
+double wobbly_settings_get_friction()
+{
+    return 3.0;
+}
+
+double wobbly_settings_get_spring_k()
+{
+    return 8.0;
+}
+}
+
+static constexpr int RESOLUTION = 6;
+
+/** Create a model which is wobbling after being grabbed and moved. */
+static wobbly_surface *create_wobbling_model()
+{
+    auto model = (wobbly_surface*)calloc(1, sizeof(wobbly_surface));
+    model->x     = 100;
+    model->y     = 100;
+    model->width = 800;
+    model->height  = 600;
+    model->x_cells = RESOLUTION;
+    model->y_cells = RESOLUTION;
+    REQUIRE(wobbly_init(model));
+
+    wobbly_grab_notify(model, 150, 150);
+    wobbly_move_notify(model, 400, 300);
+    wobbly_prepare_paint(model, 16);
+    return model;
+}
+
+static void destroy_model(wobbly_surface *model)
+{
+    free(model->uv);
+    wobbly_fini(model);
+    free(model);
+}
+
+/** The bezier patch evaluation done by the vertex shader. */
+static void evaluate_patch(const float *control, float u, float v, float& x, float& y)
+{
+    auto bernstein = [] (float t, float *b)
+    {
+        float s = 1 - t;
+        b[0] = s * s * s;
+        b[1] = 3 * t * s * s;
+        b[2] = 3 * t * t * s;
+        b[3] = t * t * t;
+    };
+
+    float bu[4], bv[4];
+    bernstein(u, bu);
+    bernstein(v, bv);
+
+    x = y = 0;
+    for (int j = 0; j < 4; j++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            x += bu[i] * bv[j] * control[2 * (j * 4 + i)];
+            y += bu[i] * bv[j] * control[2 * (j * 4 + i) + 1];
+        }
+    }
+}
+
+TEST_CASE("Grid mesh covers the grid")
+{
+    std::vector<float> params;
+    std::vector<uint16_t> indices;
+    wobbly_mesh::build_grid_mesh(RESOLUTION, RESOLUTION, params, indices);
+
+    const int vertices = (RESOLUTION + 1) * (RESOLUTION + 1);
+    REQUIRE_EQ(params.size(), 2 * vertices);
+    REQUIRE_EQ(indices.size(), 6 * RESOLUTION * RESOLUTION);
+    for (auto i : indices)
+    {
+        REQUIRE(i < vertices);
+    }
+
+    REQUIRE_EQ(params[0], 0.0f);
+    REQUIRE_EQ(params[1], 0.0f);
+    REQUIRE_EQ(params[2 * vertices - 2], 1.0f);
+    REQUIRE_EQ(params[2 * vertices - 1], 1.0f);
+}
+
+TEST_CASE("Patch evaluation matches the CPU mesh")
+{
+    auto model = create_wobbling_model();
+    wobbly_add_geometry(model);
+    REQUIRE(model->v != nullptr);
+
+    float control[2 * WOBBLY_CONTROL_POINTS];
+    wobbly_mesh::get_control_points(model, {0, 0, 0, 0}, control);
+
+    std::vector<float> params;
+    std::vector<uint16_t> indices;
+    wobbly_mesh::build_grid_mesh(RESOLUTION, RESOLUTION, params, indices);
+    for (size_t i = 0; i < params.size() / 2; i++)
+    {
+        float x, y;
+        evaluate_patch(control, params[2 * i], params[2 * i + 1], x, y);
+        REQUIRE_EQ(x, doctest::Approx(model->v[2 * i]).epsilon(1e-4));
+        REQUIRE_EQ(y, doctest::Approx(model->v[2 * i + 1]).epsilon(1e-4));
+    }
+
+    destroy_model(model);
+}
+
+TEST_CASE("Resting model is the source box")
+{
+    auto model = (wobbly_surface*)calloc(1, sizeof(wobbly_surface));
+    model->width   = 100;
+    model->height  = 100;
+    model->x_cells = model->y_cells = RESOLUTION;
+    REQUIRE(wobbly_init(model));
+
+    float control[2 * WOBBLY_CONTROL_POINTS];
+    wobbly_mesh::get_control_points(model, {10, 20, 300, 150}, control);
+
+    float x, y;
+    evaluate_patch(control, 0.5, 0.25, x, y);
+    REQUIRE_EQ(x, doctest::Approx(160));
+    REQUIRE_EQ(y, doctest::Approx(57.5));
+
+    destroy_model(model);
+}